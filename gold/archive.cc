@@ -26,6 +26,7 @@
 #include <cerrno>
 #include <cstring>
 #include <climits>
+#include <set>
 #include <vector>
 #include "libiberty.h"
 #include "filenames.h"
@@ -34,6 +35,7 @@
 #include "options.h"
 #include "mapfile.h"
 #include "fileread.h"
+#include "hash.h"
 #include "readsyms.h"
 #include "symtab.h"
 #include "object.h"
@@ -184,7 +186,10 @@ Archive::Archive(const std::string& name, Input_file* input_file,
                  bool is_thin_archive, Dirsearch* dirpath, Task* task)
   : Library_base(task), name_(name), input_file_(input_file), armap_(),
     armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
-    members_(), is_thin_archive_(is_thin_archive), included_member_(false),
+    armap_index_(), members_(), member_offsets_(),
+    have_member_offsets_(false), member_reads_(), member_read_files_(),
+    is_thin_archive_(is_thin_archive),
+    included_member_(false),
     nested_archives_(), dirpath_(dirpath), num_members_(0),
     included_all_members_(false)
 {
@@ -317,11 +322,11 @@ Archive::read_armap(off_t start, section_size_type size)
 // of the member.
 
 off_t
-Archive::read_header(off_t off, bool cache, std::string* pname,
-                     off_t* nested_off)
+Archive::read_header(File_read* file, off_t off, bool cache,
+		     std::string* pname, off_t* nested_off)
 {
-  const unsigned char* p = this->get_view(off, sizeof(Archive_header), true,
-					  cache);
+  const unsigned char* p = file->get_view(0, off, sizeof(Archive_header),
+					  true, cache);
   const Archive_header* hdr = reinterpret_cast<const Archive_header*>(p);
   return this->interpret_header(hdr, off,  pname, nested_off);
 }
@@ -556,6 +561,93 @@ Archive::end()
   return Archive::const_iterator(this, this->input_file_->file().filesize());
 }
 
+// Return a hash of the contents of the archive file, for
+// --incremental-check-hash.
+
+uint64_t
+Archive::do_get_content_hash()
+{
+  section_size_type filesize =
+    convert_to_section_size_type(this->input_file_->file().filesize());
+  const unsigned char* contents = this->get_view(0, filesize, false, false);
+  return content_hash(contents, filesize);
+}
+
+// Set *INFO to the location and contents hash of the member OBJ, for
+// the incremental link info.  We can't do this for the external
+// members of a thin archive, which are not in the archive file.
+
+bool
+Archive::do_get_member_info(Object* obj, Incremental_member_info* info)
+{
+  if (this->is_thin_archive_ || obj->offset() == 0)
+    return false;
+  off_t off = obj->offset() - sizeof(Archive_header);
+  std::string name;
+  off_t size = this->read_header(off, true, &name, NULL);
+  if (size < 0)
+    return false;
+  const unsigned char* contents =
+    this->get_view(obj->offset(), size, false, false);
+  *info = Incremental_member_info(off, size, content_hash(contents, size));
+  return true;
+}
+
+// For an incremental update of a changed archive, the members which
+// did not change were kept from the previous link, and have been
+// recorded in the incremental info for this archive.  Treat them as
+// already included, so that we don't add them again.
+
+void
+Archive::mark_kept_members_included()
+{
+  Incremental_archive_entry* entry = this->incremental_info();
+  if (entry == NULL)
+    return;
+  unsigned int nmembers = entry->get_member_count();
+  for (unsigned int i = 0; i < nmembers; ++i)
+    {
+      off_t off = entry->get_member_info(i).offset;
+      if (off != 0)
+	this->seen_offsets_.insert(off);
+    }
+}
+
+// For an incremental update of a changed archive, set *MEMBERS to
+// the location, size and contents hash of each member.  A name which
+// appears more than once gets an empty entry, so that none of the
+// members with that name will be kept from the previous link.
+
+bool
+Archive::get_all_member_info(std::map<std::string, Incremental_member_info>*
+			     members)
+{
+  if (this->is_thin_archive_)
+    return false;
+  off_t filesize = this->input_file_->file().filesize();
+  for (Archive::const_iterator p = this->begin(); p != this->end(); ++p)
+    {
+      // Leave out anything which can't be a member we kept; it will
+      // be diagnosed when the archive is read.
+      off_t start = p->off + sizeof(Archive_header);
+      if (p->size == 0 || p->size > filesize - start)
+	continue;
+      std::string name(std::string(this->input_file_->filename())
+		       + "(" + p->name + ")");
+      section_size_type size = convert_to_section_size_type(p->size);
+      const unsigned char* contents = this->get_view(start, size, false,
+						     false);
+      Incremental_member_info info(p->off, p->size,
+				   content_hash(contents, size));
+      std::pair<std::map<std::string, Incremental_member_info>::iterator,
+		bool> ins = members->insert(std::make_pair(name, info));
+      if (!ins.second)
+	ins.first->second = Incremental_member_info();
+      this->clear_uncached_views();
+    }
+  return true;
+}
+
 // Get the file and offset for an archive member, which may be an
 // external member of a thin archive.  Set *INPUT_FILE to the
 // file containing the actual member, *MEMOFF to the offset
@@ -655,19 +747,9 @@ Archive::get_elf_object_for_member(off_t off, bool* punconfigured)
 				 &member_name))
     return NULL;
 
-  const unsigned char* ehdr;
-  int read_size;
-  Object *obj = NULL;
-  bool is_elf_obj = false;
-
-  if (is_elf_object(input_file, memoff, &ehdr, &read_size))
-    {
-      obj = make_elf_object((std::string(this->input_file_->filename())
-			     + "(" + member_name + ")"),
-			    input_file, memoff, ehdr, read_size,
-			    punconfigured);
-      is_elf_obj = true;
-    }
+  bool is_elf_obj;
+  Object* obj = this->make_member_elf_object(input_file, memoff, member_name,
+					     &is_elf_obj, punconfigured);
 
   if (parameters->options().has_plugins())
     {
@@ -700,6 +782,188 @@ Archive::get_elf_object_for_member(off_t off, bool* punconfigured)
   return obj;
 }
 
+// Make an ELF object for the member MEMBER_NAME at offset MEMOFF in
+// INPUT_FILE.  Set *IS_ELF to whether it is an ELF object, and return
+// NULL if it is not.  PUNCONFIGURED is as for make_elf_object.
+
+Object*
+Archive::make_member_elf_object(Input_file* input_file, off_t memoff,
+				const std::string& member_name, bool* is_elf,
+				bool* punconfigured)
+{
+  const unsigned char* ehdr;
+  int read_size;
+  *is_elf = is_elf_object(input_file, memoff, &ehdr, &read_size);
+  if (!*is_elf)
+    return NULL;
+  return make_elf_object((std::string(this->input_file_->filename())
+			  + "(" + member_name + ")"),
+			 input_file, memoff, ehdr, read_size, punconfigured);
+}
+
+// For --whole-archive, queue Read_archive_members tasks to read the
+// symbols of the archive members in parallel.  Each task opens the
+// archive again, since a File_read may only be used by one task at a
+// time.  Add_archive_symbols then adds the members in archive order.
+// Return a token which blocks until the tasks are done, or NULL if we
+// should read the members one by one as usual.
+
+Task_token*
+Archive::queue_read_members(Workqueue* workqueue)
+{
+  bool parallel = (parameters->options().threads()
+		   && this->input_file_->options().whole_archive());
+#ifndef ENABLE_THREADS
+  parallel = false;
+#endif
+  // Plugins may claim members, an incremental link records each
+  // member as it is included, and the members of a thin archive are
+  // opened through this archive, so read those one by one.
+  if (!parallel
+      || this->is_thin_archive_
+      || parameters->options().has_plugins()
+      || parameters->incremental()
+      || !this->members_.empty()
+      || !this->seen_offsets_.empty())
+    return NULL;
+
+  if (!this->have_member_offsets_)
+    {
+      for (Archive::const_iterator p = this->begin();
+	   p != this->end();
+	   ++p)
+	this->member_offsets_.push_back(p->off);
+      this->have_member_offsets_ = true;
+    }
+
+  // Use as many tasks as we have threads for reading input files, but
+  // give each task a reasonable number of members.
+  const size_t nmembers = this->member_offsets_.size();
+  size_t ntasks = parameters->options().thread_count_initial();
+  if (ntasks == 0)
+    ntasks = 8;
+  ntasks = std::min(ntasks, nmembers / 16);
+  if (ntasks <= 1)
+    return NULL;
+
+  this->member_reads_.resize(nmembers);
+  for (size_t i = 0; i < ntasks; ++i)
+    this->member_read_files_.push_back(
+	Member_read_file(nmembers * i / ntasks, nmembers * (i + 1) / ntasks));
+
+  Task_token* blocker = new Task_token(true);
+  blocker->add_blockers(ntasks);
+  for (size_t i = 0; i < ntasks; ++i)
+    workqueue->queue_soon(new Read_archive_members(this, i, blocker));
+  return blocker;
+}
+
+// Read the symbols of the archive members for the INDEX'th
+// Read_archive_members task, and record them in member_reads_.  The
+// objects are read through a new Input_file, which is kept until
+// include_all_members has used them.  We leave out any member we
+// can't read; include_member will try it again.
+
+void
+Archive::read_members(const Task* task, size_t index)
+{
+  Member_read_file* mrf = &this->member_read_files_[index];
+  Input_file_argument* input_file_arg =
+    new Input_file_argument(this->filename().c_str(),
+			    Input_file_argument::INPUT_FILE_TYPE_FILE,
+			    "", this->input_file_->just_symbols(),
+			    this->input_file_->options());
+  Input_file* input_file = new Input_file(input_file_arg);
+  int dummy = 0;
+  if (!input_file->open(*this->dirpath_, task, &dummy))
+    {
+      delete input_file;
+      delete input_file_arg;
+      return;
+    }
+
+  bool any = false;
+  for (size_t i = mrf->start; i < mrf->end; ++i)
+    {
+      off_t off = this->member_offsets_[i];
+      std::string member_name;
+      if (this->read_header(&input_file->file(), off, false, &member_name,
+			    NULL) == -1)
+	continue;
+
+      bool is_elf;
+      bool unconfigured;
+      Object* obj =
+	this->make_member_elf_object(input_file,
+				     off + sizeof(Archive_header),
+				     member_name, &is_elf, &unconfigured);
+      if (obj == NULL)
+	continue;
+      obj->set_no_export(this->no_export());
+
+      Read_symbols_data* sd = new Read_symbols_data;
+      obj->read_symbols(sd);
+
+      this->member_reads_[i] = Archive_member(obj, sd);
+      any = true;
+    }
+
+  input_file->file().unlock(task);
+
+  if (any)
+    mrf->input_file = input_file;
+  else
+    {
+      delete input_file;
+      delete input_file_arg;
+    }
+}
+
+// Discard the members read by Read_archive_members tasks from START
+// on in member_offsets_, and free the files which the tasks opened.
+// This is used if we stop including members early.
+
+void
+Archive::discard_member_reads(size_t start)
+{
+  for (size_t i = start; i < this->member_reads_.size(); ++i)
+    {
+      Archive_member* m = &this->member_reads_[i];
+      if (m->obj_ == NULL)
+	continue;
+      m->obj_->lock(this->task_);
+      delete m->sd_;
+      m->obj_->unlock(this->task_);
+      delete m->obj_;
+      *m = Archive_member();
+    }
+  this->free_member_read_files(this->member_offsets_.size());
+  this->member_reads_.clear();
+}
+
+// Free the files opened by Read_archive_members tasks for the members
+// before END in member_offsets_.  Each of those members has been
+// added to the link and switched over to our own file, or discarded.
+
+void
+Archive::free_member_read_files(size_t end)
+{
+  std::vector<Member_read_file>::iterator p;
+  for (p = this->member_read_files_.begin();
+       p != this->member_read_files_.end() && p->end <= end;
+       ++p)
+    {
+      if (p->input_file != NULL)
+	{
+	  const Input_file_argument* input_file_arg =
+	    p->input_file->input_file_argument();
+	  delete p->input_file;
+	  delete input_file_arg;
+	}
+    }
+  this->member_read_files_.erase(this->member_read_files_.begin(), p);
+}
+
 // Read the symbols from all the archive members in the link.
 
 void
@@ -757,69 +1021,121 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
   // offset we saw that was present in the seen_offsets_ set.
   off_t last_seen_offset = -1;
 
-  // Track which symbols in the symbol table we've already found to be
-  // defined.
+  // The first pass looks at every entry in the archive map which has
+  // not been checked.  After that, including a member can only change
+  // the answer for the entries which name one of its symbols, so we
+  // only look at those again.  We visit them in the order in which
+  // repeated passes over the whole archive map would, so that we
+  // include the same members in the same order.  THIS_PASS holds the
+  // entries to look at later in the current pass, NEXT_PASS those to
+  // look at in the next one.
+  std::set<size_t> this_pass;
+  std::set<size_t> next_pass;
+  bool first_pass = true;
+  size_t next_index = 0;
+  bool added_new_object = false;
+  std::vector<size_t> affected;
 
   char* tmpbuf = NULL;
   size_t tmpbuflen = 0;
-  bool added_new_object;
-  do
+  while (true)
     {
-      added_new_object = false;
-      for (size_t i = 0; i < armap_size; ++i)
+      size_t i;
+      if (first_pass && next_index < armap_size)
+	i = next_index++;
+      else
 	{
-          if (this->armap_checked_[i])
-            continue;
-	  if (this->armap_[i].file_offset == last_seen_offset)
-            {
-              this->armap_checked_[i] = true;
-              continue;
-            }
-	  if (this->seen_offsets_.find(this->armap_[i].file_offset)
-              != this->seen_offsets_.end())
+	  first_pass = false;
+	  if (this_pass.empty())
 	    {
-              this->armap_checked_[i] = true;
-	      last_seen_offset = this->armap_[i].file_offset;
-	      continue;
+	      if (next_pass.empty())
+		break;
+	      this_pass.swap(next_pass);
 	    }
+	  i = *this_pass.begin();
+	  this_pass.erase(this_pass.begin());
+	}
 
-	  const char* sym_name = (this->armap_names_.data()
-				  + this->armap_[i].name_offset);
+      if (this->armap_checked_[i])
+	continue;
+      if (this->armap_[i].file_offset == last_seen_offset)
+	{
+	  this->armap_checked_[i] = true;
+	  continue;
+	}
+      if (this->seen_offsets_.find(this->armap_[i].file_offset)
+	  != this->seen_offsets_.end())
+	{
+	  this->armap_checked_[i] = true;
+	  last_seen_offset = this->armap_[i].file_offset;
+	  continue;
+	}
 
-          Symbol* sym;
-          std::string why;
-          Archive::Should_include t =
-	    Archive::should_include_member(symtab, layout, sym_name, &sym,
-					   &why, &tmpbuf, &tmpbuflen);
+      const char* sym_name = (this->armap_names_.data()
+			      + this->armap_[i].name_offset);
 
-	  if (t == Archive::SHOULD_INCLUDE_NO
-              || t == Archive::SHOULD_INCLUDE_YES)
-	    this->armap_checked_[i] = true;
+      Symbol* sym;
+      std::string why;
+      Archive::Should_include t =
+	Archive::should_include_member(symtab, layout, sym_name, &sym,
+				       &why, &tmpbuf, &tmpbuflen);
 
-	  if (t != Archive::SHOULD_INCLUDE_YES)
-	    continue;
+      if (t == Archive::SHOULD_INCLUDE_NO
+	  || t == Archive::SHOULD_INCLUDE_YES)
+	this->armap_checked_[i] = true;
 
-	  // We want to include this object in the link.
-	  last_seen_offset = this->armap_[i].file_offset;
-	  this->seen_offsets_.insert(last_seen_offset);
+      if (t != Archive::SHOULD_INCLUDE_YES)
+	continue;
 
-	  if (!this->include_member(symtab, layout, input_objects,
-				    last_seen_offset, mapfile, sym,
-				    why.c_str()))
-	    {
-	      if (tmpbuf != NULL)
-		free(tmpbuf);
-	      return false;
-	    }
+      // We want to include this object in the link.
+      last_seen_offset = this->armap_[i].file_offset;
+      this->seen_offsets_.insert(last_seen_offset);
+
+      Object* obj;
+      if (!this->include_member(symtab, layout, input_objects,
+				last_seen_offset, mapfile, sym,
+				why.c_str(), &obj))
+	{
+	  if (tmpbuf != NULL)
+	    free(tmpbuf);
+	  return false;
+	}
 
-	  added_new_object = true;
+      added_new_object = true;
+
+      // Look again at the entries which the new symbols may affect:
+      // later in this pass if they come after this one, otherwise in
+      // the next pass.  During the first pass, we will see the later
+      // ones anyhow.
+      if (obj == NULL)
+	continue;
+      affected.clear();
+      this->find_armap_entries_for_object(obj, &affected);
+      for (std::vector<size_t>::const_iterator p = affected.begin();
+	   p != affected.end();
+	   ++p)
+	{
+	  if (*p <= i)
+	    next_pass.insert(*p);
+	  else if (!first_pass)
+	    this_pass.insert(*p);
 	}
     }
-  while (added_new_object);
 
   if (tmpbuf != NULL)
     free(tmpbuf);
 
+  // A final pass over the whole archive map would mark the entries
+  // for all the included members as checked.
+  if (added_new_object)
+    {
+      for (size_t i = 0; i < armap_size; ++i)
+	if (!this->armap_checked_[i]
+	    && (this->seen_offsets_.find(this->armap_[i].file_offset)
+		!= this->seen_offsets_.end()))
+	  this->armap_checked_[i] = true;
+    }
+
   input_objects->archive_stop(this);
 
   return true;
@@ -876,15 +1192,52 @@ Archive::include_all_members(Symbol_table* symtab, Layout* layout,
 
   input_objects->archive_start(this);
 
-  if (this->members_.size() > 0)
+  // Members kept from a previous incremental link are already
+  // included, and are the only ones in seen_offsets_ here.
+  if (this->have_member_offsets_)
     {
-      std::map<off_t, Archive_member>::const_iterator p;
-      for (p = this->members_.begin();
-           p != this->members_.end();
-           ++p)
+      // Hand each member read by a Read_archive_members task to
+      // include_member in turn, and free the file which the task
+      // opened once all of its members have been added.  If a member
+      // could not be read, include_member will read it again and
+      // report the problem.
+      const size_t nmembers = this->member_offsets_.size();
+      for (size_t i = 0; i < nmembers; ++i)
+        {
+	  off_t off = this->member_offsets_[i];
+	  if (i < this->member_reads_.size()
+	      && this->member_reads_[i].obj_ != NULL)
+	    {
+	      this->members_[off] = this->member_reads_[i];
+	      this->member_reads_[i] = Archive_member();
+	    }
+	  if (this->seen_offsets_.find(off) != this->seen_offsets_.end())
+	    continue;
+          if (!this->include_member(symtab, layout, input_objects, off,
+				    mapfile, NULL, "--whole-archive", NULL))
+	    {
+	      this->discard_member_reads(i + 1);
+	      return false;
+	    }
+          ++Archive::total_members;
+	  this->free_member_read_files(i + 1);
+        }
+      this->member_reads_.clear();
+    }
+  else if (this->members_.size() > 0)
+    {
+      // include_member removes each member from members_ as it uses
+      // it.
+      std::map<off_t, Archive_member>::const_iterator p =
+	this->members_.begin();
+      while (p != this->members_.end())
         {
-          if (!this->include_member(symtab, layout, input_objects, p->first,
-				    mapfile, NULL, "--whole-archive"))
+	  off_t off = p->first;
+	  ++p;
+	  if (this->seen_offsets_.find(off) != this->seen_offsets_.end())
+	    continue;
+          if (!this->include_member(symtab, layout, input_objects, off,
+				    mapfile, NULL, "--whole-archive", NULL))
 	    return false;
           ++Archive::total_members;
         }
@@ -895,8 +1248,10 @@ Archive::include_all_members(Symbol_table* symtab, Layout* layout,
            p != this->end();
            ++p)
         {
+	  if (this->seen_offsets_.find(p->off) != this->seen_offsets_.end())
+	    continue;
           if (!this->include_member(symtab, layout, input_objects, p->off,
-				    mapfile, NULL, "--whole-archive"))
+				    mapfile, NULL, "--whole-archive", NULL))
 	    return false;
           ++Archive::total_members;
         }
@@ -913,6 +1268,9 @@ Archive::include_all_members(Symbol_table* symtab, Layout* layout,
 size_t
 Archive::count_members()
 {
+  if (this->have_member_offsets_)
+    return this->member_offsets_.size();
+
   size_t ret = 0;
   for (Archive::const_iterator p = this->begin();
        p != this->end();
@@ -930,25 +1288,47 @@ Archive::count_members()
 bool
 Archive::include_member(Symbol_table* symtab, Layout* layout,
 			Input_objects* input_objects, off_t off,
-			Mapfile* mapfile, Symbol* sym, const char* why)
+			Mapfile* mapfile, Symbol* sym, const char* why,
+			Object** pobj)
 {
   ++Archive::total_members_loaded;
 
-  std::map<off_t, Archive_member>::const_iterator p = this->members_.find(off);
+  if (pobj != NULL)
+    *pobj = NULL;
+
+  std::map<off_t, Archive_member>::iterator p = this->members_.find(off);
   if (p != this->members_.end())
     {
       Object* obj = p->second.obj_;
-
       Read_symbols_data* sd = p->second.sd_;
+      this->members_.erase(p);
+
       if (mapfile != NULL)
         mapfile->report_include_archive_member(obj->name(), sym, why);
+
+      // A member read by a Read_archive_members task has its own file,
+      // which we must lock while we use and release its views.  After
+      // that we read the member through our own file.
+      File_read* member_file = &obj->input_file()->file();
+      bool lock_member_file = member_file != &this->input_file_->file();
+      if (lock_member_file)
+	member_file->lock(this->task_);
+
       if (input_objects->add_object(obj))
         {
           obj->layout(symtab, layout, sd);
           obj->add_symbols(symtab, sd, layout);
 	  this->included_member_ = true;
+	  if (pobj != NULL)
+	    *pobj = obj;
         }
       delete sd;
+
+      if (lock_member_file)
+	{
+	  member_file->unlock(this->task_);
+	  obj->set_input_file(this->input_file_);
+	}
       return true;
     }
 
@@ -977,6 +1357,8 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
     {
       pluginobj->add_symbols(symtab, NULL, layout);
       this->included_member_ = true;
+      if (pobj != NULL)
+	*pobj = obj;
       return true;
     }
 
@@ -1005,11 +1387,65 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
         obj->unlock(this->task_);
 
       this->included_member_ = true;
+      if (pobj != NULL)
+	*pobj = obj;
     }
 
   return true;
 }
 
+// Put into *ENTRIES the indexes of the unchecked entries in the
+// archive map which name a symbol of OBJ, which was just included.
+// For a plugin object we don't have the symbols, so we return all the
+// unchecked entries.
+
+void
+Archive::find_armap_entries_for_object(Object* obj,
+				       std::vector<size_t>* entries)
+{
+  const size_t armap_size = this->armap_.size();
+  if (obj->pluginobj() != NULL)
+    {
+      for (size_t i = 0; i < armap_size; ++i)
+	if (!this->armap_checked_[i])
+	  entries->push_back(i);
+      return;
+    }
+
+  // Index the archive map by symbol name, without the version, the
+  // first time we need it.
+  if (this->armap_index_.empty())
+    {
+      for (size_t i = 0; i < armap_size; ++i)
+	{
+	  const char* name = (this->armap_names_.data()
+			      + this->armap_[i].name_offset);
+	  const char* ver = strchr(name, '@');
+	  size_t len = ver == NULL ? strlen(name) : ver - name;
+	  this->armap_index_[std::string(name, len)].push_back(i);
+	}
+    }
+
+  const Object::Symbols* syms = obj->get_global_symbols();
+  if (syms == NULL)
+    return;
+  for (Object::Symbols::const_iterator p = syms->begin();
+       p != syms->end();
+       ++p)
+    {
+      if (*p == NULL)
+	continue;
+      Armap_index::const_iterator pi = this->armap_index_.find((*p)->name());
+      if (pi == this->armap_index_.end())
+	continue;
+      for (std::vector<size_t>::const_iterator q = pi->second.begin();
+	   q != pi->second.end();
+	   ++q)
+	if (!this->armap_checked_[*q])
+	  entries->push_back(*q);
+    }
+}
+
 // Iterate over all unused symbols, and call the visitor class V for each.
 
 void
@@ -1044,16 +1480,21 @@ Add_archive_symbols::~Add_archive_symbols()
 {
   if (this->this_blocker_ != NULL)
     delete this->this_blocker_;
+  if (this->members_blocker_ != NULL)
+    delete this->members_blocker_;
   // next_blocker_ is deleted by the task associated with the next
   // input file.
 }
 
 // Return whether we can add the archive symbols.  We are blocked by
-// this_blocker_.  We block next_blocker_.  We also lock the file.
+// members_blocker_ and this_blocker_.  We block next_blocker_.  We
+// also lock the file.
 
 Task_token*
 Add_archive_symbols::is_runnable()
 {
+  if (this->members_blocker_ != NULL && this->members_blocker_->is_blocked())
+    return this->members_blocker_;
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
   return NULL;
@@ -1077,6 +1518,7 @@ Add_archive_symbols::run(Workqueue* workqueue)
       Script_info* script_info = this->input_argument_->script_info();
       incremental_inputs->report_archive_begin(this->archive_, arg_serial,
 					       script_info);
+      this->archive_->mark_kept_members_included();
     }
 
   bool added = this->archive_->add_symbols(this->symtab_, this->layout_,
@@ -1125,6 +1567,20 @@ Add_archive_symbols::run(Workqueue* workqueue)
     }
 }
 
+// Class Read_archive_members.
+
+void
+Read_archive_members::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+}
+
+void
+Read_archive_members::run(Workqueue*)
+{
+  this->archive_->read_members(this, this->index_);
+}
+
 // Class Lib_group static variables.
 unsigned int Lib_group::total_lib_groups;
 unsigned int Lib_group::total_members;
@@ -23,6 +23,7 @@
 #ifndef GOLD_ARCHIVE_H
 #define GOLD_ARCHIVE_H
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -43,6 +44,7 @@ class Object;
 struct Read_symbols_data;
 class Input_file_lib;
 class Incremental_archive_entry;
+struct Incremental_member_info;
 
 // An entry in the archive map of offsets to members.
 struct Archive_member
@@ -84,6 +86,11 @@ class Library_base
   get_mtime()
   { return this->do_get_mtime(); }
 
+  // A hash of the contents of the archive file.
+  uint64_t
+  get_content_hash()
+  { return this->do_get_content_hash(); }
+
   // When we see a symbol in an archive we might decide to include the member,
   // not include the member or be undecided. This enum represents these
   // possibilities.
@@ -110,6 +117,13 @@ class Library_base
   incremental_info() const
   { return this->incremental_info_; }
 
+  // Set *INFO to the location and contents hash of the member OBJ,
+  // for the incremental link info.  Return false if they are not
+  // known.
+  bool
+  get_member_info(Object* obj, Incremental_member_info* info)
+  { return this->do_get_member_info(obj, info); }
+
   // Abstract base class for processing unused symbols.
   class Symbol_visitor_base
   {
@@ -148,6 +162,15 @@ class Library_base
   virtual Timespec
   do_get_mtime() = 0;
 
+  // Return a hash of the contents of the archive file.
+  virtual uint64_t
+  do_get_content_hash() = 0;
+
+  // Get the location and contents hash of a member.
+  virtual bool
+  do_get_member_info(Object*, Incremental_member_info*)
+  { return false; }
+
   // Iterator for unused global symbols in the library.
   virtual void
   do_for_all_unused_symbols(Symbol_visitor_base* v) const = 0;
@@ -191,6 +214,17 @@ class Archive : public Library_base
   void
   setup();
 
+  // For --whole-archive, queue tasks to read the symbols of the
+  // archive members in parallel.  Return a token which blocks until
+  // they are done, or NULL if we didn't queue any tasks.
+  Task_token*
+  queue_read_members(Workqueue*);
+
+  // Read the symbols of the archive members for the INDEX'th
+  // Read_archive_members task, which is TASK.
+  void
+  read_members(const Task* task, size_t index);
+
   // Get a reference to the underlying file.
   File_read&
   file()
@@ -239,6 +273,19 @@ class Archive : public Library_base
   void
   unlock_nested_archives();
 
+  // For an incremental update, treat the members which were kept
+  // from the previous link of this archive as already included.
+  void
+  mark_kept_members_included();
+
+  // For an incremental update, set *MEMBERS to the location, size and
+  // contents hash of each member of this archive, keyed by the name
+  // of the object for the member.  Return false for a thin archive,
+  // whose members are not in the archive file.
+  bool
+  get_all_member_info(std::map<std::string, Incremental_member_info>*
+		      members);
+
   // Select members from the archive as needed and add them to the
   // link.
   bool
@@ -275,6 +322,14 @@ class Archive : public Library_base
   do_get_mtime()
   { return this->file().get_mtime(); }
 
+  // A hash of the contents of the archive file.
+  uint64_t
+  do_get_content_hash();
+
+  // The location and contents hash of a member.
+  bool
+  do_get_member_info(Object* obj, Incremental_member_info* info);
+
   struct Archive_header;
 
   // Total number of archives seen.
@@ -297,7 +352,17 @@ class Archive : public Library_base
   // the file view.  Return the size of the member, and set *PNAME to
   // the name.
   off_t
-  read_header(off_t off, bool cache, std::string* pname, off_t* nested_off);
+  read_header(off_t off, bool cache, std::string* pname, off_t* nested_off)
+  {
+    return this->read_header(&this->input_file_->file(), off, cache, pname,
+			     nested_off);
+  }
+
+  // Likewise, but read the header from FILE, which is either our own
+  // file or the same archive opened again.
+  off_t
+  read_header(File_read* file, off_t off, bool cache, std::string* pname,
+	      off_t* nested_off);
 
   // Interpret an archive header HDR at OFF.  Return the size of the
   // member, and set *PNAME to the name.
@@ -318,6 +383,23 @@ class Archive : public Library_base
   Object*
   get_elf_object_for_member(off_t off, bool*);
 
+  // Make an ELF object for the member MEMBER_NAME at offset MEMOFF in
+  // INPUT_FILE.  Set *IS_ELF to whether it is an ELF object.
+  Object*
+  make_member_elf_object(Input_file* input_file, off_t memoff,
+			 const std::string& member_name, bool* is_elf,
+			 bool* punconfigured);
+
+  // Discard the members read by Read_archive_members tasks from
+  // START on, and free the files which those tasks opened.
+  void
+  discard_member_reads(size_t start);
+
+  // Free the files opened by Read_archive_members tasks for the
+  // members before END in member_offsets_, which have all been used.
+  void
+  free_member_read_files(size_t end);
+
   // Read the symbols from all the archive members in the link.
   void
   read_all_symbols();
@@ -331,10 +413,17 @@ class Archive : public Library_base
   bool
   include_all_members(Symbol_table*, Layout*, Input_objects*, Mapfile*);
 
-  // Include an archive member in the link.
+  // Include an archive member in the link.  If POBJ is not NULL, set
+  // *POBJ to the object whose symbols were added, or NULL if none
+  // were.
   bool
   include_member(Symbol_table*, Layout*, Input_objects*, off_t off,
-		 Mapfile*, Symbol*, const char* why);
+		 Mapfile*, Symbol*, const char* why, Object** pobj);
+
+  // Find the unchecked entries in the archive map which may be
+  // affected by the symbols of OBJ.
+  void
+  find_armap_entries_for_object(Object* obj, std::vector<size_t>* entries);
 
   // Return whether we found this archive by searching a directory.
   bool
@@ -376,6 +465,24 @@ class Archive : public Library_base
   // For keeping track of open nested archives in a thin archive file.
   typedef Unordered_map<std::string, Archive*> Nested_archive_table;
 
+  // The file opened by a Read_archive_members task to read the
+  // members from START up to END in member_offsets_.  INPUT_FILE is
+  // NULL if the task did not read any members.
+  struct Member_read_file
+  {
+    Member_read_file(size_t a_start, size_t a_end)
+      : start(a_start), end(a_end), input_file(NULL)
+    { }
+
+    size_t start;
+    size_t end;
+    Input_file* input_file;
+  };
+
+  // Map from a symbol name, without any version, to the indexes of
+  // the entries in the archive map which name it.
+  typedef Unordered_map<std::string, std::vector<size_t> > Armap_index;
+
   // Name of object as printed to user.
   std::string name_;
   // For reading the file.
@@ -391,8 +498,20 @@ class Archive : public Library_base
   std::vector<bool> armap_checked_;
   // Track which elements have been included by offset.
   Unordered_set<off_t, Seen_hash> seen_offsets_;
+  // Index of the archive map, built when first needed.
+  Armap_index armap_index_;
   // Table of objects whose symbols have been pre-read.
   std::map<off_t, Archive_member> members_;
+  // The file offsets of the archive members, if we have collected
+  // them to read the members in Read_archive_members tasks.
+  std::vector<off_t> member_offsets_;
+  // True if member_offsets_ is valid.
+  bool have_member_offsets_;
+  // The members read by Read_archive_members tasks, indexed like
+  // member_offsets_.  The tasks each fill in a separate part.
+  std::vector<Archive_member> member_reads_;
+  // The files opened by the Read_archive_members tasks, in order.
+  std::vector<Member_read_file> member_read_files_;
   // True if this is a thin archive.
   const bool is_thin_archive_;
   // True if we have included at least one object from this archive.
@@ -426,11 +545,19 @@ class Add_archive_symbols : public Task
       dirpath_(dirpath), dirindex_(dirindex), mapfile_(mapfile),
       input_argument_(input_argument), archive_(archive),
       input_group_(input_group), this_blocker_(this_blocker),
-      next_blocker_(next_blocker)
+      next_blocker_(next_blocker), members_blocker_(NULL)
   { }
 
   ~Add_archive_symbols();
 
+  // Set the blocker for the Read_archive_members tasks.
+  void
+  set_members_blocker(Task_token* members_blocker)
+  {
+    gold_assert(this->members_blocker_ == NULL);
+    this->members_blocker_ = members_blocker;
+  }
+
   // The standard Task methods.
 
   Task_token*
@@ -462,6 +589,40 @@ class Add_archive_symbols : public Task
   Input_group* input_group_;
   Task_token* this_blocker_;
   Task_token* next_blocker_;
+  Task_token* members_blocker_;
+};
+
+// This class is used to read the symbols of some of the members of a
+// --whole-archive archive, in parallel with the other members.
+
+class Read_archive_members : public Task
+{
+ public:
+  Read_archive_members(Archive* archive, size_t index,
+		       Task_token* next_blocker)
+    : archive_(archive), index_(index), next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Read_archive_members " + this->archive_->filename(); }
+
+ private:
+  Archive* archive_;
+  size_t index_;
+  Task_token* next_blocker_;
 };
 
 // This class represents the files surrounded by a --start-lib ... --end-lib.
@@ -507,6 +668,11 @@ class Lib_group : public Library_base
   do_get_mtime()
   { return Timespec(0, 0); }
 
+  // Nor does it have any contents to hash.
+  uint64_t
+  do_get_content_hash()
+  { return 0; }
+
   // Iterator for unused global symbols in the library.
   void
   do_for_all_unused_symbols(Symbol_visitor_base*) const;
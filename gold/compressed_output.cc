@@ -28,6 +28,7 @@
 
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
@@ -35,50 +36,80 @@ namespace gold
 
 #ifdef HAVE_ZLIB_H
 
-// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
-// if it successfully compressed, false if it failed for any reason
-// (including not having zlib support in the library).  If it returns
-// true, it allocates memory for the compressed data using new, and
-// sets *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
-// It also writes a header before COMPRESSED_DATA: 4 bytes saying
-// "ZLIB", and 8 bytes indicating the uncompressed size, in big-endian
-// order.
+// Compress LEN bytes at DATA as one piece of a raw deflate stream.
+// The DICT_LEN bytes immediately preceding DATA are used as the
+// preset dictionary, so that the compression ratio is close to that
+// of compressing the whole buffer at once.  If IS_LAST is true, this
+// ends the stream; otherwise the output ends on a byte boundary so
+// that the next piece may simply be appended.  Returns true on
+// success, in which case it allocates memory for the compressed data
+// using new and sets *COMPRESSED_DATA and *COMPRESSED_SIZE.  It also
+// sets *CHECKSUM to the adler32 checksum of the uncompressed data.
 
 static bool
-zlib_compress(const unsigned char* uncompressed_data,
-              unsigned long uncompressed_size,
-              unsigned char** compressed_data,
-              unsigned long* compressed_size)
+zlib_compress_chunk(const unsigned char* data, unsigned long len,
+		    unsigned long dict_len, bool is_last,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size,
+		    unsigned long* checksum)
 {
-  const int header_size = 12;
-  *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
-  *compressed_data = new unsigned char[*compressed_size + header_size];
-
   int compress_level;
   if (parameters->options().optimize() >= 1)
     compress_level = 9;
   else
     compress_level = 1;
 
-  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
-                     compressed_size,
-                     reinterpret_cast<const Bytef*>(uncompressed_data),
-                     uncompressed_size,
-                     compress_level);
-  if (rc == Z_OK)
+  z_stream strm;
+  memset(&strm, 0, sizeof strm);
+  if (deflateInit2(&strm, compress_level, Z_DEFLATED, -MAX_WBITS, 8,
+		   Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+  if (dict_len > 0
+      && deflateSetDictionary(&strm,
+			      reinterpret_cast<const Bytef*>(data - dict_len),
+			      dict_len) != Z_OK)
     {
-      memcpy(*compressed_data, "ZLIB", 4);
-      elfcpp::Swap_unaligned<64, true>::writeval(*compressed_data + 4,
-						 uncompressed_size);
-      *compressed_size += header_size;
-      return true;
+      deflateEnd(&strm);
+      return false;
     }
+
+  // Leave room for the empty block emitted by Z_SYNC_FLUSH.
+  unsigned long bound = deflateBound(&strm, len) + 16;
+  *compressed_data = new unsigned char[bound];
+  strm.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(data));
+  strm.avail_in = len;
+  strm.next_out = reinterpret_cast<Bytef*>(*compressed_data);
+  strm.avail_out = bound;
+
+  int rc = deflate(&strm, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool ok;
+  if (is_last)
+    ok = rc == Z_STREAM_END;
   else
+    ok = rc == Z_OK && strm.avail_in == 0 && strm.avail_out > 0;
+  *compressed_size = bound - strm.avail_out;
+  deflateEnd(&strm);
+
+  if (!ok)
     {
       delete[] *compressed_data;
       *compressed_data = NULL;
       return false;
     }
+
+  *checksum = adler32(adler32(0, NULL, 0),
+		      reinterpret_cast<const Bytef*>(data), len);
+  return true;
+}
+
+// Combine the adler32 checksums CHECKSUM1 and CHECKSUM2, where
+// CHECKSUM2 covers LEN2 bytes.
+
+static unsigned long
+zlib_combine_checksums(unsigned long checksum1, unsigned long checksum2,
+		       unsigned long len2)
+{
+  return adler32_combine(checksum1, checksum2, len2);
 }
 
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
@@ -127,12 +158,18 @@ zlib_decompress(const unsigned char* compressed_data,
 #else // !defined(HAVE_ZLIB_H)
 
 static bool
-zlib_compress(const unsigned char*, unsigned long,
-              unsigned char**, unsigned long*)
+zlib_compress_chunk(const unsigned char*, unsigned long, unsigned long,
+		    bool, unsigned char**, unsigned long*, unsigned long*)
 {
   return false;
 }
 
+static unsigned long
+zlib_combine_checksums(unsigned long, unsigned long, unsigned long)
+{
+  return 0;
+}
+
 static bool
 zlib_decompress(const unsigned char*, unsigned long,
 		unsigned char*, unsigned long)
@@ -191,29 +228,241 @@ decompress_input_section(const unsigned char* compressed_data,
 
 // Class Output_compressed_section.
 
+// Section contents are compressed in pieces of this size, which may
+// be done in parallel.  The pieces do not depend on the number of
+// threads, so the output is the same either way.
+
+static const size_t compress_chunk_size = 1024 * 1024;
+
+// The amount of the preceding data used as the dictionary for each
+// piece.  This is the largest window that deflate supports.
+
+static const size_t compress_dictionary_size = 32 * 1024;
+
+// A task to prepare a section for compression.
+
+class Compress_prepare_task : public Task
+{
+ public:
+  Compress_prepare_task(Output_compressed_section* os,
+			Task_token* blocker, Task_token* chunks_blocker)
+    : os_(os), blocker_(blocker), chunks_blocker_(chunks_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->prepare_to_compress(); }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->blocker_->is_blocked())
+      return this->blocker_;
+    return NULL;
+  }
+
+  // Unblock CHUNKS_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->chunks_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Compress_prepare_task " + std::string(this->os_->name()); }
+
+ private:
+  Output_compressed_section* os_;
+  Task_token* blocker_;
+  Task_token* chunks_blocker_;
+};
+
+// A task to compress one piece of a section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, size_t chunk,
+		      Task_token* chunks_blocker, Task_token* final_blocker)
+    : os_(os), chunk_(chunk), chunks_blocker_(chunks_blocker),
+      final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->chunks_blocker_->is_blocked())
+      return this->chunks_blocker_;
+    return NULL;
+  }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Compress_chunk_task " + std::string(this->os_->name()); }
+
+ private:
+  Output_compressed_section* os_;
+  size_t chunk_;
+  Task_token* chunks_blocker_;
+  Task_token* final_blocker_;
+};
+
+// Return the number of pieces to compress.  An empty section still
+// has one piece, which holds the end of the compressed stream.
+
+size_t
+Output_compressed_section::chunk_count() const
+{
+  size_t size =
+    convert_to_section_size_type(this->postprocessing_buffer_size());
+  if (size == 0)
+    return 1;
+  return (size + compress_chunk_size - 1) / compress_chunk_size;
+}
+
+// Queue the tasks to compress the section.
+
+void
+Output_compressed_section::queue_compress_tasks(Workqueue* workqueue,
+						Task_token* blocker,
+						Task_token* final_blocker)
+{
+  Task_token* chunks_blocker = new Task_token(true);
+  chunks_blocker->add_blocker();
+  workqueue->queue(new Compress_prepare_task(this, blocker, chunks_blocker));
+  size_t count = this->chunk_count();
+  for (size_t i = 0; i < count; ++i)
+    workqueue->queue(new Compress_chunk_task(this, i, chunks_blocker,
+					     final_blocker));
+}
+
+// At this point the contents of all regular input sections will have
+// been copied into the postprocessing buffer, and relocations will
+// have been applied.  Now we need to copy in the contents of anything
+// other than a regular input section.
+
+void
+Output_compressed_section::prepare_to_compress()
+{
+  gold_assert(!this->is_prepared_);
+  this->write_to_postprocessing_buffer();
+  this->chunks_.resize(this->chunk_count());
+  this->is_prepared_ = true;
+}
+
+// Compress piece I of the section.
+
+void
+Output_compressed_section::compress_chunk(size_t i)
+{
+  gold_assert(this->is_prepared_ && i < this->chunks_.size());
+  Compressed_chunk* chunk = &this->chunks_[i];
+  gold_assert(!chunk->is_done);
+
+  size_t size =
+    convert_to_section_size_type(this->postprocessing_buffer_size());
+  size_t start = i * compress_chunk_size;
+  size_t len = std::min(compress_chunk_size, size - start);
+  size_t dict_len = std::min(compress_dictionary_size, start);
+  bool is_last = i + 1 == this->chunks_.size();
+
+  if (strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
+    chunk->is_ok = zlib_compress_chunk(this->postprocessing_buffer() + start,
+				       len, dict_len, is_last, &chunk->data,
+				       &chunk->size, &chunk->checksum);
+  chunk->is_done = true;
+}
+
+// Put the compressed pieces together as a single zlib stream.  This
+// writes a header before the stream: 4 bytes saying "ZLIB", and 8
+// bytes indicating the uncompressed size, in big-endian order.  The
+// pieces are freed as they are copied.
+
+bool
+Output_compressed_section::assemble_chunks(unsigned long* compressed_size)
+{
+  const int header_size = 12;
+  const int zlib_header_size = 2;
+  const int zlib_trailer_size = 4;
+
+  bool ok = true;
+  unsigned long total = header_size + zlib_header_size + zlib_trailer_size;
+  for (size_t i = 0; i < this->chunks_.size(); ++i)
+    {
+      if (!this->chunks_[i].is_ok)
+	ok = false;
+      total += this->chunks_[i].size;
+    }
+
+  if (ok)
+    {
+      off_t uncompressed_size = this->postprocessing_buffer_size();
+      this->data_ = new unsigned char[total];
+      unsigned char* p = this->data_;
+      memcpy(p, "ZLIB", 4);
+      elfcpp::Swap_unaligned<64, true>::writeval(p + 4, uncompressed_size);
+      p += header_size;
+
+      // The zlib header: deflate with a 32K window, and the
+      // compression level.
+      p[0] = 0x78;
+      p[1] = parameters->options().optimize() >= 1 ? 0xda : 0x01;
+      p += zlib_header_size;
+
+      unsigned long checksum = 0;
+      for (size_t i = 0; i < this->chunks_.size(); ++i)
+	{
+	  const Compressed_chunk& chunk(this->chunks_[i]);
+	  memcpy(p, chunk.data, chunk.size);
+	  p += chunk.size;
+	  if (i == 0)
+	    checksum = chunk.checksum;
+	  else
+	    {
+	      size_t start = i * compress_chunk_size;
+	      size_t len = std::min(compress_chunk_size,
+				    static_cast<size_t>(uncompressed_size)
+				    - start);
+	      checksum = zlib_combine_checksums(checksum, chunk.checksum, len);
+	    }
+	}
+      elfcpp::Swap_unaligned<32, true>::writeval(p, checksum);
+      *compressed_size = total;
+    }
+
+  for (size_t i = 0; i < this->chunks_.size(); ++i)
+    delete[] this->chunks_[i].data;
+  this->chunks_.clear();
+
+  return ok;
+}
+
 // Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// we actually compress the section data, unless that was already
+// done by Compress_chunk_tasks.
 
 void
 Output_compressed_section::set_final_data_size()
 {
   off_t uncompressed_size = this->postprocessing_buffer_size();
 
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+  if (!this->is_prepared_)
+    this->prepare_to_compress();
 
-  // At this point the contents of all regular input sections will
-  // have been copied into the postprocessing buffer, and relocations
-  // will have been applied.  Now we need to copy in the contents of
-  // anything other than a regular input section.
-  this->write_to_postprocessing_buffer();
+  for (size_t i = 0; i < this->chunks_.size(); ++i)
+    if (!this->chunks_[i].is_done)
+      this->compress_chunk(i);
 
-  bool success = false;
-  if (strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
-    success = zlib_compress(uncompressed_data, uncompressed_size,
-                            &this->data_, &compressed_size);
-  if (success)
+  unsigned long compressed_size;
+  if (this->assemble_chunks(&compressed_size))
     {
       // This converts .debug_foo to .zdebug_foo
       this->new_section_name_ = std::string(".z") + (this->name() + 1);
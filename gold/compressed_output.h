@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Workqueue;
+class Task_token;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -60,9 +63,31 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), is_prepared_(false), chunks_()
   { this->set_requires_postprocessing(); }
 
+  // Return the number of pieces in which the section contents are
+  // compressed.
+  size_t
+  chunk_count() const;
+
+  // Queue tasks to compress the section contents in parallel once
+  // BLOCKER is unblocked.  Each of the chunk_count() tasks unblocks
+  // FINAL_BLOCKER when it completes; the caller must have added the
+  // blockers.
+  void
+  queue_compress_tasks(Workqueue*, Task_token* blocker,
+		       Task_token* final_blocker);
+
+  // Copy the data which does not come from input sections into the
+  // postprocessing buffer, so that the contents are complete.
+  void
+  prepare_to_compress();
+
+  // Compress chunk I of the section contents.
+  void
+  compress_chunk(size_t i);
+
  protected:
   // Set the final data size.
   void
@@ -73,12 +98,40 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // The compressed form of one piece of the section contents.
+  struct Compressed_chunk
+  {
+    Compressed_chunk()
+      : data(NULL), size(0), checksum(0), is_done(false), is_ok(false)
+    { }
+
+    // The compressed data.
+    unsigned char* data;
+    // The size of the compressed data.
+    unsigned long size;
+    // The checksum of the uncompressed data.
+    unsigned long checksum;
+    // Whether we have tried to compress this chunk.
+    bool is_done;
+    // Whether the compression succeeded.
+    bool is_ok;
+  };
+
+  // Combine the compressed chunks into the section contents.  Returns
+  // false if any chunk could not be compressed.
+  bool
+  assemble_chunks(unsigned long* compressed_size);
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
   // The new section name if we do compress.
   std::string new_section_name_;
+  // Whether prepare_to_compress has been called.
+  bool is_prepared_;
+  // The compressed pieces of the section.
+  std::vector<Compressed_chunk> chunks_;
 };
 
 } // End namespace gold.
@@ -32,6 +32,7 @@
 #include "dwarf_reader.h"
 #include "int_encoding.h"
 #include "compressed_output.h"
+#include "gold-threads.h"
 
 namespace gold {
 
@@ -2234,6 +2235,34 @@ Sized_dwarf_line_info<size, big_endian>::format_file_lineno(
 
 // Dwarf_line_info routines.
 
+// Make a Dwarf_line_info for the given section of OBJECT.
+
+static Dwarf_line_info*
+make_dwarf_line_info(Object* object, unsigned int shndx)
+{
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      return new Sized_dwarf_line_info<32, false>(object, shndx);
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      return new Sized_dwarf_line_info<32, true>(object, shndx);
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      return new Sized_dwarf_line_info<64, false>(object, shndx);
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      return new Sized_dwarf_line_info<64, true>(object, shndx);
+#endif
+    default:
+      gold_unreachable();
+    }
+}
+
 static unsigned int next_generation_count = 0;
 
 struct Addr2line_cache_entry
@@ -2285,30 +2314,11 @@ Dwarf_line_info::one_addr2line(Object* object,
   // If we don't hit the cache, create a new object and insert into the
   // cache.
   if (lineinfo == NULL)
-  {
-    switch (parameters->size_and_endianness())
-      {
-#ifdef HAVE_TARGET_32_LITTLE
-        case Parameters::TARGET_32_LITTLE:
-          lineinfo = new Sized_dwarf_line_info<32, false>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_32_BIG
-        case Parameters::TARGET_32_BIG:
-          lineinfo = new Sized_dwarf_line_info<32, true>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_64_LITTLE
-        case Parameters::TARGET_64_LITTLE:
-          lineinfo = new Sized_dwarf_line_info<64, false>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_64_BIG
-        case Parameters::TARGET_64_BIG:
-          lineinfo = new Sized_dwarf_line_info<64, true>(object, shndx); break;
-#endif
-        default:
-          gold_unreachable();
-      }
-    addr2line_cache.push_back(Addr2line_cache_entry(object, shndx, lineinfo));
-  }
+    {
+      lineinfo = make_dwarf_line_info(object, shndx);
+      addr2line_cache.push_back(Addr2line_cache_entry(object, shndx,
+						      lineinfo));
+    }
 
   // Now that we have our object, figure out the answer
   std::string retval = lineinfo->addr2line(shndx, offset, other_lines);
@@ -2351,6 +2361,72 @@ Dwarf_line_info::clear_addr2line_cache()
   addr2line_cache.clear();
 }
 
+// Class Addr2line_cache.
+
+Addr2line_cache::Addr2line_cache()
+  : lock_(new Lock()), line_infos_()
+{
+}
+
+Addr2line_cache::~Addr2line_cache()
+{
+  for (Line_info_map::iterator p = this->line_infos_.begin();
+       p != this->line_infos_.end();
+       ++p)
+    delete p->second;
+  delete this->lock_;
+}
+
+// Return the canonical filename:lineno for OFFSET in section SHNDX of
+// OBJECT, reading the line table if we have not seen it before.  We
+// read it without holding the lock, since TASK holds the lock of
+// OBJECT, so no other thread looks up the same object.
+
+std::string
+Addr2line_cache::addr2line(const Task* task, Object* object,
+			   unsigned int shndx, off_t offset,
+			   std::vector<std::string>* other_lines)
+{
+  gold_assert(object->is_locked_by(task));
+
+  Key key(object, shndx);
+  Dwarf_line_info* lineinfo = NULL;
+  {
+    Hold_lock hl(*this->lock_);
+    Line_info_map::const_iterator p = this->line_infos_.find(key);
+    if (p != this->line_infos_.end())
+      lineinfo = p->second;
+  }
+
+  if (lineinfo == NULL)
+    {
+      lineinfo = make_dwarf_line_info(object, shndx);
+      Hold_lock hl(*this->lock_);
+      this->line_infos_[key] = lineinfo;
+    }
+
+  return lineinfo->addr2line(shndx, offset, other_lines);
+}
+
+// Free the line tables read for OBJECT.
+
+void
+Addr2line_cache::release_object(Object* object)
+{
+  Hold_lock hl(*this->lock_);
+  Line_info_map::iterator p = this->line_infos_.begin();
+  while (p != this->line_infos_.end())
+    {
+      if (p->first.first == object)
+	{
+	  delete p->second;
+	  this->line_infos_.erase(p++);
+	}
+      else
+	++p;
+    }
+}
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 class Sized_dwarf_line_info<32, false>;
@@ -38,6 +38,7 @@ namespace gold
 {
 
 class Dwarf_info_reader;
+class Lock;
 struct LineStateMachine;
 
 // This class is used to extract the section index and offset of
@@ -986,6 +987,51 @@ class Dwarf_line_info
                std::vector<std::string>* other_lines) = 0;
 };
 
+// A cache of Dwarf_line_info objects, keyed by object and section,
+// which may be shared by several threads.  Each task must hold the
+// lock of the objects it looks up, so two threads never read the
+// line table of the same object.
+
+class Addr2line_cache
+{
+ public:
+  Addr2line_cache();
+
+  ~Addr2line_cache();
+
+  // Like Dwarf_line_info::one_addr2line, but look up the line table
+  // in this cache, and never evict it.  TASK must hold the lock of
+  // OBJECT.
+  std::string
+  addr2line(const Task* task, Object* object, unsigned int shndx,
+	    off_t offset, std::vector<std::string>* other_lines);
+
+  // Free the line tables read for OBJECT.
+  void
+  release_object(Object* object);
+
+ private:
+  // This class can not be copied.
+  Addr2line_cache(const Addr2line_cache&);
+  Addr2line_cache& operator=(const Addr2line_cache&);
+
+  typedef std::pair<Object*, unsigned int> Key;
+
+  struct Key_hash
+  {
+    size_t
+    operator()(const Key& key) const
+    { return reinterpret_cast<uintptr_t>(key.first) ^ key.second; }
+  };
+
+  typedef Unordered_map<Key, Dwarf_line_info*, Key_hash> Line_info_map;
+
+  // Lock to hold while using LINE_INFOS_.
+  Lock* lock_;
+  // The line tables read so far.
+  Line_info_map line_infos_;
+};
+
 template<int size, bool big_endian>
 class Sized_dwarf_line_info : public Dwarf_line_info
 {
@@ -28,8 +28,11 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <sys/stat.h>
 
 #include <vector>
+#include <set>
+#include <map>
 #include <algorithm>
 
 #include "getopt.h"
@@ -45,6 +48,7 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -70,6 +74,9 @@ struct Dwo_file_entry
 };
 typedef std::vector<Dwo_file_entry> File_list;
 
+// A set of DWO IDs.
+typedef std::set<uint64_t> Dwo_id_set;
+
 // Type to hold the offset and length of an input section
 // within an output section.
 
@@ -109,20 +116,49 @@ class Dwo_file
  public:
   Dwo_file(const char* name)
     : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+      sect_offsets_(), str_offset_map_(), machine_(0), size_(0),
+      big_endian_(false), osabi_(0), abiversion_(0), debug_types_(),
+      debug_str_(0), debug_cu_index_(0), debug_tu_index_(0), strings_(),
+      str_contents_(NULL), str_is_new_(false), wanted_cus_(NULL),
+      found_cus_(NULL), package_sections_(), contribution_map_(),
+      package_str_offsets_()
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
+  // Return the filename.
+  const char*
+  name() const
+  { return this->name_; }
+
   // Read the input executable file and extract the list of .dwo files
   // that it references.
   void
   read_executable(File_list* files);
 
-  // Read the input file and send its contents to OUTPUT_FILE.
+  // Open the input file, find its debug sections, decompress them,
+  // and hash the strings in its string table.  This does not touch
+  // the output file, so it may run in parallel for several inputs.
+  void
+  prepare();
+
+  // Read the input file and send its contents to OUTPUT_FILE.  This
+  // calls prepare if it has not already been called.
   void
   read(Dwp_output_file* output_file);
 
+  // Read a .dwp file produced by an earlier run, and send to
+  // OUTPUT_FILE the compilation units whose DWO IDs are in WANTED,
+  // and all of the type units.  Only the parts of the other sections
+  // used by those units are copied.  Add the DWO IDs of the
+  // compilation units that were copied to *FOUND.
+  void
+  read_package(Dwp_output_file* output_file, const Dwo_id_set& wanted,
+	       Dwo_id_set* found);
+
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
   // were found.
@@ -144,16 +180,49 @@ class Dwo_file
     { return i1.first < i2.first; }
   };
 
+  // The contents of a section of a .dwp file read by read_package.
+  struct Package_section
+  {
+    const unsigned char* contents;
+    section_size_type len;
+    bool is_new;
+  };
+
+  // Map an input section index, offset and size to the location of
+  // a contribution copied to the output file.
+  typedef std::pair<std::pair<unsigned int, section_offset_type>,
+		    section_size_type> Contribution_key;
+  typedef std::map<Contribution_key, Section_bounds> Contribution_map;
+
+  // A string in the input string table.
+  struct Input_string
+  {
+    // Offset of the string in the input section.
+    section_offset_type offset;
+    // Length of the string, not including the null terminator.
+    size_t length;
+    // The hash code used by the output Stringpool.
+    size_t hash_code;
+  };
+
+  // A less-than comparison routine for Input_string offsets.
+  struct Input_string_compare
+  {
+    bool
+    operator()(const Input_string& i1, const Input_string& i2) const
+    { return i1.offset < i2.offset; }
+  };
+
   // Create a Sized_relobj_dwo of the given size and endianness,
-  // and record the target info.  P is a pointer to the ELF header
-  // in memory.
+  // and save the target info.  If DECOMPRESS is true, decompress the
+  // compressed debug sections now.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object(bool decompress);
 
   template <int size, bool big_endian>
   Relobj*
   sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+		    bool decompress);
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -188,6 +257,11 @@ class Dwo_file
   sized_read_unit_index(unsigned int, unsigned int *, Dwp_output_file*,
 			bool is_tu_index);
 
+  // Return the number of units in the .debug_cu_index or
+  // .debug_tu_index section of a .dwp file.
+  unsigned int
+  unit_index_count(unsigned int);
+
   // Verify the .debug_cu_index section of a .dwp file, comparing it
   // against the list of .dwo files referenced by the corresponding
   // executable file.
@@ -198,27 +272,46 @@ class Dwo_file
   bool
   sized_verify_dwo_list(unsigned int, const File_list& files);
 
+  // Read the input string table section and hash its strings.
+  void
+  read_strings(unsigned int);
+
   // Merge the input string table section into the output file.
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  add_strings(Dwp_output_file*);
 
   // Copy a section from the input file to the output file.
   Section_bounds
   copy_section(Dwp_output_file* output_file, unsigned int shndx,
 	       elfcpp::DW_SECT section_id);
 
+  // Copy one unit's contribution to a section of a .dwp file to the
+  // output file, for read_package.
+  Section_bounds
+  copy_contribution(Dwp_output_file* output_file, unsigned int shndx,
+		    elfcpp::DW_SECT section_id, section_offset_type offset,
+		    section_size_type len);
+
   // Remap the string offsets in the .debug_str_offsets.dwo section.
   const unsigned char*
-  remap_str_offsets(const unsigned char* contents, section_size_type len);
+  remap_str_offsets(Dwp_output_file* output_file,
+		    const unsigned char* contents, section_size_type len);
 
   template <bool big_endian>
   const unsigned char*
-  sized_remap_str_offsets(const unsigned char* contents, section_size_type len);
+  sized_remap_str_offsets(Dwp_output_file* output_file,
+			  const unsigned char* contents, section_size_type len);
 
   // Remap a single string offsets from an offset in the input string table
   // to an offset in the output string table.
   unsigned int
-  remap_str_offset(section_offset_type val);
+  remap_str_offset(Dwp_output_file* output_file, section_offset_type val);
+
+  // Add the input string containing offset VAL to the output string
+  // table, if it has not been added yet, for read_package.  Return the
+  // offset of VAL in the output string table.
+  unsigned int
+  add_package_string(Dwp_output_file* output_file, section_offset_type val);
 
   // Add a set of .debug_info.dwo or .debug_types.dwo and related sections
   // to OUTPUT_FILE.
@@ -238,6 +331,37 @@ class Dwo_file
   std::vector<Section_bounds> sect_offsets_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // ELF header parameters.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
+  // The debug sections found by prepare.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  std::vector<unsigned int> debug_types_;
+  unsigned int debug_str_;
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // The strings in the input string table, with their hash codes.
+  std::vector<Input_string> strings_;
+  // The contents of the input string table, and whether they need to
+  // be deleted.
+  const unsigned char* str_contents_;
+  bool str_is_new_;
+  // When called from read_package, the DWO IDs of the compilation
+  // units to copy, and the set to record them in.
+  const Dwo_id_set* wanted_cus_;
+  Dwo_id_set* found_cus_;
+  // Sections of a .dwp file read by read_package, indexed by section
+  // index.
+  std::vector<Package_section> package_sections_;
+  // Contributions already copied by copy_contribution.
+  Contribution_map contribution_map_;
+  // When called from read_package, the offsets in the output string
+  // table of the strings in strings_, or -1 if the string has not been
+  // added.
+  std::vector<section_offset_type> package_str_offsets_;
 };
 
 // An ELF input file.
@@ -254,16 +378,20 @@ class Sized_relobj_dwo : public Sized_relobj<size, big_endian>
   Sized_relobj_dwo(const char* name, Input_file* input_file,
 		   const elfcpp::Ehdr<size, big_endian>& ehdr)
     : Sized_relobj<size, big_endian>(name, input_file),
-      elf_file_(this, ehdr)
+      elf_file_(this, ehdr), decompressed_sections_()
   { }
 
-  ~Sized_relobj_dwo()
-  { }
+  ~Sized_relobj_dwo();
 
   // Setup the section information.
   void
   setup();
 
+  // Decompress the compressed debug sections now, rather than when
+  // their contents are first requested.
+  void
+  decompress_sections();
+
  protected:
   // Return section type.
   unsigned int
@@ -444,8 +572,22 @@ class Sized_relobj_dwo : public Sized_relobj<size, big_endian>
   { gold_unreachable(); }
 
  private:
+  // A section decompressed by decompress_sections.
+  struct Decompressed_section
+  {
+    const unsigned char* contents;
+    section_size_type len;
+  };
+
+  // Decompress section SHNDX.  Set *PLEN to the size.
+  const unsigned char*
+  decompress_section(unsigned int shndx, section_size_type* plen);
+
   // General access to the ELF file.
   elfcpp::Elf_file<size, big_endian, Object> elf_file_;
+  // Sections decompressed by decompress_sections, indexed by section
+  // index, which have not yet been handed out.
+  std::vector<Decompressed_section> decompressed_sections_;
 };
 
 // The output file.
@@ -464,6 +606,9 @@ class Dwp_output_file
   {
     this->section_id_map_.resize(elfcpp::DW_SECT_MAX + 1);
     this->stringpool_.set_no_zero_null();
+    // We hand out string offsets as strings are added, so the offsets
+    // must not be changed by suffix merging.
+    this->stringpool_.set_no_optimize();
   }
 
   // Record the target info from an input file.
@@ -471,9 +616,10 @@ class Dwp_output_file
   record_target_info(const char* name, int machine, int size, bool big_endian,
 		     int osabi, int abiversion);
 
-  // Add a string to the debug strings section.
+  // Add a string to the debug strings section.  HASH_CODE is the
+  // value of string_hash(STR, LEN).
   section_offset_type
-  add_string(const char* str, size_t len);
+  add_string(const char* str, size_t len, size_t hash_code);
 
   // Add a section to the output file, and return the new section offset.
   section_offset_type
@@ -786,6 +932,38 @@ Sized_relobj_dwo<size, big_endian>::setup()
   this->section_offsets().resize(shnum);
 }
 
+// Free any decompressed sections which were never handed out.
+
+template <int size, bool big_endian>
+Sized_relobj_dwo<size, big_endian>::~Sized_relobj_dwo()
+{
+  for (size_t i = 0; i < this->decompressed_sections_.size(); ++i)
+    if (this->decompressed_sections_[i].contents != NULL)
+      delete[] this->decompressed_sections_[i].contents;
+}
+
+// Decompress the compressed debug sections now.  Each one is handed
+// to the first caller of do_decompressed_section_contents.
+
+template <int size, bool big_endian>
+void
+Sized_relobj_dwo<size, big_endian>::decompress_sections()
+{
+  const unsigned int shnum = this->shnum();
+  Decompressed_section empty = { NULL, 0 };
+  this->decompressed_sections_.resize(shnum, empty);
+  for (unsigned int i = 1; i < shnum; ++i)
+    {
+      if (this->do_section_type(i) != elfcpp::SHT_PROGBITS)
+	continue;
+      std::string sect_name = this->do_section_name(i);
+      if (!is_prefix_of(".zdebug_", sect_name.c_str()))
+	continue;
+      Decompressed_section& ds(this->decompressed_sections_[i]);
+      ds.contents = this->decompress_section(i, &ds.len);
+    }
+}
+
 // Return a view of the contents of a section.
 
 template <int size, bool big_endian>
@@ -816,18 +994,40 @@ Sized_relobj_dwo<size, big_endian>::do_decompressed_section_contents(
     section_size_type* plen,
     bool* is_new)
 {
-  section_size_type buffer_size;
-  const unsigned char* buffer = this->do_section_contents(shndx, &buffer_size,
-							  false);
+  if (shndx < this->decompressed_sections_.size()
+      && this->decompressed_sections_[shndx].contents != NULL)
+    {
+      Decompressed_section& ds(this->decompressed_sections_[shndx]);
+      const unsigned char* contents = ds.contents;
+      *plen = ds.len;
+      *is_new = true;
+      ds.contents = NULL;
+      return contents;
+    }
 
   std::string sect_name = this->do_section_name(shndx);
   if (!is_prefix_of(".zdebug_", sect_name.c_str()))
     {
-      *plen = buffer_size;
       *is_new = false;
-      return buffer;
+      return this->do_section_contents(shndx, plen, false);
     }
 
+  *is_new = true;
+  return this->decompress_section(shndx, plen);
+}
+
+// Decompress section SHNDX, and return the new contents.
+
+template <int size, bool big_endian>
+const unsigned char*
+Sized_relobj_dwo<size, big_endian>::decompress_section(
+    unsigned int shndx,
+    section_size_type* plen)
+{
+  section_size_type buffer_size;
+  const unsigned char* buffer = this->do_section_contents(shndx, &buffer_size,
+							  false);
+
   section_size_type uncompressed_size = get_uncompressed_size(buffer,
 							      buffer_size);
   unsigned char* uncompressed_data = new unsigned char[uncompressed_size];
@@ -838,7 +1038,6 @@ Sized_relobj_dwo<size, big_endian>::do_decompressed_section_contents(
     this->error(_("could not decompress section %s"),
 		this->section_name(shndx).c_str());
   *plen = uncompressed_size;
-  *is_new = true;
   return uncompressed_data;
 }
 
@@ -846,6 +1045,11 @@ Sized_relobj_dwo<size, big_endian>::do_decompressed_section_contents(
 
 Dwo_file::~Dwo_file()
 {
+  if (this->str_is_new_)
+    delete[] this->str_contents_;
+  for (size_t i = 0; i < this->package_sections_.size(); ++i)
+    if (this->package_sections_[i].is_new)
+      delete[] this->package_sections_[i].contents;
   if (this->obj_ != NULL)
     delete this->obj_;
   if (this->input_file_ != NULL)
@@ -858,7 +1062,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object(false);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -898,26 +1102,18 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Open the input file, find its debug sections, decompress them, and
+// hash the strings in its string table.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::prepare()
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object(true);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
 
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
-
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
   for (unsigned int i = 1; i < shnum; i++)
@@ -936,45 +1132,73 @@ Dwo_file::read(Dwp_output_file* output_file)
       else
 	continue;
       if (strcmp(suffix, "info.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_INFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LINE] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LINE] = i;
       else if (strcmp(suffix, "loc.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LOC] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACINFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACINFO] = i;
       else if (strcmp(suffix, "macro.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
     }
 
-  // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->read_strings(this->debug_str_);
+}
+
+// Read the input file and send its contents to OUTPUT_FILE.
+
+void
+Dwo_file::read(Dwp_output_file* output_file)
+{
+  if (this->obj_ == NULL)
+    this->prepare();
+
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+
+  // Merge the input string table into the output string table.  When
+  // reading only some of the units of a package, the strings those
+  // units use are added as their string offsets are remapped instead.
+  if (this->wanted_cus_ == NULL)
+    this->add_strings(output_file);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      // A package with no type units has an empty .debug_tu_index
+      // section and no .debug_types.dwo section.
+      if (this->debug_tu_index_ > 0
+	  && (!this->debug_types_.empty()
+	      || this->unit_index_count(this->debug_tu_index_) > 0))
         {
-	  if (debug_types.size() != 1)
+	  if (this->debug_types_.size() != 1)
 	    gold_fatal(_("%s: .dwp file must have exactly one "
 			 ".debug_types.dwo section"), this->name_);
-	  debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx, output_file,
+				true);
 	}
       return;
     }
@@ -984,8 +1208,9 @@ Dwo_file::read(Dwp_output_file* output_file)
     this->add_unit_set(output_file, debug_shndx, false);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
+  for (std::vector<unsigned int>::const_iterator tp =
+	 this->debug_types_.begin();
+       tp != this->debug_types_.end();
        ++tp)
     {
       debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
@@ -993,6 +1218,24 @@ Dwo_file::read(Dwp_output_file* output_file)
     }
 }
 
+// Read a .dwp file produced by an earlier run, and send to OUTPUT_FILE
+// the compilation units whose DWO IDs are in WANTED, and all of the
+// type units.  The type units are all kept because the compilation
+// units we keep may refer to any of them.
+
+void
+Dwo_file::read_package(Dwp_output_file* output_file,
+		       const Dwo_id_set& wanted, Dwo_id_set* found)
+{
+  this->prepare();
+  if (this->debug_cu_index_ == 0)
+    gold_fatal(_("%s: no .debug_cu_index section found"), this->name_);
+  this->wanted_cus_ = &wanted;
+  this->found_cus_ = found;
+  this->package_str_offsets_.resize(this->strings_.size(), -1);
+  this->read(output_file);
+}
+
 // Verify a .dwp file given a list of .dwo files referenced by the
 // corresponding executable file.  Returns true if no problems
 // were found.
@@ -1000,7 +1243,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object(false);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1036,10 +1279,10 @@ Dwo_file::verify(const File_list& files)
 }
 
 // Create a Sized_relobj_dwo of the given size and endianness,
-// and record the target info.
+// and save the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object(bool decompress)
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1060,8 +1303,8 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_fatal(_("%s: not an ELF object file"), this->name_);
   
   // Get the size, endianness, machine, etc. info from the header,
-  // make an appropriately-sized Relobj, and pass the target info
-  // to the output object.
+  // make an appropriately-sized Relobj, and save the target info
+  // for the output object.
   int size;
   bool big_endian;
   std::string error;
@@ -1074,14 +1317,14 @@ Dwo_file::make_object(Dwp_output_file* output_file)
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
 	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+						 decompress);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
 	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+						  decompress);
 #else
 	gold_unreachable();
 #endif
@@ -1091,14 +1334,14 @@ Dwo_file::make_object(Dwp_output_file* output_file)
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
 	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+						 decompress);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
 	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+						  decompress);
 #else
 	gold_unreachable();
 #endif
@@ -1107,23 +1350,25 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_unreachable();
 }
 
-// Function template to create a Sized_relobj_dwo and record the target info.
+// Function template to create a Sized_relobj_dwo and save the target info.
 // P is a pointer to the ELF header in memory.
 
 template <int size, bool big_endian>
 Relobj*
 Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+			    bool decompress)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+  if (decompress)
+    obj->decompress_sections();
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->abiversion_ = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   return obj;
 }
 
@@ -1142,6 +1387,44 @@ Dwo_file::read_unit_index(unsigned int shndx, unsigned int *debug_shndx,
 				       is_tu_index);
 }
 
+// Return the number of units in the .debug_cu_index or .debug_tu_index
+// section SHNDX of a .dwp file.
+
+unsigned int
+Dwo_file::unit_index_count(unsigned int shndx)
+{
+  section_size_type index_len;
+  bool index_is_new;
+  const unsigned char* contents =
+      this->section_contents(shndx, &index_len, &index_is_new);
+
+  if (index_len < 3 * sizeof(uint32_t))
+    gold_fatal(_("%s: section %s is corrupt"), this->name_,
+	       this->section_name(shndx).c_str());
+
+  unsigned int ncols;
+  unsigned int nused;
+  if (this->obj_->is_big_endian())
+    {
+      ncols = elfcpp::Swap_unaligned<32, true>::readval(contents
+							+ sizeof(uint32_t));
+      nused = elfcpp::Swap_unaligned<32, true>::readval(contents
+							+ 2 * sizeof(uint32_t));
+    }
+  else
+    {
+      ncols = elfcpp::Swap_unaligned<32, false>::readval(contents
+							 + sizeof(uint32_t));
+      nused = elfcpp::Swap_unaligned<32, false>::readval(contents
+							 + 2 * sizeof(uint32_t));
+    }
+
+  if (index_is_new)
+    delete[] contents;
+
+  return ncols == 0 ? 0 : nused;
+}
+
 template <bool big_endian>
 void
 Dwo_file::sized_read_unit_index(unsigned int shndx,
@@ -1196,12 +1479,17 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 	       this->section_name(shndx).c_str());
 
   // Copy the related sections and track the section offsets and sizes.
+  // When reading only some of the units, we copy each unit's
+  // contributions separately instead.
   Section_bounds sections[elfcpp::DW_SECT_MAX + 1];
-  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+  if (this->wanted_cus_ == NULL)
     {
-      if (debug_shndx[i] > 0)
-	sections[i] = this->copy_section(output_file, debug_shndx[i],
-					 static_cast<elfcpp::DW_SECT>(i));
+      for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+	{
+	  if (debug_shndx[i] > 0)
+	    sections[i] = this->copy_section(output_file, debug_shndx[i],
+					     static_cast<elfcpp::DW_SECT>(i));
+	}
     }
 
   // Get the contents of the .debug_info.dwo or .debug_types.dwo section.
@@ -1217,7 +1505,20 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
           elfcpp::Swap_unaligned<64, big_endian>::readval(phash);
       unsigned int index =
 	  elfcpp::Swap_unaligned<32, big_endian>::readval(pindex);
-      if (index != 0 && (!is_tu_index || !output_file->lookup_tu(signature)))
+      bool wanted;
+      if (index == 0)
+	wanted = false;
+      else if (is_tu_index)
+	wanted = !output_file->lookup_tu(signature);
+      else if (this->wanted_cus_ == NULL)
+	wanted = true;
+      else
+	{
+	  wanted = this->wanted_cus_->find(signature) != this->wanted_cus_->end();
+	  if (wanted)
+	    this->found_cus_->insert(signature);
+	}
+      if (wanted)
 	{
 	  Unit_set* unit_set = new Unit_set();
 	  unit_set->signature = signature;
@@ -1229,16 +1530,26 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 
 	  // Adjust the offset of each contribution within the input section
 	  // by the offset of the input section within the output section.
-	  for (unsigned int j = 0; j <= ncols; j++)
+	  for (unsigned int j = 0; j < ncols; j++)
 	    {
 	      unsigned int dw_sect =
-		  elfcpp::Swap_unaligned<64, big_endian>::readval(pch);
+		  elfcpp::Swap_unaligned<32, big_endian>::readval(pch);
 	      unsigned int offset =
-		  elfcpp::Swap_unaligned<64, big_endian>::readval(porow);
+		  elfcpp::Swap_unaligned<32, big_endian>::readval(porow);
 	      unsigned int size =
-		  elfcpp::Swap_unaligned<64, big_endian>::readval(psrow);
-	      unit_set->sections[dw_sect].offset = (sections[dw_sect].offset
-						    + offset);
+		  elfcpp::Swap_unaligned<32, big_endian>::readval(psrow);
+	      if (dw_sect < elfcpp::DW_SECT_INFO
+		  || dw_sect > elfcpp::DW_SECT_MAX)
+		gold_fatal(_("%s: section %s is corrupt"), this->name_,
+			   this->section_name(shndx).c_str());
+	      if (this->wanted_cus_ == NULL || dw_sect == info_sect)
+		unit_set->sections[dw_sect].offset = (sections[dw_sect].offset
+						      + offset);
+	      else
+		unit_set->sections[dw_sect] =
+		    this->copy_contribution(output_file, debug_shndx[dw_sect],
+					    static_cast<elfcpp::DW_SECT>(dw_sect),
+					    offset, size);
 	      unit_set->sections[dw_sect].size = size;
 	      pch += sizeof(uint32_t);
 	      porow += sizeof(uint32_t);
@@ -1373,16 +1684,19 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
   return nmissing == 0;
 }
 
-// Merge the input string table section into the output file.
+// Read the input string table section, and compute the hash code of
+// each string for the output string table.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::read_strings(unsigned int debug_str)
 {
   section_size_type len;
   bool is_new;
   const unsigned char* pdata = this->section_contents(debug_str, &len, &is_new);
   const char* p = reinterpret_cast<const char*>(pdata);
   const char* pend = p + len;
+  this->str_contents_ = pdata;
+  this->str_is_new_ = is_new;
 
   // Check that the last string is null terminated.
   if (pend[-1] != '\0')
@@ -1391,28 +1705,52 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
 	       this->name_,
 	       this->section_name(debug_str).c_str());
 
-  // Count the number of strings in the section, and size the map.
+  // Count the number of strings in the section, and size the lists.
   size_t count = 0;
   for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
     ++count;
+  this->strings_.reserve(count);
   this->str_offset_map_.reserve(count + 1);
 
-  // Add the strings to the output string table, and record the new offsets
-  // in the map.
   section_offset_type i = 0;
-  section_offset_type new_offset;
   while (p < pend)
     {
       size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
-      this->str_offset_map_.push_back(std::make_pair(i, new_offset));
+      Input_string str = { i, len, Stringpool::string_hash(p, len) };
+      this->strings_.push_back(str);
       p += len + 1;
       i += len + 1;
     }
+}
+
+// Merge the input string table section into the output file.
+
+void
+Dwo_file::add_strings(Dwp_output_file* output_file)
+{
+  const char* p = reinterpret_cast<const char*>(this->str_contents_);
+
+  // Add the strings to the output string table, and record the new offsets
+  // in the map.
+  section_offset_type end = 0;
+  section_offset_type new_offset;
+  for (std::vector<Input_string>::const_iterator s = this->strings_.begin();
+       s != this->strings_.end();
+       ++s)
+    {
+      new_offset = output_file->add_string(p + s->offset, s->length,
+					   s->hash_code);
+      this->str_offset_map_.push_back(std::make_pair(s->offset, new_offset));
+      end = s->offset + s->length + 1;
+    }
   new_offset = 0;
-  this->str_offset_map_.push_back(std::make_pair(i, new_offset));
-  if (is_new)
-    delete[] pdata;
+  this->str_offset_map_.push_back(std::make_pair(end, new_offset));
+
+  this->strings_.clear();
+  if (this->str_is_new_)
+    delete[] this->str_contents_;
+  this->str_contents_ = NULL;
+  this->str_is_new_ = false;
 }
 
 // Copy a section from the input file to the output file.
@@ -1439,7 +1777,8 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
 
   if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
     {
-      const unsigned char* remapped = this->remap_str_offsets(contents, len);
+      const unsigned char* remapped = this->remap_str_offsets(output_file,
+							      contents, len);
       if (is_new)
 	delete[] contents;
       contents = remapped;
@@ -1463,9 +1802,64 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   return bounds;
 }
 
+// Copy one unit's contribution to a section of a .dwp file to the
+// output file.  SHNDX is the input section, and OFFSET and LEN give
+// the contribution within it.  A contribution shared by several
+// units, such as the abbreviations for a compilation unit and its type
+// units, is only copied once.  Return the location of the copy in the
+// output section.
+
+Section_bounds
+Dwo_file::copy_contribution(Dwp_output_file* output_file, unsigned int shndx,
+			    elfcpp::DW_SECT section_id,
+			    section_offset_type offset, section_size_type len)
+{
+  if (shndx == 0)
+    gold_fatal(_("%s: missing section %s"), this->name_,
+	       get_dwarf_section_name(section_id));
+
+  Contribution_key key(std::make_pair(shndx, offset), len);
+  Contribution_map::const_iterator p = this->contribution_map_.find(key);
+  if (p != this->contribution_map_.end())
+    return p->second;
+
+  if (this->package_sections_.empty())
+    {
+      Package_section empty = { NULL, 0, false };
+      this->package_sections_.resize(this->shnum(), empty);
+    }
+  Package_section& ps(this->package_sections_[shndx]);
+  if (ps.contents == NULL)
+    ps.contents = this->section_contents(shndx, &ps.len, &ps.is_new);
+
+  if (offset < 0 || static_cast<section_size_type>(offset) > ps.len
+      || len > ps.len - offset)
+    gold_fatal(_("%s: contribution to section %s is out of range"),
+	       this->name_, this->section_name(shndx).c_str());
+
+  // The output file takes ownership of the copy.
+  const unsigned char* contents;
+  if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
+    contents = this->remap_str_offsets(output_file, ps.contents + offset,
+				       len);
+  else
+    {
+      unsigned char* copy = new unsigned char[len];
+      memcpy(copy, ps.contents + offset, len);
+      contents = copy;
+    }
+  section_offset_type off = output_file->add_contribution(section_id, contents,
+							  len, 1);
+
+  Section_bounds bounds(off, len);
+  this->contribution_map_[key] = bounds;
+  return bounds;
+}
+
 // Remap the 
 const unsigned char*
-Dwo_file::remap_str_offsets(const unsigned char* contents,
+Dwo_file::remap_str_offsets(Dwp_output_file* output_file,
+			    const unsigned char* contents,
 			    section_size_type len)
 {
   if ((len & 3) != 0)
@@ -1473,14 +1867,15 @@ Dwo_file::remap_str_offsets(const unsigned char* contents,
 	       this->name_);
 
   if (this->obj_->is_big_endian())
-    return this->sized_remap_str_offsets<true>(contents, len);
+    return this->sized_remap_str_offsets<true>(output_file, contents, len);
   else
-    return this->sized_remap_str_offsets<false>(contents, len);
+    return this->sized_remap_str_offsets<false>(output_file, contents, len);
 }
 
 template <bool big_endian>
 const unsigned char*
-Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
+Dwo_file::sized_remap_str_offsets(Dwp_output_file* output_file,
+				  const unsigned char* contents,
 				  section_size_type len)
 {
   unsigned char* remapped = new unsigned char[len];
@@ -1489,7 +1884,7 @@ Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
   while (len > 0)
     {
       unsigned int val = elfcpp::Swap_unaligned<32, big_endian>::readval(p);
-      val = this->remap_str_offset(val);
+      val = this->remap_str_offset(output_file, val);
       elfcpp::Swap_unaligned<32, big_endian>::writeval(q, val);
       len -= 4;
       p += 4;
@@ -1499,8 +1894,12 @@ Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
 }
 
 unsigned int
-Dwo_file::remap_str_offset(section_offset_type val)
+Dwo_file::remap_str_offset(Dwp_output_file* output_file,
+			   section_offset_type val)
 {
+  if (this->wanted_cus_ != NULL)
+    return this->add_package_string(output_file, val);
+
   Str_offset_map_entry entry;
   entry.first = val;
 
@@ -1520,6 +1919,36 @@ Dwo_file::remap_str_offset(section_offset_type val)
   return p->second + (val - p->first);
 }
 
+// Add the input string containing offset VAL to the output string
+// table, for read_package.  Only the strings used by the units we
+// keep are added, so the strings of dropped units are not copied.
+
+unsigned int
+Dwo_file::add_package_string(Dwp_output_file* output_file,
+			     section_offset_type val)
+{
+  Input_string key = { val, 0, 0 };
+  std::vector<Input_string>::const_iterator p =
+      std::upper_bound(this->strings_.begin(), this->strings_.end(), key,
+		       Input_string_compare());
+  if (p == this->strings_.begin())
+    return 0;
+  --p;
+  if (static_cast<size_t>(val - p->offset) > p->length)
+    gold_fatal(_("%s: string offset %u is out of range"), this->name_,
+	       static_cast<unsigned int>(val));
+
+  section_offset_type* new_offset =
+      &this->package_str_offsets_[p - this->strings_.begin()];
+  if (*new_offset == -1)
+    {
+      const char* str = reinterpret_cast<const char*>(this->str_contents_);
+      *new_offset = output_file->add_string(str + p->offset, p->length,
+					    p->hash_code);
+    }
+  return *new_offset + (val - p->offset);
+}
+
 // Add a set of .debug_info.dwo or .debug_types.dwo and related sections
 // to OUTPUT_FILE.
 
@@ -1595,10 +2024,10 @@ Dwp_output_file::record_target_info(const char*, int machine,
 // Add a string to the debug strings section.
 
 section_offset_type
-Dwp_output_file::add_string(const char* str, size_t len)
+Dwp_output_file::add_string(const char* str, size_t len, size_t hash_code)
 {
   Stringpool::Key key;
-  this->stringpool_.add_with_length(str, len, true, &key);
+  this->stringpool_.add_prehashed(str, len, hash_code, true, &key);
   this->have_strings_ = true;
   // We aren't supposed to call get_offset() until after
   // calling set_string_offsets(), but the offsets will
@@ -2297,21 +2726,191 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
   this->output_file_->add_tu_set(unit_set);
 }
 
+// Class Dwo_read_task.
+
+// A task to prepare a .dwo file: open it, decompress its debug
+// sections and hash its strings.  These tasks may run in parallel.
+
+class Dwo_read_task : public Task
+{
+ public:
+  Dwo_read_task(Dwo_file* dwo_file, Task_token* add_blocker)
+    : dwo_file_(dwo_file), add_blocker_(add_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->prepare(); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock ADD_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->add_blocker_); }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_read_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Task_token* add_blocker_;
+};
+
+// Class Dwo_add_task.
+
+// A task to add a prepared .dwo file to the output file.  Each one is
+// blocked by the task which prepares its file and by the Dwo_add_task
+// for the previous file, so they run one at a time in the order of
+// the input files, and the output file does not depend on the number
+// of threads.  When it is done, it queues NEXT_READ_, the task to
+// prepare a later file, so that only a limited number of prepared
+// files are held in memory at once.
+
+class Dwo_add_task : public Task
+{
+ public:
+  Dwo_add_task(Dwo_file* dwo_file, Dwp_output_file* output_file,
+	       bool verbose, Task_token* this_blocker,
+	       Task_token* next_blocker, Dwo_read_task* next_read)
+    : dwo_file_(dwo_file), output_file_(output_file), verbose_(verbose),
+      this_blocker_(this_blocker), next_blocker_(next_blocker),
+      next_read_(next_read)
+  { }
+
+  ~Dwo_add_task()
+  { delete this->this_blocker_; }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    if (this->verbose_)
+      fprintf(stderr, "%s\n", this->dwo_file_->name());
+    this->dwo_file_->read(this->output_file_);
+    delete this->dwo_file_;
+    this->dwo_file_ = NULL;
+    if (this->next_read_ != NULL)
+      workqueue->queue(this->next_read_);
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  // Unblock NEXT_BLOCKER_, if any, when done.
+  void
+  locks(Task_locker* tl)
+  {
+    if (this->next_blocker_ != NULL)
+      tl->add(this, this->next_blocker_);
+  }
+
+  std::string
+  get_name() const
+  { return "Dwo_add_task"; }
+
+ private:
+  Dwo_file* dwo_file_;
+  Dwp_output_file* output_file_;
+  bool verbose_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+  Dwo_read_task* next_read_;
+};
+
+// Add the files in FILES to OUTPUT_FILE, using WORKQUEUE.  The files
+// are read and decompressed in parallel, up to READ_AHEAD files at a
+// time, and added to the output file in order.
+
+static void
+add_dwo_files(Workqueue* workqueue, const File_list& files,
+	      Dwp_output_file* output_file, bool verbose,
+	      unsigned int read_ahead)
+{
+  const General_options& options(parameters->options());
+
+  size_t count = files.size();
+  int thread_count = 1;
+  if (!options.threads())
+    read_ahead = 1;
+  else
+    {
+      thread_count = options.thread_count();
+      if (thread_count == 0)
+	thread_count = std::min(count, static_cast<size_t>(read_ahead));
+      if (thread_count == 0)
+	thread_count = 1;
+      if (read_ahead < static_cast<unsigned int>(thread_count))
+	read_ahead = thread_count;
+    }
+  workqueue->set_thread_count(thread_count);
+
+  // Each Dwo_add_task is blocked by the Dwo_read_task for its file,
+  // and by the Dwo_add_task for the previous file.  Set up all the
+  // blockers before queuing any tasks.
+  std::vector<Task_token*> blockers(count);
+  std::vector<Dwo_file*> dwo_files(count);
+  std::vector<Dwo_read_task*> read_tasks(count);
+  for (size_t i = 0; i < count; ++i)
+    {
+      blockers[i] = new Task_token(true);
+      blockers[i]->add_blocker();
+      if (i > 0)
+	blockers[i]->add_blocker();
+      dwo_files[i] = new Dwo_file(files[i].dwo_name.c_str());
+      read_tasks[i] = new Dwo_read_task(dwo_files[i], blockers[i]);
+    }
+
+  for (size_t i = 0; i < count; ++i)
+    {
+      Task_token* next_blocker = i + 1 < count ? blockers[i + 1] : NULL;
+      Dwo_read_task* next_read = (i + read_ahead < count
+				  ? read_tasks[i + read_ahead]
+				  : NULL);
+      workqueue->queue(new Dwo_add_task(dwo_files[i], output_file, verbose,
+				       blockers[i], next_blocker, next_read));
+      if (i < read_ahead)
+	workqueue->queue(read_tasks[i]);
+    }
+
+  workqueue->process(0);
+}
+
 }; // End namespace gold
 
 using namespace gold;
 
+// The number of input files which may be read ahead of the one being
+// added to the output file, when using threads.
+
+static const unsigned int dwp_read_ahead = 16;
+
 // Options.
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS = 0x102,
+  NO_THREADS = 0x103,
+  THREAD_COUNT = 0x104,
+  UPDATE = 0x105,
 };
 
 struct option dwp_options[] =
   {
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
+    { "no-threads", no_argument, NULL, NO_THREADS },
     { "output", required_argument, NULL, 'o' },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
+    { "threads", no_argument, NULL, THREADS },
+    { "update", no_argument, NULL, UPDATE },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2328,6 +2927,14 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads                Read input files in parallel\n"));
+  fprintf(fd, _("  --no-threads             Read input files one at a time"
+					   " (default)\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use\n"));
+  fprintf(fd, _("  --update                 Update an existing output file,"
+					   " reading only new\n"
+		"                           or changed dwo files"
+					   " (requires --exec)\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2391,6 +2998,9 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool update = false;
+  bool threads = false;
+  int thread_count = 0;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2410,6 +3020,18 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    threads = true;
+	    break;
+	  case NO_THREADS:
+	    threads = false;
+	    break;
+	  case THREAD_COUNT:
+	    options::parse_uint("thread-count", optarg, &thread_count);
+	    break;
+	  case UPDATE:
+	    update = true;
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2418,6 +3040,8 @@ main(int argc, char** argv)
 	}
     }
 
+  options.set_thread_options(threads, thread_count);
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2449,16 +3073,71 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-  // Process each file, adding its contents to the output file.
-  Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+  if (update && exe_filename == NULL)
+    gold_fatal(_("--update requires --exec"));
+
+  // When updating an existing output file, we write a new file next
+  // to it and rename it when we are done.
+  bool have_package = false;
+  std::string new_filename(output_filename);
+  if (update)
     {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+      struct stat s;
+      if (::stat(output_filename.c_str(), &s) == 0)
+	{
+	  have_package = true;
+	  new_filename.append(".tmp");
+	}
+    }
+
+  // If we fail, gold_exit removes the file we were writing.
+  options.set_output_file_name(new_filename.c_str());
+
+  Dwp_output_file output_file(new_filename.c_str());
+
+  // Copy the units which are still referenced by the executable from
+  // the existing output file.  Since the DWO ID is computed from the
+  // contents of a unit, a .dwo file which has changed will have a new
+  // DWO ID, and will not be found.  We only need to read the .dwo
+  // files whose units were not found.  The units copied from the
+  // existing file come first in the output, followed by the units of
+  // the .dwo files we read, in the order they are listed.  A full
+  // repackage writes all of the units in the order the files are
+  // listed, so an updated package is not byte for byte the same as
+  // one built from scratch.  It has the same compilation units, but
+  // keeps type units that are no longer used.
+  if (have_package)
+    {
+      Dwo_id_set wanted;
+      for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+	if (f->dwo_id != 0)
+	  wanted.insert(f->dwo_id);
+
+      Dwo_id_set found;
+      {
+	if (verbose)
+	  fprintf(stderr, "%s\n", output_filename.c_str());
+	Dwo_file package(output_filename.c_str());
+	package.read_package(&output_file, wanted, &found);
+      }
+
+      File_list remaining;
+      for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+	if (f->dwo_id == 0 || found.find(f->dwo_id) == found.end())
+	  remaining.push_back(*f);
+      files.swap(remaining);
     }
+
+  // Process each file, adding its contents to the output file.
+  Workqueue workqueue(options);
+  add_dwo_files(&workqueue, files, &output_file, verbose, dwp_read_ahead);
   output_file.finalize();
 
-  return EXIT_SUCCESS;
+  if (have_package
+      && ::rename(new_filename.c_str(), output_filename.c_str()) < 0)
+    gold_fatal(_("%s: %s"), output_filename.c_str(), strerror(errno));
+
+  // The Workqueue threads may still be waiting for work, so exit
+  // without destroying the Workqueue, as the linker does.
+  gold_exit(GOLD_OK);
 }
@@ -47,6 +47,7 @@
 #include "target.h"
 #include "binary.h"
 #include "descriptors.h"
+#include "hash.h"
 #include "gold-threads.h"
 #include "fileread.h"
 
@@ -115,6 +116,80 @@ get_mtime(const char* filename, Timespec* mtime)
   return true;
 }
 
+// Get a hash of the contents of an unopened file.
+
+bool
+get_content_hash(const char* filename, uint64_t* hash)
+{
+  File_contents contents;
+  if (!contents.open(filename))
+    return false;
+  *hash = content_hash(contents.data(), contents.size());
+  return true;
+}
+
+// Class File_contents.
+
+File_contents::~File_contents()
+{
+  if (this->mapped_)
+    ::munmap(const_cast<unsigned char*>(this->data_), this->size_);
+  else
+    delete[] this->data_;
+}
+
+// Map FILENAME into memory if we can, otherwise read it.  Return
+// false if it can not be read.
+
+bool
+File_contents::open(const char* filename)
+{
+  gold_assert(this->data_ == NULL);
+
+  int o = open_descriptor(-1, filename, O_RDONLY);
+  if (o < 0)
+    return false;
+
+  struct stat file_stat;
+  if (::fstat(o, &file_stat) < 0)
+    {
+      release_descriptor(o, true);
+      return false;
+    }
+  size_t size = file_stat.st_size;
+
+  if (size > 0)
+    {
+      void* p = ::mmap(NULL, size, PROT_READ, MAP_PRIVATE, o, 0);
+      if (p != MAP_FAILED)
+	{
+	  this->data_ = static_cast<const unsigned char*>(p);
+	  this->mapped_ = true;
+	}
+      else
+	{
+	  unsigned char* buf = new unsigned char[size];
+	  size_t got = 0;
+	  while (got < size)
+	    {
+	      ssize_t len = ::read(o, buf + got, size - got);
+	      if (len <= 0)
+		{
+		  delete[] buf;
+		  release_descriptor(o, true);
+		  return false;
+		}
+	      got += len;
+	    }
+	  this->data_ = buf;
+	}
+    }
+  this->size_ = size;
+
+  release_descriptor(o, true);
+  return true;
+}
+
 // Class File_read.
 
 // A lock for the File_read static variables.
@@ -126,6 +201,16 @@ unsigned long long File_read::total_mapped_bytes;
 unsigned long long File_read::current_mapped_bytes;
 unsigned long long File_read::maximum_mapped_bytes;
 
+// Return whether we need to count the bytes mapped for input files.
+
+static inline bool
+count_mapped_bytes()
+{
+  return (!parameters->options_valid()
+	  || parameters->options().stats()
+	  || parameters->options().mapped_input_budget() != 0);
+}
+
 // Class File_read::View.
 
 File_read::View::~View()
@@ -139,7 +224,7 @@ File_read::View::~View()
     case DATA_MMAPPED:
       if (::munmap(const_cast<unsigned char*>(this->data_), this->size_) != 0)
 	gold_warning(_("munmap failed: %s"), strerror(errno));
-      if (!parameters->options_valid() || parameters->options().stats())
+      if (count_mapped_bytes())
 	{
 	  file_counts_initialize_lock.initialize();
 	  Hold_optional_lock hl(file_counts_lock);
@@ -260,7 +345,7 @@ File_read::release()
 {
   gold_assert(this->is_locked());
 
-  if (!parameters->options_valid() || parameters->options().stats())
+  if (count_mapped_bytes())
     {
       file_counts_initialize_lock.initialize();
       Hold_optional_lock hl(file_counts_lock);
@@ -274,10 +359,15 @@ File_read::release()
 
   // Only clear views if there is only one attached object.  Otherwise
   // we waste time trying to clear cached archive views.  Similarly
-  // for releasing the descriptor.
+  // for releasing the descriptor.  If we are over
+  // --mapped-input-budget, clear the cached views too; they will be
+  // mapped again if they are needed.
   if (this->object_count_ <= 1)
     {
-      this->clear_views(CLEAR_VIEWS_NORMAL);
+      if (File_read::over_mapped_input_budget())
+	this->clear_views(CLEAR_VIEWS_BUDGET);
+      else
+	this->clear_views(CLEAR_VIEWS_NORMAL);
       if (this->is_descriptor_opened_)
 	{
 	  release_descriptor(this->descriptor_, false);
@@ -790,8 +880,13 @@ File_read::clear_view_cache_marks()
 void
 File_read::clear_views(Clear_views_mode mode)
 {
+  // --mapped-input-budget only overrides the default for
+  // --keep-files-mapped, not an explicit option.
   bool keep_files_mapped = (parameters->options_valid()
-			    && parameters->options().keep_files_mapped());
+			    && parameters->options().keep_files_mapped()
+			    && (mode != CLEAR_VIEWS_BUDGET
+				|| (parameters->options()
+				    .user_set_keep_files_mapped())));
   Views::iterator p = this->views_.begin();
   while (p != this->views_.end())
     {
@@ -857,6 +952,26 @@ File_read::print_stats()
 	  program_name, File_read::maximum_mapped_bytes);
 }
 
+// Return whether the bytes currently mapped for input files exceed
+// --mapped-input-budget, which is given in megabytes.  This only
+// counts the views of input files, not the memory which gold
+// allocates for the link.
+
+bool
+File_read::over_mapped_input_budget()
+{
+  if (!parameters->options_valid())
+    return false;
+  const unsigned long long budget =
+    parameters->options().mapped_input_budget();
+  if (budget == 0)
+    return false;
+
+  file_counts_initialize_lock.initialize();
+  Hold_optional_lock hl(file_counts_lock);
+  return File_read::current_mapped_bytes > budget * 1024 * 1024;
+}
+
 // Class File_view.
 
 File_view::~File_view()
@@ -58,6 +58,53 @@ struct Timespec
 bool
 get_mtime(const char* filename, Timespec* mtime);
 
+// Get a hash of the contents of an unopened file.  Returns false if
+// the file can not be read.
+
+bool
+get_content_hash(const char* filename, uint64_t* hash);
+
+// The whole contents of an unopened file, mapped into memory if
+// possible.  This is used to look at input files outside of the
+// normal task structure, where a File_read can not be locked.
+
+class File_contents
+{
+ public:
+  File_contents()
+    : data_(NULL), size_(0), mapped_(false)
+  { }
+
+  ~File_contents();
+
+  // Read the contents of FILENAME.  Returns false if the file can not
+  // be read.
+  bool
+  open(const char* filename);
+
+  // Return the contents.
+  const unsigned char*
+  data() const
+  { return this->data_; }
+
+  // Return the size of the file.
+  size_t
+  size() const
+  { return this->size_; }
+
+ private:
+  // This class may not be copied.
+  File_contents(const File_contents&);
+  File_contents& operator=(const File_contents&);
+
+  // The contents of the file.
+  const unsigned char* data_;
+  // The size of the file.
+  size_t size_;
+  // Whether DATA_ was mapped rather than allocated.
+  bool mapped_;
+};
+
 class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
@@ -117,6 +164,11 @@ class File_read
   bool
   is_locked() const;
 
+  // Test whether the object is locked by task T.
+  bool
+  is_locked_by(const Task* t) const
+  { return this->token_.is_writer(t); }
+
   // Return the token, so that the task can be queued.
   Task_token*
   token()
@@ -207,6 +259,11 @@ class File_read
   static void
   print_stats();
 
+  // Return whether the bytes currently mapped for input files exceed
+  // --mapped-input-budget.
+  static bool
+  over_mapped_input_budget();
+
   // Return the open file descriptor (for plugins).
   int
   descriptor()
@@ -228,6 +285,10 @@ class File_read
     CLEAR_VIEWS_NORMAL,
     // Clear all uncached views (including in an archive).
     CLEAR_VIEWS_ARCHIVE,
+    // Clear all uncached views, and the cached views too unless the
+    // user asked for --keep-files-mapped, because we are over
+    // --mapped-input-budget.
+    CLEAR_VIEWS_BUDGET,
     // Clear all views (i.e., we're destroying the file).
     CLEAR_VIEWS_ALL
   };
@@ -240,7 +301,7 @@ class File_read
   static unsigned long long total_mapped_bytes;
 
   // Current number of bytes mapped into memory during the link if
-  // --stats.
+  // --stats or --mapped-input-budget.
   static unsigned long long current_mapped_bytes;
 
   // High water mark of bytes mapped into memory during the link if
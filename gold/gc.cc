@@ -30,42 +30,56 @@ namespace gold
 {
 
 // Garbage collection uses a worklist style algorithm to determine the 
-// transitive closure of all referenced sections.
+// transitive closure of all referenced sections.  The references are
+// first put in compressed sparse row form, so that the references
+// from a section are contiguous, and the referenced sections are
+// recorded in a bitmap.
+
 void 
 Garbage_collection::do_transitive_closure()
 {
+  // Start with the sections on the work list.
+  std::vector<unsigned int> worklist;
   while (!this->worklist().empty())
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
       Section_id entry = this->worklist().front();
       this->worklist().pop();
-      if (this->referenced_list().find(entry)
-          == this->referenced_list().end()) 
-        {
-          this->referenced_list().insert(entry);
-        }
-      else
-        {
-          continue;
-        }
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      Garbage_collection::Sections_reachable v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::iterator it_v = v.begin();
-           it_v != v.end();
-           ++it_v)
-        {
-          // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push(*it_v);   
-            }
-        }
+      worklist.push_back(this->section_index(entry.first, entry.second));
+    }
+
+  // REF_BEGIN[I] is the index in REF_TARGETS of the first section
+  // referenced by section I.
+  unsigned int section_count = this->section_count_;
+  std::vector<unsigned int> ref_begin(section_count + 1, 0);
+  for (std::vector<Reference>::const_iterator p = this->references_.begin();
+       p != this->references_.end();
+       ++p)
+    ++ref_begin[p->first + 1];
+  for (unsigned int i = 0; i < section_count; ++i)
+    ref_begin[i + 1] += ref_begin[i];
+
+  std::vector<unsigned int> ref_targets(this->references_.size());
+  std::vector<unsigned int> ref_next(ref_begin.begin(), ref_begin.end() - 1);
+  for (std::vector<Reference>::const_iterator p = this->references_.begin();
+       p != this->references_.end();
+       ++p)
+    ref_targets[ref_next[p->first]++] = p->second;
+  std::vector<unsigned int>().swap(ref_next);
+  std::vector<Reference>().swap(this->references_);
+
+  this->referenced_.assign(section_count, false);
+  while (!worklist.empty())
+    {
+      unsigned int entry = worklist.back();
+      worklist.pop_back();
+      if (this->referenced_[entry])
+        continue;
+      this->referenced_[entry] = true;
+      // Scan the references for each work list entry.  Do not add
+      // already processed sections to the work list.
+      for (unsigned int i = ref_begin[entry]; i < ref_begin[entry + 1]; ++i)
+        if (!this->referenced_[ref_targets[i]])
+          worklist.push_back(ref_targets[i]);
     }
   this->worklist_ready();
 }
@@ -51,7 +51,6 @@ class Garbage_collection
  public:
 
   typedef Unordered_set<Section_id, Section_id_hash> Sections_reachable;
-  typedef std::map<Section_id, Sections_reachable> Section_ref;
   typedef std::queue<Section_id> Worklist_type;
   // This maps the name of the section which can be represented as a C
   // identifier (cident) to the list of sections that have that name.
@@ -59,19 +58,13 @@ class Garbage_collection
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
 
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : work_list_(), is_worklist_ready_(false), section_index_base_(),
+    section_count_(0), last_object_(NULL), last_index_base_(0),
+    references_(), referenced_(), cident_sections_()
   { }
 
   // Accessor methods for the private members.
 
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
-
-  Section_ref&
-  section_reloc_map()
-  { return this->section_reloc_map_; }
-
   Worklist_type&
   worklist()
   { return this->work_list_; }
@@ -89,8 +82,15 @@ class Garbage_collection
 
   bool
   is_section_garbage(Object* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  {
+    Section_index_base::const_iterator p =
+      this->section_index_base_.find(obj);
+    if (p == this->section_index_base_.end())
+      return true;
+    unsigned int index = p->second + shndx;
+    return (index >= this->referenced_.size()
+	    || !this->referenced_[index]);
+  }
 
   Cident_section_map*
   cident_sections()
@@ -107,21 +107,55 @@ class Garbage_collection
   add_reference(Object* src_object, unsigned int src_shndx,
 		Object* dst_object, unsigned int dst_shndx)
   {
-    Section_id src_id(src_object, src_shndx);
-    Section_id dst_id(dst_object, dst_shndx);
-    Section_ref::iterator p = this->section_reloc_map_.find(src_id);
-    if (p == this->section_reloc_map_.end())
-      this->section_reloc_map_[src_id].insert(dst_id);
-    else
-      p->second.insert(dst_id);
+    Reference ref(this->section_index(src_object, src_shndx),
+		  this->section_index(dst_object, dst_shndx));
+    // Relocs in a section often refer to the same section repeatedly.
+    if (this->references_.empty() || this->references_.back() != ref)
+      this->references_.push_back(ref);
   }
 
  private:
 
+  // Each section is given a dense index.  The sections of an object
+  // have consecutive indexes starting at a base index for the object.
+  typedef Unordered_map<const Object*, unsigned int> Section_index_base;
+  // A reference from one section index to another.
+  typedef std::pair<unsigned int, unsigned int> Reference;
+
+  // Return the index of the SHNDX-th section of OBJECT.
+  unsigned int
+  section_index(const Object* object, unsigned int shndx)
+  {
+    if (object != this->last_object_)
+      {
+	std::pair<Section_index_base::iterator, bool> ins =
+	  this->section_index_base_.insert(std::make_pair(object,
+							  this->section_count_));
+	if (ins.second)
+	  this->section_count_ += object->shnum();
+	this->last_object_ = object;
+	this->last_index_base_ = ins.first->second;
+      }
+    gold_assert(shndx < object->shnum());
+    return this->last_index_base_ + shndx;
+  }
+
   Worklist_type work_list_;
   bool is_worklist_ready_;
-  Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
+  // The base index of the sections of each object.
+  Section_index_base section_index_base_;
+  // The number of section indexes assigned.
+  unsigned int section_count_;
+  // The object most recently looked up in section_index_base_, and
+  // its base index.
+  const Object* last_object_;
+  unsigned int last_index_base_;
+  // The references between sections, in the order they were found.
+  // This is cleared by do_transitive_closure.
+  std::vector<Reference> references_;
+  // A bitmap of the referenced sections, indexed by section index.
+  // This is set by do_transitive_closure.
+  std::vector<bool> referenced_;
   Cident_section_map cident_sections_;
 };
 
@@ -200,6 +234,7 @@ gc_process_relocs(
   Icf::Reloc_addend_size_info* reloc_addend_size_vec = NULL;
   bool is_icf_tracked = false;
   const char* cident_section_name = NULL;
+  const char* cident_section_added = NULL;
 
   std::string src_section_name = (parameters->options().icf_enabled()
                                   ? src_obj->section_name(src_indx)
@@ -355,22 +390,23 @@ gc_process_relocs(
 	  parameters->sized_target<size, big_endian>()
 	    ->gc_add_reference(symtab, src_obj, src_indx,
 			       dst_obj, dst_indx, dst_off);
-          if (cident_section_name != NULL)
+          if (cident_section_name != NULL
+	      && cident_section_name != cident_section_added)
             {
+	      // Only add the references for a cident symbol once.
+	      cident_section_added = cident_section_name;
               Garbage_collection::Cident_section_map::iterator ele =
                 symtab->gc()->cident_sections()->find(std::string(cident_section_name));
               if (ele == symtab->gc()->cident_sections()->end())
                 continue;
-	      Section_id src_id(src_obj, src_indx);
-              Garbage_collection::Sections_reachable&
-                v(symtab->gc()->section_reloc_map()[src_id]);
               Garbage_collection::Sections_reachable& cident_secn(ele->second);
               for (Garbage_collection::Sections_reachable::iterator it_v
                      = cident_secn.begin();
                    it_v != cident_secn.end();
                    ++it_v)
                 {
-                  v.insert(*it_v);
+		  symtab->gc()->add_reference(src_obj, src_indx,
+					      it_v->first, it_v->second);
                 }
             }
         }
@@ -27,6 +27,7 @@
 #include "dwarf.h"
 #include "object.h"
 #include "output.h"
+#include "workqueue.h"
 #include "demangle.h"
 
 namespace gold
@@ -171,6 +172,203 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+class Gdb_index_info_reader;
+
+// Statistics gathered while scanning the DWARF info of one object.
+
+struct Gdb_index_scan_stats
+{
+  Gdb_index_scan_stats()
+    : cu_count(0), cu_nopubnames_count(0), tu_count(0), tu_nopubnames_count(0)
+  { }
+
+  // Number of DWARF compilation units processed.
+  unsigned int cu_count;
+  // Number of DWARF compilation units without pubnames/pubtypes.
+  unsigned int cu_nopubnames_count;
+  // Number of DWARF type units processed.
+  unsigned int tu_count;
+  // Number of DWARF type units without pubnames/pubtypes.
+  unsigned int tu_nopubnames_count;
+};
+
+// This class holds the .gdb_index information found in the
+// .debug_info and .debug_types sections of a single object.  CU and
+// TU indexes are local to the object, and each symbol is recorded
+// once, with the list of local CUs that define it.  Gdb_index::merge
+// adds the information to the index in input order, so the scans
+// of different objects may run in parallel.
+
+class Gdb_index_scan
+{
+ public:
+  // If COPY_SYMBOLS is true, the symbols are copied, so that the
+  // sections can be scanned after the caller has freed them.
+  Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+		 off_t symbols_size, bool copy_symbols);
+
+  ~Gdb_index_scan();
+
+  // Return the object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Record a .debug_info or .debug_types section to be scanned by
+  // scan_sections.
+  void
+  add_section(bool is_type_unit, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type)
+  {
+    this->sections_.push_back(Section(is_type_unit, shndx, reloc_shndx,
+				      reloc_type));
+  }
+
+  // Scan the recorded sections.
+  void
+  scan_sections();
+
+  // Add a compilation unit, returning its local index.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(Gdb_index::Comp_unit(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit, returning its local index.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(Gdb_index::Type_unit(tu_offset, type_offset,
+						     signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(unsigned int cu_index, Dwarf_range_list* ranges)
+  {
+    this->ranges_.push_back(Gdb_index::Per_cu_range_list(this->object_,
+							  cu_index, ranges));
+  }
+
+  // Add a symbol.
+  void
+  add_symbol(int cu_index, const char* sym_name);
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUs associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Return the statistics for this object.
+  Gdb_index_scan_stats&
+  stats()
+  { return this->stats_; }
+
+ private:
+  friend class Gdb_index;
+
+  // A section to scan.
+  struct Section
+  {
+    Section(bool is_type, unsigned int sec, unsigned int rsec,
+	    unsigned int rtype)
+      : is_type_unit(is_type), shndx(sec), reloc_shndx(rsec),
+	reloc_type(rtype)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  // A symbol found in this object.  HASHVAL is the .gdb_index hash,
+  // and STRING_HASH the Stringpool hash, of the name, so that they
+  // need not be recomputed while merging.
+  struct Local_symbol
+  {
+    Local_symbol(const char* n, size_t len, size_t shash, unsigned int hash)
+      : name(n), length(len), string_hash(shash), hashval(hash), cu_vector()
+    { }
+    const char* name;
+    size_t length;
+    size_t string_hash;
+    unsigned int hashval;
+    Gdb_index::Cu_vector cu_vector;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Scan the given pubtable and build a map of the various dies it
+  // refers to, so we can process the entries when we encounter the
+  // die.  Return the just-read table so it can be cached.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr, Gdb_index_info_reader* dwinfo);
+
+  // Wrapper for map_pubtable_to_dies.
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo);
+
+  // The object.
+  Relobj* object_;
+  // The symbol table of the object.
+  const unsigned char* symbols_;
+  off_t symbols_size_;
+  // Whether we own SYMBOLS_.
+  bool owns_symbols_;
+  // The sections to scan.
+  std::vector<Section> sections_;
+  // Whether the pubnames and pubtypes sections have been mapped.
+  bool pubnames_mapped_;
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames sections of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // The stmt list offset of the CUs and TUs associated with the last
+  // read pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // The compilation units, type units and address ranges.
+  std::vector<Gdb_index::Comp_unit> comp_units_;
+  std::vector<Gdb_index::Type_unit> type_units_;
+  std::vector<Gdb_index::Per_cu_range_list> ranges_;
+  // The symbol names; a key minus one is an index into SYMBOL_LIST_.
+  Stringpool names_;
+  // The symbols, in the order they were first seen.
+  std::vector<Local_symbol> symbol_list_;
+  // Statistics.
+  Gdb_index_scan_stats stats_;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,15 +381,19 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_scan* scan)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      scan_(scan), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
+  // Add the statistics gathered while scanning one object.
+  static void
+  add_stats(const Gdb_index_scan_stats&);
+
   // Print usage statistics.
   static void
   print_stats();
@@ -285,8 +487,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The object being scanned.
+  Gdb_index_scan* scan_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -321,8 +523,8 @@ void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  ++this->scan_->stats().cu_count;
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +535,10 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
+  ++this->scan_->stats().tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->scan_->add_type_unit(tu_offset, type_offset,
+						     signature);
   this->visit_top_die(root_die);
 }
 
@@ -379,9 +581,9 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 	if (!this->read_pubnames_and_pubtypes(die))
 	  {
 	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
+	      ++this->scan_->stats().cu_nopubnames_count;
 	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	      ++this->scan_->stats().tu_nopubnames_count;
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -436,7 +638,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_, full_name.c_str());
+	      this->scan_->add_symbol(this->cu_index_, full_name.c_str());
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -475,7 +677,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
+		this->scan_->add_symbol(this->cu_index_,
 					     full_name.c_str());
 	    }
 
@@ -823,8 +1025,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->scan_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -849,8 +1050,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->scan_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -874,7 +1074,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name);
+      this->scan_->add_symbol(this->cu_index_, name);
     }
   return true;
 }
@@ -905,8 +1105,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->scan_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -917,10 +1116,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->scan_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->scan_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -928,12 +1127,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->scan_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->scan_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->scan_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->scan_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -953,6 +1152,19 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
+// Add the statistics gathered while scanning one object.
+
+void
+Gdb_index_info_reader::add_stats(const Gdb_index_scan_stats& stats)
+{
+  Gdb_index_info_reader::dwarf_cu_count += stats.cu_count;
+  Gdb_index_info_reader::dwarf_cu_nopubnames_count
+    += stats.cu_nopubnames_count;
+  Gdb_index_info_reader::dwarf_tu_count += stats.tu_count;
+  Gdb_index_info_reader::dwarf_tu_nopubnames_count
+    += stats.tu_nopubnames_count;
+}
+
 // Print usage statistics.
 void
 Gdb_index_info_reader::print_stats()
@@ -967,41 +1179,64 @@ Gdb_index_info_reader::print_stats()
           program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
 }
 
-// Class Gdb_index.
-
-// Construct the .gdb_index section.
+// Class Gdb_index_scan.
 
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+Gdb_index_scan::Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+			       off_t symbols_size, bool copy_symbols)
+  : object_(object), symbols_(symbols), symbols_size_(symbols_size),
+    owns_symbols_(false), sections_(), pubnames_mapped_(false),
+    cu_pubname_map_(), cu_pubtype_map_(), pubnames_table_(NULL),
+    pubtypes_table_(NULL), stmt_list_offset_(-1), comp_units_(),
+    type_units_(), ranges_(), names_(), symbol_list_(), stats_()
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  if (copy_symbols && symbols != NULL)
+    {
+      unsigned char* copy = new unsigned char[symbols_size];
+      memcpy(copy, symbols, symbols_size);
+      this->symbols_ = copy;
+      this->owns_symbols_ = true;
+    }
 }
 
-Gdb_index::~Gdb_index()
+Gdb_index_scan::~Gdb_index_scan()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  if (this->owns_symbols_)
+    delete[] this->symbols_;
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
 }
 
+// Scan the recorded .debug_info and .debug_types sections.
+
+void
+Gdb_index_scan::scan_sections()
+{
+  for (std::vector<Section>::const_iterator p = this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    {
+      Gdb_index_info_reader dwinfo(p->is_type_unit, this->object_,
+				   this->symbols_, this->symbols_size_,
+				   p->shndx, p->reloc_shndx,
+				   p->reloc_type, this);
+      if (!this->pubnames_mapped_)
+	{
+	  this->map_pubnames_and_types_to_dies(&dwinfo);
+	  this->pubnames_mapped_ = true;
+	}
+      dwinfo.parse();
+    }
+  this->sections_.clear();
+
+  // If we copied the symbols, all the sections have been recorded,
+  // and we no longer need them.
+  if (this->owns_symbols_)
+    {
+      delete[] this->symbols_;
+      this->symbols_ = NULL;
+      this->owns_symbols_ = false;
+    }
+}
 
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
@@ -1009,11 +1244,8 @@ Gdb_index::~Gdb_index()
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_scan::map_pubtable_to_dies(unsigned int attr,
+				     Gdb_index_info_reader* dwinfo)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1031,7 +1263,8 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
+  if (!table->read_section(this->object_, this->symbols_,
+			   this->symbols_size_))
     return NULL;
 
   while (table->read_header(section_offset))
@@ -1046,30 +1279,23 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_scan::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
   this->stmt_list_offset_ = -1;
 
   delete this->pubnames_table_;
   this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo);
   delete this->pubtypes_table_;
   this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_scan::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1081,7 +1307,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_scan::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1089,7 +1315,74 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
   return -1;
 }
 
-// Scan a .debug_info or .debug_types input section.
+// Add a symbol.  We compute both hash values here, which may be in a
+// separate thread, rather than in Gdb_index::merge.
+
+void
+Gdb_index_scan::add_symbol(int cu_index, const char* sym_name)
+{
+  size_t length = strlen(sym_name);
+  size_t string_hash = Stringpool::string_hash(sym_name, length);
+  Stringpool::Key key;
+  const char* name = this->names_.add_prehashed(sym_name, length,
+						string_hash, true, &key);
+  if (key > this->symbol_list_.size())
+    {
+      gold_assert(key == this->symbol_list_.size() + 1);
+      unsigned int hash = mapped_index_string_hash(
+	  reinterpret_cast<const unsigned char*>(sym_name));
+      this->symbol_list_.push_back(Local_symbol(name, length, string_hash,
+						 hash));
+    }
+
+  // Add the CU index to the vector list for this symbol,
+  // if it's not already on the list.  We only need to
+  // check the last added entry.
+  Gdb_index::Cu_vector* cu_vec = &this->symbol_list_[key - 1].cu_vector;
+  if (cu_vec->size() == 0 || cu_vec->back() != cu_index)
+    cu_vec->push_back(cu_index);
+}
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    scans_(),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0)
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  for (Scan_list::iterator p = this->scans_.begin();
+       p != this->scans_.end();
+       ++p)
+    delete *p;
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+}
+
+// Scan a .debug_info or .debug_types input section.  When using
+// threads, we only record the section here, and scan it later in a
+// Gdb_index_scan_task.  Otherwise, we scan it right away, and merge
+// the information for each object once we see the next one.
 
 void
 Gdb_index::scan_debug_info(bool is_type_unit,
@@ -1100,68 +1393,156 @@ Gdb_index::scan_debug_info(bool is_type_unit,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
-}
-
-// Add a symbol.
+  bool defer = false;
+#ifdef ENABLE_THREADS
+  defer = parameters->options().threads();
+#endif
 
-void
-Gdb_index::add_symbol(int cu_index, const char* sym_name)
-{
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
-  Gdb_symbol* sym = new Gdb_symbol();
-  this->stringpool_.add(sym_name, true, &sym->name_key);
-  sym->hashval = hash;
-  sym->cu_vector_index = 0;
-
-  Gdb_symbol* found = this->gdb_symtab_->add(sym);
-  if (found == sym)
+  Gdb_index_scan* scan = NULL;
+  if (!this->scans_.empty())
     {
-      // New symbol -- allocate a new CU index vector.
-      found->cu_vector_index = this->cu_vector_list_.size();
-      this->cu_vector_list_.push_back(new Cu_vector());
+      scan = this->scans_.back();
+      if (scan->object() != object)
+	{
+	  if (!defer)
+	    {
+	      this->merge(scan);
+	      this->scans_.pop_back();
+	      delete scan;
+	    }
+	  scan = NULL;
+	}
     }
-  else
+  if (scan == NULL)
     {
-      // Found an existing symbol -- append to the existing
-      // CU index vector.
-      delete sym;
+      scan = new Gdb_index_scan(object, symbols, symbols_size, defer);
+      this->scans_.push_back(scan);
     }
 
-  // Add the CU index to the vector list for this symbol,
-  // if it's not already on the list.  We only need to
-  // check the last added entry.
-  Cu_vector* cu_vec = this->cu_vector_list_[found->cu_vector_index];
-  if (cu_vec->size() == 0 || cu_vec->back() != cu_index)
-    cu_vec->push_back(cu_index);
+  scan->add_section(is_type_unit, shndx, reloc_shndx, reloc_type);
+  if (!defer)
+    scan->scan_sections();
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
+// A task to scan the DWARF info of one object.
 
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
+class Gdb_index_scan_task : public Task
 {
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
+ public:
+  Gdb_index_scan_task(Gdb_index_scan* scan, Task_token* blocker)
+    : scan_(scan), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    Relobj* object = this->scan_->object();
+    if (object->is_locked())
+      return object->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->scan_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->scan_->scan_sections();
+    this->scan_->object()->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->scan_->object()->name(); }
+
+ private:
+  Gdb_index_scan* scan_;
+  Task_token* blocker_;
+};
+
+// Add tasks to scan the objects recorded by scan_debug_info.
+
+void
+Gdb_index::add_scan_tasks(Task_token* blocker, std::vector<Task*>* tasks)
+{
+  for (Scan_list::const_iterator p = this->scans_.begin();
+       p != this->scans_.end();
+       ++p)
+    tasks->push_back(new Gdb_index_scan_task(*p, blocker));
 }
 
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
+// Merge the information collected by SCAN into the index.  We do
+// this in input order, so that the index does not depend on the
+// order in which the objects were scanned.
 
 void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
+Gdb_index::merge(Gdb_index_scan* scan)
 {
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
+  gold_assert(scan->sections_.empty());
+
+  int cu_base = this->comp_units_.size();
+  int tu_base = this->type_units_.size();
+  this->comp_units_.insert(this->comp_units_.end(),
+			   scan->comp_units_.begin(),
+			   scan->comp_units_.end());
+  this->type_units_.insert(this->type_units_.end(),
+			   scan->type_units_.begin(),
+			   scan->type_units_.end());
+
+  for (std::vector<Per_cu_range_list>::const_iterator p
+	 = scan->ranges_.begin();
+       p != scan->ranges_.end();
+       ++p)
+    {
+      Per_cu_range_list r(*p);
+      r.cu_index = Gdb_index::rebase_cu_index(r.cu_index, cu_base, tu_base);
+      this->ranges_.push_back(r);
+    }
+
+  for (std::vector<Gdb_index_scan::Local_symbol>::const_iterator p
+	 = scan->symbol_list_.begin();
+       p != scan->symbol_list_.end();
+       ++p)
+    {
+      Gdb_symbol* sym = new Gdb_symbol();
+      this->stringpool_.add_prehashed(p->name, p->length, p->string_hash,
+				      true, &sym->name_key);
+      sym->hashval = p->hashval;
+      sym->cu_vector_index = 0;
+
+      Gdb_symbol* found = this->gdb_symtab_->add(sym);
+      if (found == sym)
+	{
+	  // New symbol -- allocate a new CU index vector.
+	  found->cu_vector_index = this->cu_vector_list_.size();
+	  this->cu_vector_list_.push_back(new Cu_vector());
+	}
+      else
+	{
+	  // Found an existing symbol -- append to the existing
+	  // CU index vector.
+	  delete sym;
+	}
+
+      // The CU indexes of a later object are always different, so we
+      // need not check for duplicates.
+      Cu_vector* cu_vec = this->cu_vector_list_[found->cu_vector_index];
+      for (Cu_vector::const_iterator q = p->cu_vector.begin();
+	   q != p->cu_vector.end();
+	   ++q)
+	cu_vec->push_back(Gdb_index::rebase_cu_index(*q, cu_base, tu_base));
+    }
+
+  Gdb_index_info_reader::add_stats(scan->stats_);
 }
 
 // Set the size of the .gdb_index section.
@@ -1169,6 +1550,16 @@ Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
 void
 Gdb_index::set_final_data_size()
 {
+  // Merge the information for each object.
+  for (Scan_list::iterator p = this->scans_.begin();
+       p != this->scans_.end();
+       ++p)
+    {
+      this->merge(*p);
+      delete *p;
+    }
+  this->scans_.clear();
+
   // Finalize the string pool.
   this->stringpool_.set_string_offsets();
 
@@ -55,10 +55,15 @@ class Object;
 
 const char* program_name;
 
+static void
+queue_incremental_inputs(Workqueue*, Task*, Incremental_binary*,
+			 Input_objects*, Symbol_table*, Layout*, Dirsearch*,
+			 Mapfile*, Task_token*);
+
 static Task*
-process_incremental_input(Incremental_binary*, unsigned int, Input_objects*,
-			  Symbol_table*, Layout*, Dirsearch*, Mapfile*,
-			  Task_token*, Task_token*);
+process_incremental_input(Incremental_binary*, unsigned int, Task*,
+			  Input_objects*, Symbol_table*, Layout*, Dirsearch*,
+			  Mapfile*, Task_token*, Task_token*);
 
 void
 gold_exit(Exit_status status)
@@ -167,6 +172,95 @@ Gc_runner::run(Workqueue* workqueue, const Task* task)
 			this->mapfile_);
 }
 
+// This class arranges the rest of the middle tasks after the section
+// keys for identical code folding have been computed.
+
+class Icf_runner : public Task_function_runner
+{
+ public:
+  Icf_runner(const General_options& options,
+	     const Input_objects* input_objects,
+	     Symbol_table* symtab,
+	     Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Icf_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->icf()->find_identical_sections(this->symtab_);
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
+// This task queues the tasks for the input files of an incremental
+// update with --incremental-check-hash.  Deciding which members of a
+// changed archive can be kept means reading the new version of the
+// archive, which we do here so that it is locked like any other input
+// file.  The tasks for the input files don't exist until this has
+// run, so the space used by the kept files is still marked before any
+// new input sections are laid out.
+
+class Process_incremental_inputs : public Task
+{
+ public:
+  // The task for the last input file will unblock NEXT_BLOCKER.
+  Process_incremental_inputs(Incremental_binary* ibase,
+			     Input_objects* input_objects,
+			     Symbol_table* symtab, Layout* layout,
+			     Dirsearch* search_path, Mapfile* mapfile,
+			     Task_token* next_blocker)
+    : ibase_(ibase), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), search_path_(search_path), mapfile_(mapfile),
+      next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    queue_incremental_inputs(workqueue, this, this->ibase_,
+			     this->input_objects_, this->symtab_,
+			     this->layout_, this->search_path_, this->mapfile_,
+			     this->next_blocker_);
+  }
+
+  std::string
+  get_name() const
+  { return "Process_incremental_inputs"; }
+
+ private:
+  Incremental_binary* ibase_;
+  Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Dirsearch* search_path_;
+  Mapfile* mapfile_;
+  Task_token* next_blocker_;
+};
+
 // Queue up the initial set of tasks for this link job.
 
 void
@@ -247,27 +341,21 @@ queue_initial_tasks(const General_options& options,
     }
   else
     {
-      // Incremental update link.  Process the list of input files
-      // stored in the base file, and queue a task for each file:
-      // a Read_symbols task for a changed file, and an Add_symbols task
-      // for an unchanged file.  We need to mark all the space used by
-      // unchanged files before we can start any tasks running.
-      unsigned int input_file_count = ibase->input_file_count();
-      std::vector<Task*> tasks;
-      tasks.reserve(input_file_count);
-      for (unsigned int i = 0; i < input_file_count; ++i)
-	{
-	  Task_token* next_blocker = new Task_token(true);
-	  next_blocker->add_blocker();
-	  Task* t = process_incremental_input(ibase, i, input_objects, symtab,
-					      layout, &search_path, mapfile,
-					      this_blocker, next_blocker);
-	  tasks.push_back(t);
-	  this_blocker = next_blocker;
-	}
-      // Now we can queue the tasks.
-      for (unsigned int i = 0; i < tasks.size(); i++)
-	workqueue->queue(tasks[i]);
+      // Incremental update link.  With --incremental-check-hash we
+      // may need to read changed archives, so we queue the tasks for
+      // the input files from a task.
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      if (options.incremental_check_hash())
+	workqueue->queue(new Process_incremental_inputs(ibase, input_objects,
+							symtab, layout,
+							&search_path, mapfile,
+							next_blocker));
+      else
+	queue_incremental_inputs(workqueue, NULL, ibase, input_objects,
+				 symtab, layout, &search_path, mapfile,
+				 next_blocker);
+      this_blocker = next_blocker;
     }
 
   if (options.has_plugins())
@@ -306,15 +394,56 @@ queue_initial_tasks(const General_options& options,
     }
 }
 
+// Process the list of input files stored in the base file of an
+// incremental update link, and queue a task for each file: a
+// Read_symbols task for a changed file, and an Add_symbols task for an
+// unchanged file.  We need to mark all the space used by unchanged
+// files before we can start any tasks running.  TASK is the task
+// running this, or NULL.  The task for the last file unblocks
+// NEXT_BLOCKER.
+
+static void
+queue_incremental_inputs(Workqueue* workqueue, Task* task,
+			 Incremental_binary* ibase,
+			 Input_objects* input_objects, Symbol_table* symtab,
+			 Layout* layout, Dirsearch* search_path,
+			 Mapfile* mapfile, Task_token* next_blocker)
+{
+  unsigned int input_file_count = ibase->input_file_count();
+  gold_assert(input_file_count > 0);
+  std::vector<Task*> tasks;
+  tasks.reserve(input_file_count);
+  Task_token* this_blocker = NULL;
+  for (unsigned int i = 0; i < input_file_count; ++i)
+    {
+      Task_token* blocker = next_blocker;
+      if (i + 1 < input_file_count)
+	{
+	  blocker = new Task_token(true);
+	  blocker->add_blocker();
+	}
+      Task* t = process_incremental_input(ibase, i, task, input_objects,
+					  symtab, layout, search_path,
+					  mapfile, this_blocker, blocker);
+      tasks.push_back(t);
+      this_blocker = blocker;
+    }
+  // Now we can queue the tasks.
+  for (unsigned int i = 0; i < tasks.size(); i++)
+    workqueue->queue(tasks[i]);
+}
+
 // Process an incremental input file: if it is unchanged from the previous
 // link, return a task to add its symbols from the base file's incremental
 // info; if it has changed, return a normal Read_symbols task.  We create a
 // task for every input file, if only to report the file for rebuilding the
-// incremental info.
+// incremental info.  TASK is used to read a changed archive, as for
+// queue_incremental_inputs.
 
 static Task*
 process_incremental_input(Incremental_binary* ibase,
 			  unsigned int input_file_index,
+			  Task* task,
 			  Input_objects* input_objects,
 			  Symbol_table* symtab,
 			  Layout* layout,
@@ -369,6 +498,10 @@ process_incremental_input(Incremental_binary* ibase,
       else
 	{
 	  // Queue a Read_symbols task to process the archive normally.
+	  // Any unchanged members kept from the previous link have
+	  // already been recorded against LIB; the new archive will
+	  // take them over instead of reading them again.
+	  layout->incremental_inputs()->report_changed_archive(lib);
 	  return new Read_symbols(input_objects, symtab, layout, search_path,
 				  0, mapfile, input_argument, NULL, NULL,
 				  this_blocker, next_blocker);
@@ -383,7 +516,12 @@ process_incremental_input(Incremental_binary* ibase,
       // Process members of a --start-lib/--end-lib group as normal objects.
       if (lib->filename() != "/group/")
 	{
-	  if (ibase->file_has_changed(lib->input_file_index()))
+	  // If the archive has changed, check whether this member is
+	  // still present with the same contents.
+	  Incremental_member_info info;
+	  if (ibase->file_has_changed(lib->input_file_index())
+	      && ibase->member_has_changed(task, search_path,
+					   input_file_index, &info))
 	    {
 	      return new Read_member(input_objects, symtab, layout, mapfile,
 				     input_reader, this_blocker, next_blocker);
@@ -393,11 +531,14 @@ process_incremental_input(Incremental_binary* ibase,
 	      // The previous contributions from this file will be kept.
 	      // Mark the pieces of output sections contributed by this
 	      // object.
+	      if (!ibase->file_has_changed(lib->input_file_index()))
+		ibase->get_member_info(input_file_index, &info);
 	      ibase->reserve_layout(input_file_index);
 	      Object* obj = make_sized_incremental_object(ibase,
 							  input_file_index,
 							  input_type,
 							  input_reader);
+	      lib->set_member_info(obj, info);
 	      return new Add_symbols(input_objects, symtab, layout,
 				     search_path, 0, mapfile, input_argument,
 				     obj, lib, NULL, this_blocker,
@@ -520,12 +661,40 @@ queue_middle_tasks(const General_options& options,
 
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  The keys of the
+  // sections are computed by tasks which run in parallel, and
+  // Icf_runner continues when they are done.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      Task_token* icf_blocker = new Task_token(true);
+      symtab->icf()->queue_section_key_tasks(input_objects, symtab,
+					     workqueue, icf_blocker);
+      workqueue->queue(new Task_function(new Icf_runner(options,
+							input_objects,
+							symtab,
+							layout,
+							mapfile),
+					 icf_blocker,
+					 "Task_function Icf_runner"));
+      return;
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks, after identical code
+// folding.
+
+void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -697,17 +866,49 @@ queue_middle_tasks(const General_options& options,
 
   Task_token* this_blocker = NULL;
 
+  // With threads, read the strings of merged string sections, scan
+  // the DWARF info for the .gdb_index section, and read the line
+  // numbers for --detect-odr-violations, in parallel.  This can
+  // overlap with reading the relocations, but we use the same blocker
+  // as for allocating common symbols, so that the Scan_relocs tasks,
+  // and so the Layout_task_runner, wait for it.  We add all the
+  // blockers before queuing any of the tasks.
+  std::vector<Task*> merge_tasks;
+#ifdef ENABLE_THREADS
+  if (parameters->options().threads())
+    {
+      this_blocker = new Task_token(true);
+      layout->add_merge_tasks(this_blocker, &merge_tasks);
+      layout->add_gdb_index_tasks(this_blocker, &merge_tasks);
+      if (parameters->options().detect_odr_violations())
+	symtab->add_odr_tasks(this_blocker, &merge_tasks);
+      if (merge_tasks.empty())
+	{
+	  delete this_blocker;
+	  this_blocker = NULL;
+	}
+      else
+	this_blocker->add_blockers(merge_tasks.size());
+    }
+#endif
+
   // Allocate common symbols.  We use a blocker to run this before the
   // Scan_relocs tasks, because it writes to the symbol table just as
   // they do.
   if (parameters->options().define_common())
     {
-      this_blocker = new Task_token(true);
+      if (this_blocker == NULL)
+	this_blocker = new Task_token(true);
       this_blocker->add_blocker();
       workqueue->queue(new Allocate_commons_task(symtab, layout, mapfile,
 						 this_blocker));
     }
 
+  for (std::vector<Task*>::const_iterator p = merge_tasks.begin();
+       p != merge_tasks.end();
+       ++p)
+    workqueue->queue(*p);
+
   // If doing garbage collection, the relocations have already been read.
   // Otherwise, read and scan the relocations.
   if (parameters->options().gc_sections()
@@ -781,6 +982,11 @@ queue_middle_tasks(const General_options& options,
 				     "Task_function Layout_task_runner"));
 }
 
+// When using threads, the largest number of global symbols written
+// out by a single Write_symbols_task.
+
+static const size_t symbols_per_write_task = 50000;
+
 // Queue up the final set of tasks.  This is called at the end of
 // Layout_task.
 
@@ -817,23 +1023,52 @@ queue_final_tasks(const General_options& options,
   Task_token* output_sections_blocker = new Task_token(true);
   output_sections_blocker->add_blocker();
 
+  // When using threads, split the global symbols into ranges which
+  // are written out in parallel.
+  size_t symbol_count = symtab->output_symbols_count();
+  size_t symbols_per_task = symbol_count;
+#ifdef ENABLE_THREADS
+  if (parameters->options().threads())
+    symbols_per_task = std::min(symbols_per_task, symbols_per_write_task);
+#endif
+  size_t write_symbols_task_count = 1;
+  if (symbols_per_task > 0)
+    write_symbols_task_count = ((symbol_count + symbols_per_task - 1)
+				/ symbols_per_task);
+
   // Use a blocker to block the final cleanup task.
   Task_token* final_blocker = new Task_token(true);
-  // Write_symbols_task, Write_sections_task, Write_data_task,
+  // Write_symbols_tasks, Write_sections_task, Write_data_task,
   // Relocate_tasks.
-  final_blocker->add_blockers(3);
+  final_blocker->add_blockers(write_symbols_task_count + 2);
   final_blocker->add_blockers(input_objects->number_of_relobjs());
   if (!any_postprocessing_sections)
     final_blocker->add_blocker();
 
-  // Queue a task to write out the symbol table.
-  workqueue->queue(new Write_symbols_task(layout,
-					  symtab,
-					  input_objects,
-					  layout->sympool(),
-					  layout->dynpool(),
-					  of,
-					  final_blocker));
+  // If the file size is final, set up any tree-style build ID
+  // computation now, so that each chunk is hashed as soon as it has
+  // been written.  This must be done before queuing the tasks which
+  // write the file.
+  Task_token* close_blocker = NULL;
+  if (!any_postprocessing_sections)
+    close_blocker = layout->queue_build_id_tasks(workqueue, final_blocker,
+						 input_objects, of);
+
+  // Queue tasks to write out the symbol table.
+  for (size_t i = 0; i < write_symbols_task_count; ++i)
+    {
+      size_t first = i * symbols_per_task;
+      size_t last = std::min(first + symbols_per_task, symbol_count);
+      workqueue->queue(new Write_symbols_task(layout,
+					      symtab,
+					      input_objects,
+					      layout->sympool(),
+					      layout->dynpool(),
+					      of,
+					      first,
+					      last,
+					      final_blocker));
+    }
 
   // Queue a task to write out the output sections.
   workqueue->queue(new Write_sections_task(layout, of, output_sections_blocker,
@@ -865,6 +1100,9 @@ queue_final_tasks(const General_options& options,
     }
   else
     {
+      // Compress any debug sections in parallel first.
+      final_blocker = layout->queue_compress_tasks(workqueue, final_blocker);
+
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
       Task* t = new Write_after_input_sections_task(layout, of,
@@ -872,16 +1110,19 @@ queue_final_tasks(const General_options& options,
 						    new_final_blocker);
       workqueue->queue(t);
       final_blocker = new_final_blocker;
-    }
 
-  // Create tasks for tree-style build ID computation, if necessary.
-  final_blocker = layout->queue_build_id_tasks(workqueue, final_blocker, of);
+      // Create tasks for tree-style build ID computation, if
+      // necessary.  They wait until Write_after_input_sections_task
+      // has set the final file size.
+      close_blocker = layout->queue_build_id_tasks(workqueue, final_blocker,
+						   NULL, of);
+    }
 
   // Queue a task to close the output file.  This will be blocked by
-  // FINAL_BLOCKER.
+  // CLOSE_BLOCKER.
   workqueue->queue(new Task_function(new Close_task_runner(&options, layout,
 							   of),
-				     final_blocker,
+				     close_blocker,
 				     "Task_function Close_task_runner"));
 }
 
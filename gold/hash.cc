@@ -0,0 +1,141 @@
+// hash.cc -- fast non-cryptographic hash for gold
+
+// Copyright 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <algorithm>
+
+#include "elfcpp_swap.h"
+#include "hash.h"
+
+namespace gold
+{
+
+// The hash used by --build-id=fast.  This is MurmurHash3_x64_128, by
+// Austin Appleby, which is in the public domain, with a seed of zero.
+// It is a well studied non-cryptographic hash which passes the
+// SMHasher tests, and is much faster than MD5 or SHA-1.  A build ID
+// only needs to tell different outputs apart; it need not resist an
+// attacker.  Input words are read as little-endian, and the result is
+// written as two little-endian words, so that the hash does not depend
+// on the host.  On a little-endian host the result is the same as the
+// reference implementation for inputs of less than 2GB.
+
+static const uint64_t fast_hash_c1 = 0x87c37b91114253d5ULL;
+static const uint64_t fast_hash_c2 = 0x4cf5ad432745937fULL;
+
+static inline uint64_t
+fast_hash_rotl(uint64_t x, int r)
+{ return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t
+fast_hash_fmix(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+// Compute the --build-id=fast hash of the SIZE bytes at SRC, and
+// store its fast_hash_size bytes at DST.
+
+void
+fast_hash_buffer(const unsigned char* src, size_t size, unsigned char* dst)
+{
+  const unsigned char* p = src;
+  const unsigned char* const end = src + (size & ~static_cast<size_t>(15));
+
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  for (; p < end; p += 16)
+    {
+      uint64_t k1 = elfcpp::Swap_unaligned<64, false>::readval(p);
+      uint64_t k2 = elfcpp::Swap_unaligned<64, false>::readval(p + 8);
+
+      k1 *= fast_hash_c1;
+      k1 = fast_hash_rotl(k1, 31);
+      k1 *= fast_hash_c2;
+      h1 ^= k1;
+      h1 = fast_hash_rotl(h1, 27);
+      h1 += h2;
+      h1 = h1 * 5 + 0x52dce729;
+
+      k2 *= fast_hash_c2;
+      k2 = fast_hash_rotl(k2, 33);
+      k2 *= fast_hash_c1;
+      h2 ^= k2;
+      h2 = fast_hash_rotl(h2, 31);
+      h2 += h1;
+      h2 = h2 * 5 + 0x38495ab5;
+    }
+
+  // The last 0 to 15 bytes.
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  size_t tail = size & 15;
+  for (size_t i = tail; i > 8; --i)
+    k2 |= static_cast<uint64_t>(p[i - 1]) << ((i - 9) * 8);
+  for (size_t i = std::min(tail, static_cast<size_t>(8)); i > 0; --i)
+    k1 |= static_cast<uint64_t>(p[i - 1]) << ((i - 1) * 8);
+  if (tail > 8)
+    {
+      k2 *= fast_hash_c2;
+      k2 = fast_hash_rotl(k2, 33);
+      k2 *= fast_hash_c1;
+      h2 ^= k2;
+    }
+  if (tail > 0)
+    {
+      k1 *= fast_hash_c1;
+      k1 = fast_hash_rotl(k1, 31);
+      k1 *= fast_hash_c2;
+      h1 ^= k1;
+    }
+
+  h1 ^= static_cast<uint64_t>(size);
+  h2 ^= static_cast<uint64_t>(size);
+  h1 += h2;
+  h2 += h1;
+  h1 = fast_hash_fmix(h1);
+  h2 = fast_hash_fmix(h2);
+  h1 += h2;
+  h2 += h1;
+
+  elfcpp::Swap_unaligned<64, false>::writeval(dst, h1);
+  elfcpp::Swap_unaligned<64, false>::writeval(dst + 8, h2);
+}
+
+// Return a 64-bit hash of the SIZE bytes at CONTENTS.
+
+uint64_t
+content_hash(const unsigned char* contents, size_t size)
+{
+  static const unsigned char empty = 0;
+  unsigned char digest[fast_hash_size];
+  fast_hash_buffer(size == 0 ? &empty : contents, size, digest);
+  uint64_t hash = elfcpp::Swap_unaligned<64, false>::readval(digest);
+  return hash == 0 ? 1 : hash;
+}
+
+} // End namespace gold.
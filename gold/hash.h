@@ -0,0 +1,48 @@
+// hash.h -- fast non-cryptographic hash for gold   -*- C++ -*-
+
+// Copyright 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_HASH_H
+#define GOLD_HASH_H
+
+namespace gold
+{
+
+// The size in bytes of the hash computed by fast_hash_buffer.
+const size_t fast_hash_size = 128 / 8;
+
+// Compute the hash used by --build-id=fast of the SIZE bytes at SRC,
+// and store its fast_hash_size bytes at DST.
+
+extern void
+fast_hash_buffer(const unsigned char* src, size_t size, unsigned char* dst);
+
+// Return a 64-bit hash of the SIZE bytes at CONTENTS, made from the
+// first half of the fast_hash_buffer hash.  This is used to tell
+// whether the contents of an incremental link input have changed.  It
+// is never zero, so that zero can be used to mean that no hash was
+// recorded.
+
+extern uint64_t
+content_hash(const unsigned char* contents, size_t size);
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_HASH_H)
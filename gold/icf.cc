@@ -33,6 +33,12 @@
 // Checksum collisions are handled by using a multimap and explicitly
 // checking the contents when two sections have the same checksum.
 //
+// The contents of a section and its relocations to sections which
+// cannot be folded do not change between iterations, so they are
+// hashed only once, in parallel for different objects.  Each iteration
+// combines that hash with the sections that the targets of the other
+// relocations are currently folded into.
+//
 // However, two functions A and B with identical text but with
 // relocations pointing to different foldable sections can be identical if
 // the corresponding foldable sections to which their relocations point to
@@ -140,6 +146,7 @@
 
 #include "gold.h"
 #include "object.h"
+#include "workqueue.h"
 #include "gc.h"
 #include "icf.h"
 #include "symtab.h"
@@ -151,56 +158,75 @@
 namespace gold
 {
 
+// This is the multiplier used by icf_hash.
+
+static const uint64_t icf_hash_multiplier = 0xc6a4a7935bd1e995ULL;
+
+// Mix the value K into the hash code H.
+
+static inline uint64_t
+icf_hash_mix(uint64_t h, uint64_t k)
+{
+  k *= icf_hash_multiplier;
+  k ^= k >> 47;
+  k *= icf_hash_multiplier;
+  h ^= k;
+  h *= icf_hash_multiplier;
+  return h;
+}
+
+// Compute a 64-bit hash code of the LEN bytes at P, continuing from
+// the hash code H.  This reads eight bytes at a time, which is much
+// faster than a CRC on large sections.
+
+static uint64_t
+icf_hash(const unsigned char* p, size_t len, uint64_t h)
+{
+  h = icf_hash_mix(h, len);
+  while (len >= 8)
+    {
+      uint64_t k;
+      memcpy(&k, p, 8);
+      h = icf_hash_mix(h, k);
+      p += 8;
+      len -= 8;
+    }
+  if (len > 0)
+    {
+      uint64_t k = 0;
+      memcpy(&k, p, len);
+      h = icf_hash_mix(h, k);
+    }
+  h ^= h >> 47;
+  h *= icf_hash_multiplier;
+  h ^= h >> 47;
+  return h;
+}
+
 // This function determines if a section or a group of identical
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
+// SECTION_KEYS : Vector mapping a section index to its key.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+preprocess_for_unique_sections(const std::vector<Icf::Section_key>&
+                                 section_keys,
+                               std::vector<bool>* is_secn_or_group_unique)
 {
-  Unordered_map<uint32_t, unsigned int> uniq_map;
-  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
+  Unordered_map<uint64_t, unsigned int> uniq_map;
+  std::pair<Unordered_map<uint64_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_keys.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
+      uniq_map_insert = uniq_map.insert(std::make_pair(section_keys[i].hash,
+                                                       i));
       if (uniq_map_insert.second)
         {
           (*is_secn_or_group_unique)[i] = true;
@@ -213,48 +239,35 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// This computes the part of the key of a section which does not
+// change between iterations.  Relocs are differentiated as those
+// pointing to sections that could be folded and those that cannot.
+// Relocs pointing to sections that cannot be folded are added to the
+// contents of the key.  The numbers of the sections pointed to by the
+// other relocs are recorded, and the sections they are folded into
+// are compared on each iteration.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
-// SECN               : Section for which contents are desired.
-// SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
-
-static std::string
-get_section_contents(bool first_iteration,
-                     const Section_id& secn,
-                     unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
-                     Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
-{
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
-
-  section_size_type plen;
-  const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+// SECN      : Section for which the key is desired.
+// CONTENTS  : The contents of SECN, which is locked.
+// PLEN      : The length of CONTENTS.
+// CAN_DEFER : If true, this may be running in parallel for different
+//             objects.  Return false without computing the key if that
+//             would require reading the contents of another object.
+// KEY       : Where to store the key.
 
-  // The buffer to hold all the contents including relocs.  A checksum
-  // is then computed on this buffer.
-  std::string buffer;
-  std::string icf_reloc_buffer;
-
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
+static bool
+get_section_key(const Section_id& secn,
+                const unsigned char* contents,
+                section_size_type plen,
+                Symbol_table* symtab,
+                bool can_defer,
+                Icf::Section_key* key)
+{
+  // The buffer to hold the relocs.  A hash code is then computed on
+  // this buffer and the section contents.
+  std::string& buffer(key->contents);
+  buffer.clear();
+  key->icf_relocs.clear();
 
   Icf::Reloc_info_list& reloc_info_list = 
     symtab->icf()->reloc_info_list();
@@ -262,154 +275,134 @@ get_section_contents(bool first_iteration,
   Icf::Reloc_info_list::iterator it_reloc_info_list =
     reloc_info_list.find(secn);
 
-  buffer.clear();
-  icf_reloc_buffer.clear();
-
   // Process relocs and put them into the buffer.
 
   if (it_reloc_info_list != reloc_info_list.end())
     {
-      Icf::Sections_reachable_info v =
-        (it_reloc_info_list->second).section_info;
-      // Stores the information of the symbol pointed to by the reloc.
-      Icf::Symbol_info s = (it_reloc_info_list->second).symbol_info;
-      // Stores the addend and the symbol value.
-      Icf::Addend_info a = (it_reloc_info_list->second).addend_info;
-      // Stores the offset of the reloc.
-      Icf::Offset_info o = (it_reloc_info_list->second).offset_info;
-      Icf::Reloc_addend_size_info reloc_addend_size_info =
-        (it_reloc_info_list->second).reloc_addend_size_info;
-      Icf::Sections_reachable_info::iterator it_v = v.begin();
-      Icf::Symbol_info::iterator it_s = s.begin();
-      Icf::Addend_info::iterator it_a = a.begin();
-      Icf::Offset_info::iterator it_o = o.begin();
-      Icf::Reloc_addend_size_info::iterator it_addend_size =
-        reloc_addend_size_info.begin();
-
-      for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size)
+      const Icf::Reloc_info& reloc_info(it_reloc_info_list->second);
+      size_t reloc_count = reloc_info.section_info.size();
+
+      for (size_t i = 0; i < reloc_count; ++i)
         {
-	  if (first_iteration
-	      && it_v->first != NULL)
+          Section_id reloc_secn = reloc_info.section_info[i];
+          // Stores the information of the symbol pointed to by the reloc.
+          Symbol* sym = reloc_info.symbol_info[i];
+          // Stores the addend and the symbol value.
+          std::pair<long long, long long> addend = reloc_info.addend_info[i];
+          // Stores the offset of the reloc.
+          uint64_t reloc_offset = reloc_info.offset_info[i];
+          unsigned int reloc_addend_size =
+            reloc_info.reloc_addend_size_info[i];
+
+	  if (reloc_secn.first != NULL)
 	    {
 	      Symbol_location loc;
-	      loc.object = it_v->first;
-	      loc.shndx = it_v->second;
-	      loc.offset = convert_types<off_t, long long>(it_a->first
-							   + it_a->second);
+	      loc.object = reloc_secn.first;
+	      loc.shndx = reloc_secn.second;
+	      loc.offset = convert_types<off_t, long long>(addend.first
+							   + addend.second);
 	      // Look through function descriptors
 	      parameters->target().function_location(&loc);
-	      if (loc.shndx != it_v->second)
+	      if (loc.shndx != reloc_secn.second)
 		{
-		  it_v->second = loc.shndx;
+		  reloc_secn.second = loc.shndx;
 		  // Modify symvalue/addend to the code entry.
-		  it_a->first = loc.offset;
-		  it_a->second = 0;
+		  addend.first = loc.offset;
+		  addend.second = 0;
 		}
 	    }
 
           // ADDEND_STR stores the symbol value and addend and offset,
-          // each at most 16 hex digits long.  it_a points to a pair
-          // where first is the symbol value and second is the
-          // addend.
+          // each at most 16 hex digits long.  ADDEND is a pair where
+          // first is the symbol value and second is the addend.
           char addend_str[50];
 
 	  // It would be nice if we could use format macros in inttypes.h
 	  // here but there are not in ISO/IEC C++ 1998.
           snprintf(addend_str, sizeof(addend_str), "%llx %llx %llux",
-                   static_cast<long long>((*it_a).first),
-		   static_cast<long long>((*it_a).second),
-		   static_cast<unsigned long long>(*it_o));
+                   static_cast<long long>(addend.first),
+		   static_cast<long long>(addend.second),
+		   static_cast<unsigned long long>(reloc_offset));
 
 	  // If the symbol pointed to by the reloc is not in an ordinary
 	  // section or if the symbol type is not FROM_OBJECT, then the
 	  // object is NULL.
-	  if (it_v->first == NULL)
+	  if (reloc_secn.first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if ((*it_s) != NULL)
-                      buffer.append((*it_s)->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+	      // If the symbol name is available, use it.
+	      if (sym != NULL)
+		buffer.append(sym->name());
+	      // Append the addend.
+	      buffer.append(addend_str);
+	      buffer.append("@");
 	      continue;
 	    }
 
-          Section_id reloc_secn(it_v->first, it_v->second);
-
           // If this reloc turns back and points to the same section,
           // like a recursive call, use a special symbol to mark this.
           if (reloc_secn.first == secn.first
               && reloc_secn.second == secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+              buffer.append("R");
+              buffer.append(addend_str);
+              buffer.append("@");
               continue;
             }
           Icf::Uniq_secn_id_map& section_id_map =
             symtab->icf()->section_to_int_map();
           Icf::Uniq_secn_id_map::iterator section_id_map_it =
             section_id_map.find(reloc_secn);
-          bool is_sym_preemptible = (*it_s != NULL
-				     && !(*it_s)->is_from_dynobj()
-				     && !(*it_s)->is_undefined()
-				     && (*it_s)->is_preemptible());
+          bool is_sym_preemptible = (sym != NULL
+				     && !sym->is_from_dynobj()
+				     && !sym->is_undefined()
+				     && sym->is_preemptible());
           if (!is_sym_preemptible
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+              // The section it is folded into is compared on each
+              // iteration.
+              key->icf_relocs.push_back(section_id_map_it->second);
+              buffer.append("ICF_R");
+              buffer.append(addend_str);
             }
           else
             {
               // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
-              uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
+              // The flags were recorded by find_candidate_sections, so
+              // we don't need to lock the object it is in.
+              uint64_t secn_flags =
+                symtab->icf()->merge_section_flags(reloc_secn);
               // This reloc points to a merge section.  Hash the
               // contents of this section.
-              if ((secn_flags & elfcpp::SHF_MERGE) != 0
-		  && parameters->target().can_icf_inline_merge_sections())
+              if ((secn_flags & elfcpp::SHF_MERGE) != 0)
                 {
+                  // Only the object being processed is locked.  If
+                  // the merge section is in another object, lock it
+                  // too, unless we are running in parallel.
+                  bool lock_reloc_object = reloc_secn.first != secn.first;
+                  if (can_defer && lock_reloc_object)
+                    return false;
+                  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+                  if (lock_reloc_object)
+                    reloc_secn.first->lock(dummy_task);
+
                   uint64_t entsize =
-                    (it_v->first)->section_entsize(it_v->second);
-		  long long offset = it_a->first;
+                    (reloc_secn.first)->section_entsize(reloc_secn.second);
+		  long long offset = addend.first;
 
-                  unsigned long long addend = it_a->second;
+                  unsigned long long reloc_addend = addend.second;
                   // Ignoring the addend when it is a negative value.  See the 
                   // comments in Merged_symbol_value::Value in object.h.
-                  if (addend < 0xffffff00)
-                    offset = offset + addend;
+                  if (reloc_addend < 0xffffff00)
+                    offset = offset + reloc_addend;
 
 		  // For SHT_REL relocation sections, the addend is stored in the
 		  // text section at the relocation offset.
 		  uint64_t reloc_addend_value = 0;
                   const unsigned char* reloc_addend_ptr =
-		    contents + static_cast<unsigned long long>(*it_o);
-		  switch(*it_addend_size)
+		    contents + static_cast<unsigned long long>(reloc_offset);
+		  switch(reloc_addend_size)
 		    {
 		      case 0:
 		        {
@@ -446,9 +439,9 @@ get_section_contents(bool first_iteration,
 
                   section_size_type secn_len;
                   const unsigned char* str_contents =
-                  (it_v->first)->section_contents(it_v->second,
-                                                  &secn_len,
-                                                  false) + offset;
+                  (reloc_secn.first)->section_contents(reloc_secn.second,
+                                                       &secn_len,
+                                                       false) + offset;
                   if ((secn_flags & elfcpp::SHF_STRINGS) != 0)
                     {
                       // String merge section.
@@ -495,11 +488,13 @@ get_section_contents(bool first_iteration,
                                     entsize);
                     }
 		  buffer.append("@");
+                  if (lock_reloc_object)
+                    reloc_secn.first->unlock(dummy_task);
                 }
-              else if ((*it_s) != NULL)
+              else if (sym != NULL)
                 {
                   // If symbol name is available use that.
-                  buffer.append((*it_s)->name());
+                  buffer.append(sym->name());
                   // Append the addend.
                   buffer.append(addend_str);
                   buffer.append("@");
@@ -508,9 +503,9 @@ get_section_contents(bool first_iteration,
                 {
                   // Symbol name is not available, like for a local symbol,
                   // use object and section id.
-                  buffer.append(it_v->first->name());
+                  buffer.append(reloc_secn.first->name());
                   char secn_id[10];
-                  snprintf(secn_id, sizeof(secn_id), "%u",it_v->second);
+                  snprintf(secn_id, sizeof(secn_id), "%u", reloc_secn.second);
                   buffer.append(secn_id);
                   // Append the addend.
                   buffer.append(addend_str);
@@ -520,150 +515,144 @@ get_section_contents(bool first_iteration,
         }
     }
 
-  if (first_iteration)
+  key->hash = icf_hash(contents, plen,
+                       icf_hash(reinterpret_cast<const unsigned char*>(
+                                  buffer.data()),
+                                buffer.size(), 0));
+  return true;
+}
+
+// This appends the contents of each section which is not known to be
+// unique to its key, so that sections with the same hash code can be
+// compared.  The contents do not change between iterations, so this
+// is only done once.
+// Parameters  :
+// ID_SECTION         : Vector mapping a section to an unique integer.
+// IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
+//                            sections is already known to be unique.
+// SECTION_KEYS       : Vector mapping a section index to its key.
+
+static void
+add_section_contents(const std::vector<Section_id>& id_section,
+                     const std::vector<bool>& is_secn_or_group_unique,
+                     std::vector<Icf::Section_key>* section_keys)
+{
+  for (unsigned int i = 0; i < id_section.size(); i++)
     {
+      if (is_secn_or_group_unique[i])
+        continue;
+
+      Section_id secn = id_section[i];
+      // Lock the object so we can read from it.  This is only called
+      // single-threaded from Icf::find_identical_sections, so it is OK
+      // to lock.  Unfortunately we have no way to pass in a Task token.
+      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+      Task_lock_obj<Object> tl(dummy_task, secn.first);
+
+      section_size_type plen;
+      const unsigned char* contents = secn.first->section_contents(secn.second,
+                                                                   &plen,
+                                                                   false);
+      std::string& buffer((*section_keys)[i].contents);
       buffer.append("Contents = ");
       buffer.append(reinterpret_cast<const char*>(contents), plen);
-      // Store the section contents that dont change to avoid recomputing
-      // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
-    }
-  else
-    {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
     }
-
-  buffer.append(icf_reloc_buffer);
-  return buffer;
 }
 
-// This function computes a checksum on each section to detect and form
+// This function uses the hash code of each section to detect and form
 // groups of identical sections.  The first iteration does this for all 
 // sections.
 // Further iterations do this only for the kept sections from each group to
 // determine if larger groups of identical sections could be formed.  The
 // first section in each group is the kept section for that group.
 //
-// CRC32 is the checksumming algorithm and can have collisions.  That is,
-// two sections with different contents can have the same checksum. Hence,
-// a multimap is used to maintain more than one group of checksum
-// identical sections.  A section is added to a group only after its
-// contents are explicitly compared with the kept section of the group.
+// The hash code of a section combines the hash code of its key, which
+// is computed once, with the kept sections of the sections pointed to
+// by its relocs to sections that could be folded.  The hash codes can
+// have collisions.  Hence, a multimap is used to maintain more than
+// one group of sections with the same hash code.  A section is added to
+// a group only after its key is explicitly compared with the key of
+// the kept section of the group.
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// ID_SECTION         : Vector mapping a section to an unique integer.
+// SECTION_KEYS       : Vector mapping a section index to its key.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
 
 static bool
 match_sections(unsigned int iteration_num,
-               Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
-               const std::vector<Section_id>& id_section,
-               std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               const std::vector<Icf::Section_key>& section_keys,
+               std::vector<bool>* is_secn_or_group_unique)
 {
-  Unordered_multimap<uint32_t, unsigned int> section_cksum;
-  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
-            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
+  Unordered_multimap<uint64_t, unsigned int> section_hash;
+  std::pair<Unordered_multimap<uint64_t, unsigned int>::iterator,
+            Unordered_multimap<uint64_t, unsigned int>::iterator> key_range;
   bool converged = true;
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
+  if (iteration_num > 1)
+    preprocess_for_unique_sections(section_keys, is_secn_or_group_unique);
 
-  std::vector<std::string> full_section_contents;
+  // For the kept section of each group, the kept sections pointed to
+  // by its relocs when the group was formed.
+  std::vector<std::vector<unsigned int> > group_relocs(section_keys.size());
+  std::vector<unsigned int> this_secn_relocs;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_keys.size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
-        {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
-        }
-      else
+      const Icf::Section_key& key(section_keys[i]);
+      if (iteration_num > 1 && (*kept_section_id)[i] != i)
         {
-          if ((*kept_section_id)[i] != i)
+          // This section is already folded into something.  See
+          // if it should point to a different kept section.
+          unsigned int kept_section = (*kept_section_id)[i];
+          if (kept_section != (*kept_section_id)[kept_section])
             {
-              // This section is already folded into something.  See
-              // if it should point to a different kept section.
-              unsigned int kept_section = (*kept_section_id)[i];
-              if (kept_section != (*kept_section_id)[kept_section])
-                {
-                  (*kept_section_id)[i] = (*kept_section_id)[kept_section];
-                }
-              continue;
+              (*kept_section_id)[i] = (*kept_section_id)[kept_section];
             }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
+          continue;
         }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
-      size_t count = section_cksum.count(cksum);
+      uint64_t hash = key.hash;
+      this_secn_relocs.clear();
+      for (std::vector<unsigned int>::const_iterator p =
+             key.icf_relocs.begin();
+           p != key.icf_relocs.end();
+           ++p)
+        {
+          unsigned int kept_section = (*kept_section_id)[*p];
+          this_secn_relocs.push_back(kept_section);
+          hash = icf_hash_mix(hash, kept_section);
+        }
 
-      if (count == 0)
+      key_range = section_hash.equal_range(hash);
+      Unordered_multimap<uint64_t, unsigned int>::iterator it;
+      // Search all the groups with this hash code for a match.
+      for (it = key_range.first; it != key_range.second; ++it)
         {
-          // Start a group with this cksum.
-          section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
+          unsigned int kept_section = it->second;
+          if (group_relocs[kept_section] != this_secn_relocs)
+            continue;
+          if (section_keys[kept_section].contents != key.contents)
+            continue;
+          (*kept_section_id)[i] = kept_section;
+          converged = false;
+          break;
         }
-      else
+      if (it == key_range.second)
         {
-          key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
-          // Search all the groups with this cksum for a match.
-          for (it = key_range.first; it != key_range.second; ++it)
-            {
-              unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
-              (*kept_section_id)[i] = kept_section;
-              converged = false;
-              break;
-            }
-          if (it == key_range.second)
-            {
-              // Create a new group for this cksum.
-              section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
-            }
+          // Create a new group for this hash code.
+          section_hash.insert(std::make_pair(hash, i));
+          group_relocs[i].swap(this_secn_relocs);
         }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && key.icf_relocs.empty())
         (*is_secn_or_group_unique)[i] = true;
     }
 
@@ -688,21 +677,70 @@ is_function_ctor_or_dtor(const std::string& section_name)
   return false;
 }
 
-// This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (twice by default)
-// which computes the crc checksums and detects identical functions.
+// This task computes the keys of the candidate sections of one object.
+// These tasks run in parallel after garbage collection.
+
+class Icf_section_key_task : public Task
+{
+ public:
+  Icf_section_key_task(Icf* icf, Symbol_table* symtab, Object* object,
+                       unsigned int first, unsigned int last,
+                       Task_token* blocker)
+    : icf_(icf), symtab_(symtab), object_(object), first_(first),
+      last_(last), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->icf_->compute_section_keys(this->object_, this->first_,
+                                     this->last_, this->symtab_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_section_key_task " + this->object_->name(); }
+
+ private:
+  Icf* icf_;
+  Symbol_table* symtab_;
+  Object* object_;
+  unsigned int first_;
+  unsigned int last_;
+  Task_token* blocker_;
+};
+
+// Decide which sections are possible candidates for folding.  Also
+// record the flags of the merge sections, which the section keys may
+// need to look at.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
+Icf::find_candidate_sections(const Input_objects* input_objects,
                              Symbol_table* symtab)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
-
-  // Decide which sections are possible candidates first.
+  const bool inline_merge_sections = target.can_icf_inline_merge_sections();
 
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
@@ -716,6 +754,13 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 
       for (unsigned int i = 0;i < (*p)->shnum(); ++i)
         {
+          if (inline_merge_sections)
+            {
+              uint64_t flags = (*p)->section_flags(i);
+              if ((flags & elfcpp::SHF_MERGE) != 0)
+                this->merge_section_flags_[Section_id(*p, i)] = flags;
+            }
+
 	  const std::string section_name = (*p)->section_name(i);
           if (!is_section_foldable_candidate(section_name))
             continue;
@@ -737,13 +782,98 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
           section_num++;
         }
     }
 
+  this->section_keys_.resize(section_num);
+}
+
+// Queue a task for each object with candidate sections to compute
+// their keys.  The candidate sections of an object are numbered
+// consecutively.
+
+void
+Icf::queue_section_key_tasks(const Input_objects* input_objects,
+                             Symbol_table* symtab, Workqueue* workqueue,
+                             Task_token* blocker)
+{
+  this->find_candidate_sections(input_objects, symtab);
+
+  unsigned int first = 0;
+  while (first < this->id_section_.size())
+    {
+      Object* obj = this->id_section_[first].first;
+      unsigned int last = first + 1;
+      while (last < this->id_section_.size()
+             && this->id_section_[last].first == obj)
+        ++last;
+      blocker->add_blocker();
+      workqueue->queue(new Icf_section_key_task(this, symtab, obj, first,
+                                                last, blocker));
+      first = last;
+    }
+}
+
+// Compute the keys of the candidate sections of OBJ numbered from
+// FIRST to LAST - 1.  This is called by Icf_section_key_task, so only
+// OBJ may be read.
+
+void
+Icf::compute_section_keys(Object* obj, unsigned int first,
+                          unsigned int last, Symbol_table* symtab)
+{
+  for (unsigned int i = first; i < last; ++i)
+    {
+      Section_id secn = this->id_section_[i];
+      gold_assert(secn.first == obj);
+      section_size_type plen;
+      const unsigned char* contents = obj->section_contents(secn.second,
+                                                            &plen, false);
+      Section_key* key = &this->section_keys_[i];
+      key->deferred = !get_section_key(secn, contents, plen, symtab, true,
+                                       key);
+    }
+}
+
+// This is the main ICF function called in gold.cc after the tasks
+// queued by queue_section_key_tasks have run.  This calls
+// match_sections repeatedly (twice by default) which detects
+// identical functions.
+
+void
+Icf::find_identical_sections(Symbol_table* symtab)
+{
+  std::vector<bool> is_secn_or_group_unique(this->id_section_.size(), false);
+
+  // Compute the keys which need to read more than one object.
+  for (unsigned int i = 0; i < this->id_section_.size(); ++i)
+    {
+      Section_key* key = &this->section_keys_[i];
+      if (!key->deferred)
+        continue;
+
+      Section_id secn = this->id_section_[i];
+      // Lock the object so we can read from it.  This is only called
+      // single-threaded after the section key tasks have run, so it is
+      // OK to lock.  Unfortunately we have no way to pass in a Task
+      // token.
+      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+      Task_lock_obj<Object> tl(dummy_task, secn.first);
+      section_size_type plen;
+      const unsigned char* contents =
+        secn.first->section_contents(secn.second, &plen, false);
+      get_section_key(secn, contents, plen, symtab, false, key);
+      key->deferred = false;
+    }
+
+  // Sections with unique hash codes can not be folded.  The others
+  // need their contents to be compared.
+  preprocess_for_unique_sections(this->section_keys_,
+                                 &is_secn_or_group_unique);
+  add_section_contents(this->id_section_, is_secn_or_group_unique,
+                       &this->section_keys_);
+
   unsigned int num_iterations = 0;
 
   // Default number of iterations to run ICF is 2.
@@ -756,12 +886,14 @@ Icf::find_identical_sections(const Input_objects* input_objects,
   while (!converged && (num_iterations < max_iterations))
     {
       num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, &is_secn_or_group_unique,
-                                 &section_contents);
+      converged = match_sections(num_iterations, &this->kept_section_id_,
+                                 this->section_keys_,
+                                 &is_secn_or_group_unique);
     }
 
+  // The keys are not needed any more.
+  std::vector<Section_key>().swap(this->section_keys_);
+
   if (parameters->options().print_icf_sections())
     {
       if (converged)
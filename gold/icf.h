@@ -35,6 +35,8 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Workqueue;
+class Task_token;
 
 class Icf
 {
@@ -48,6 +50,9 @@ class Icf
                         unsigned int,
                         Section_id_hash> Uniq_secn_id_map;
   typedef Unordered_set<Section_id, Section_id_hash> Secn_fptr_taken_set;
+  typedef Unordered_map<Section_id,
+                        uint64_t,
+                        Section_id_hash> Merge_section_flags;
 
   typedef struct
   {
@@ -64,9 +69,33 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  // The information used to match a section which does not change
+  // between iterations.  This is computed once for each candidate
+  // section, possibly in parallel.
+  struct Section_key
+  {
+    Section_key()
+      : hash(0), contents(), icf_relocs(), deferred(false)
+    { }
+
+    // A hash code of the contents of the section and of its relocs to
+    // sections which cannot be folded.
+    uint64_t hash;
+    // The relocs to sections which cannot be folded, followed by the
+    // contents of the section.  The contents are only added if the
+    // hash code is not unique.
+    std::string contents;
+    // The sections, by number, referred to by relocs to sections
+    // which might be folded.
+    std::vector<unsigned int> icf_relocs;
+    // True if the key could not be computed in parallel and must be
+    // computed by find_identical_sections.
+    bool deferred;
+  };
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
-    fptr_section_id_(),
+    section_keys_(), merge_section_flags_(), fptr_section_id_(),
     icf_ready_(false),
     reloc_info_list_()
   { }
@@ -77,10 +106,26 @@ class Icf
   get_folded_section(Object* dup_obj, unsigned int dup_shndx);
 
   // Forms groups of identical sections where the first member
-  // of each group is the kept section during folding.
+  // of each group is the kept section during folding.  This must be
+  // called after the tasks queued by queue_section_key_tasks have run.
   void
-  find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+  find_identical_sections(Symbol_table* symtab);
+
+  // Decide which sections are candidates for folding, and queue tasks
+  // to compute their keys in parallel.  Each task unblocks BLOCKER
+  // when it is done.  find_identical_sections must be called after
+  // BLOCKER is unblocked.
+  void
+  queue_section_key_tasks(const Input_objects* input_objects,
+                          Symbol_table* symtab, Workqueue* workqueue,
+                          Task_token* blocker);
+
+  // Compute the keys of the candidate sections in OBJ, numbered from
+  // FIRST to LAST - 1.  OBJ must be locked.  A section whose key
+  // requires reading another object is deferred.
+  void
+  compute_section_keys(Object* obj, unsigned int first, unsigned int last,
+                       Symbol_table* symtab);
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
@@ -142,8 +187,25 @@ class Icf
   section_to_int_map()
   { return this->section_id_; }
 
+  // Returns the flags of the section denoted by SECN if it is a merge
+  // section, or 0 if it is not.  The flags are read by
+  // find_candidate_sections, so that the section key tasks do not
+  // have to read the section headers of other objects.
+  uint64_t
+  merge_section_flags(const Section_id& secn) const
+  {
+    Merge_section_flags::const_iterator p =
+      this->merge_section_flags_.find(secn);
+    return p == this->merge_section_flags_.end() ? 0 : p->second;
+  }
+
  private:
 
+  // Decide which sections are candidates for folding.
+  void
+  find_candidate_sections(const Input_objects* input_objects,
+                          Symbol_table* symtab);
+
   // Maps integers to sections.
   std::vector<Section_id> id_section_;
   // Does the reverse.
@@ -152,6 +214,11 @@ class Icf
   // section.  If the id's are the same then this section is
   // not folded.
   std::vector<unsigned int> kept_section_id_;
+  // The key of each candidate section, indexed by section id.
+  std::vector<Section_key> section_keys_;
+  // The flags of each merge section in the input objects, if the
+  // target can inline merge sections.
+  Merge_section_flags merge_section_flags_;
   // Given a section id, this says if the pointer to this
   // function is taken in which case it is dangerous to fold
   // this function.
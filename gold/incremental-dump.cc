@@ -96,7 +96,7 @@ dump_incremental_inputs(const char* argv0, const char* filename,
   Incremental_inputs_reader<size, big_endian>
       incremental_inputs(inc->inputs_reader());
 
-  if (incremental_inputs.version() != 2)
+  if (incremental_inputs.version() != 2 && incremental_inputs.version() != 3)
     {
       fprintf(stderr, "%s: %s: unknown incremental version %d\n", argv0,
               filename, incremental_inputs.version());
@@ -133,6 +133,11 @@ dump_incremental_inputs(const char* argv0, const char* filename,
 	     mtime.nanoseconds,
 	     ctime(&mtime.seconds));
 
+      uint64_t content_hash = input_file.get_content_hash();
+      if (content_hash != 0)
+	printf("    Content Hash: %016llx\n",
+	       static_cast<unsigned long long>(content_hash));
+
       printf("    Serial Number: %d\n", input_file.arg_serial());
       printf("    In System Directory: %s\n",
 	     input_file.is_in_system_directory() ? "true" : "false");
@@ -163,6 +168,18 @@ dump_incremental_inputs(const char* argv0, const char* filename,
 	case INCREMENTAL_INPUT_ARCHIVE:
 	  printf("Archive\n");
 	  printf("    Member count: %d\n", input_file.get_member_count());
+	  for (unsigned int j = 0; j < input_file.get_member_count(); ++j)
+	    {
+	      uint64_t member_hash = input_file.get_member_hash(j);
+	      if (member_hash == 0)
+		continue;
+	      printf("    Member %d: offset 0x%llx, size %lld, hash %016llx\n",
+		     j,
+		     static_cast<unsigned long long>(
+			 input_file.get_member_file_offset(j)),
+		     static_cast<long long>(input_file.get_member_size(j)),
+		     static_cast<unsigned long long>(member_hash));
+	    }
 	  printf("    Unused symbol count: %d\n",
 		 input_file.get_unused_symbol_count());
 	  break;
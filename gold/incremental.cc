@@ -24,6 +24,7 @@
 
 #include <set>
 #include <cstdarg>
+#include <cstring>
 #include "libiberty.h"
 
 #include "elfcpp.h"
@@ -37,6 +38,7 @@
 #include "target-select.h"
 #include "target.h"
 #include "fileread.h"
+#include "hash.h"
 #include "script.h"
 
 namespace gold {
@@ -44,7 +46,12 @@ namespace gold {
 // Version number for the .gnu_incremental_inputs section.
 // Version 1 was the initial checkin.
 // Version 2 adds some padding to ensure 8-byte alignment where necessary.
+// Version 3 adds a hash of the contents of each input file, and the
+// location and contents hash of each archive member.  It is only
+// written with --incremental-check-hash, so that other links keep
+// using version 2.
 const unsigned int INCREMENTAL_LINK_VERSION = 2;
+const unsigned int INCREMENTAL_LINK_HASH_VERSION = 3;
 
 // This class manages the .gnu_incremental_inputs section, which holds
 // the header information, a directory of input files, and separate
@@ -56,7 +63,8 @@ class Output_section_incremental_inputs : public Output_section_data
  public:
   Output_section_incremental_inputs(const Incremental_inputs* inputs,
 				    const Symbol_table* symtab)
-    : Output_section_data(size / 8), inputs_(inputs), symtab_(symtab)
+    : Output_section_data(size / 8), inputs_(inputs), symtab_(symtab),
+      has_content_hashes_(parameters->options().incremental_check_hash())
   { }
 
  protected:
@@ -115,8 +123,6 @@ class Output_section_incremental_inputs : public Output_section_data
   static const int sizeof_addr = size / 8;
   static const int header_size =
       Incremental_inputs_reader<size, big_endian>::header_size;
-  static const int input_entry_size =
-      Incremental_inputs_reader<size, big_endian>::input_entry_size;
   static const unsigned int object_info_size =
       Incremental_inputs_reader<size, big_endian>::object_info_size;
   static const unsigned int input_section_entry_size =
@@ -129,8 +135,32 @@ class Output_section_incremental_inputs : public Output_section_data
   // The Incremental_inputs object.
   const Incremental_inputs* inputs_;
 
+  // Return the size of an input file entry.
+  unsigned int
+  input_entry_size() const
+  {
+    typedef Incremental_inputs_reader<size, big_endian> Reader;
+    return (this->has_content_hashes_
+	    ? Reader::hashed_input_entry_size
+	    : Reader::input_entry_size);
+  }
+
+  // Return the size of an archive member entry.
+  unsigned int
+  archive_member_entry_size() const
+  {
+    typedef Incremental_inputs_reader<size, big_endian> Reader;
+    return (this->has_content_hashes_
+	    ? Reader::hashed_archive_member_entry_size
+	    : Reader::archive_member_entry_size);
+  }
+
   // The symbol table.
   const Symbol_table* symtab_;
+
+  // TRUE if we record the contents hash of each input file and
+  // archive member, for --incremental-check-hash.
+  bool has_content_hashes_;
 };
 
 // Inform the user why we don't do an incremental link.  Not called in
@@ -307,6 +337,7 @@ Sized_incremental_binary<size, big_endian>::setup_readers()
   this->input_objects_.resize(count);
   this->input_entry_readers_.reserve(count);
   this->library_map_.resize(count);
+  this->member_slots_.resize(count);
   this->script_map_.resize(count);
   for (unsigned int i = 0; i < count; i++)
     {
@@ -331,6 +362,7 @@ Sized_incremental_binary<size, big_endian>::setup_readers()
 		int member_offset = input_file.get_member_offset(j);
 		int member_index = inputs.input_file_index(member_offset);
 		this->library_map_[member_index] = lib;
+		this->member_slots_[member_index] = j;
 	      }
 	  }
 	  break;
@@ -412,7 +444,8 @@ Sized_incremental_binary<size, big_endian>::do_check_inputs(
       return false;
     }
 
-  if (inputs.version() != INCREMENTAL_LINK_VERSION)
+  if (inputs.version() != INCREMENTAL_LINK_VERSION
+      && inputs.version() != INCREMENTAL_LINK_HASH_VERSION)
     {
       explain_no_incremental(_("different version of incremental build data"));
       return false;
@@ -471,9 +504,10 @@ Sized_incremental_binary<size, big_endian>::do_check_inputs(
 template<int size, bool big_endian>
 bool
 Sized_incremental_binary<size, big_endian>::do_file_has_changed(
-    unsigned int n) const
+    unsigned int n)
 {
   Input_entry_reader input_file = this->inputs_reader_.input_file(n);
+  const unsigned int input_file_index = n;
   Incremental_disposition disp = INCREMENTAL_CHECK;
 
   // For files named in scripts, find the file that was actually named
@@ -507,14 +541,149 @@ Sized_incremental_binary<size, big_endian>::do_file_has_changed(
       return true;
     }
 
-  if (new_mtime.seconds > old_mtime.seconds)
+  if (new_mtime.seconds < old_mtime.seconds
+      || (new_mtime.seconds == old_mtime.seconds
+	  && new_mtime.nanoseconds <= old_mtime.nanoseconds))
+    return false;
+
+  // The file has been touched.  With --incremental-check-hash, it
+  // has only changed if its contents no longer match the hash we
+  // recorded last time.
+  uint64_t old_hash = input_file.get_content_hash();
+  if (!parameters->options().incremental_check_hash() || old_hash == 0)
+    return true;
+
+  if (this->content_hash_checked_.empty())
+    this->content_hash_checked_.resize(this->inputs_reader_.input_file_count(),
+				       0);
+  if (this->content_hash_checked_[input_file_index] == 0)
+    {
+      uint64_t new_hash;
+      bool same = (get_content_hash(filename, &new_hash)
+		   && new_hash == old_hash);
+      this->content_hash_checked_[input_file_index] = same ? 1 : 2;
+      if (same)
+	{
+	  gold_debug(DEBUG_INCREMENTAL,
+		     "%s: timestamp changed but contents did not", filename);
+	  this->input_entry_readers_[input_file_index].set_mtime(new_mtime);
+	}
+    }
+  return this->content_hash_checked_[input_file_index] == 2;
+}
+
+// Get the location and contents hash of archive member N recorded by
+// the last link.
+
+template<int size, bool big_endian>
+void
+Sized_incremental_binary<size, big_endian>::do_get_member_info(
+    unsigned int n,
+    Incremental_member_info* info) const
+{
+  Incremental_library* lib = this->library_map_[n];
+  gold_assert(lib != NULL);
+  Input_entry_reader archive =
+      this->inputs_reader_.input_file(lib->input_file_index());
+  unsigned int slot = this->member_slots_[n];
+  *info = Incremental_member_info(archive.get_member_file_offset(slot),
+				  archive.get_member_size(slot),
+				  archive.get_member_hash(slot));
+}
+
+// Return TRUE if archive member N has changed since the last link.
+// We look for a member with the same name in the new version of the
+// archive, and compare its size and contents hash with what we
+// recorded last time.  If it has not changed, set *INFO to where it is
+// in the new archive, since other members may have moved.  We only
+// compare members with --incremental-check-hash.
+
+template<int size, bool big_endian>
+bool
+Sized_incremental_binary<size, big_endian>::do_member_has_changed(
+    Task* task,
+    Dirsearch* dirpath,
+    unsigned int n,
+    Incremental_member_info* info)
+{
+  if (!parameters->options().incremental_check_hash())
+    return true;
+
+  Incremental_member_info old_info;
+  this->do_get_member_info(n, &old_info);
+  if (old_info.offset == 0 || old_info.hash == 0)
     return true;
-  if (new_mtime.seconds == old_mtime.seconds
-      && new_mtime.nanoseconds > old_mtime.nanoseconds)
+
+  Incremental_library* lib = this->library_map_[n];
+  const Archive_members& members =
+      this->get_archive_members(task, dirpath, lib->input_file_index());
+  const char* filename = this->inputs_reader_.input_file(n).filename();
+  typename Archive_members::const_iterator p = members.find(filename);
+  if (p == members.end()
+      || p->second.offset == 0
+      || p->second.size != old_info.size
+      || p->second.hash != old_info.hash)
     return true;
+
+  gold_debug(DEBUG_INCREMENTAL, "%s: unchanged member of changed archive",
+	     filename);
+  *info = p->second;
   return false;
 }
 
+// Return the members of the archive library for input file N.  The
+// first time, we read the new version of the archive from TASK.  If
+// it can't be read, or it is a thin archive, there are no members,
+// and every member will be read again.
+
+template<int size, bool big_endian>
+const typename Sized_incremental_binary<size, big_endian>::Archive_members&
+Sized_incremental_binary<size, big_endian>::get_archive_members(
+    Task* task,
+    Dirsearch* dirpath,
+    unsigned int n)
+{
+  typename std::map<unsigned int, Archive_members>::const_iterator p =
+      this->archive_members_.find(n);
+  if (p != this->archive_members_.end())
+    return p->second;
+
+  gold_assert(task != NULL);
+  Archive_members& members = this->archive_members_[n];
+
+  // Find the archive the same way as the Read_symbols task that
+  // will read it.
+  const Input_argument* input_argument = this->get_input_argument(n);
+  Input_file* input_file;
+  if (input_argument != NULL && input_argument->is_file())
+    input_file = new Input_file(&input_argument->file());
+  else
+    {
+      const char* filename = this->inputs_reader_.input_file(n).filename();
+      input_file = new Input_file(filename);
+    }
+
+  int dirindex = 0;
+  if (input_file->open(*dirpath, task, &dirindex))
+    {
+      const unsigned char* magic = NULL;
+      if (input_file->file().filesize() > Archive::sarmag)
+	magic = input_file->file().get_view(0, 0, Archive::sarmag, true,
+					    false);
+      if (magic != NULL
+	  && memcmp(magic, Archive::armag, Archive::sarmag) == 0)
+	{
+	  Archive archive(input_file->filename(), input_file, false, dirpath,
+			  task);
+	  archive.setup();
+	  archive.get_all_member_info(&members);
+	}
+      input_file->file().unlock(task);
+    }
+  delete input_file;
+  return members;
+}
+
 // Initialize the layout of the output file based on the existing
 // output file.
 
@@ -1011,13 +1180,37 @@ Incremental_inputs::report_command_line(int argc, const char* const* argv)
 // Add_archive_symbols task before determining which archive members
 // to include.  We create the Incremental_archive_entry here and
 // attach it to the Archive, but we do not add it to the list of
-// input objects until report_archive_end is called.
+// input objects until report_archive_end is called.  If ARCHIVE is
+// the new version of a changed archive library from which some
+// members were kept, we use the entry which recorded those members.
 
 void
 Incremental_inputs::report_archive_begin(Library_base* arch,
 					 unsigned int arg_serial,
 					 Script_info* script_info)
 {
+  for (std::vector<Incremental_library*>::iterator p =
+	 this->changed_libraries_.begin();
+       p != this->changed_libraries_.end();
+       ++p)
+    {
+      if (*p != arch && (*p)->filename() == arch->filename())
+	{
+	  Incremental_archive_entry* entry = (*p)->incremental_info();
+	  this->changed_libraries_.erase(p);
+	  if (entry != NULL)
+	    {
+	      // The entry was made for the old version of the archive.
+	      entry->set_mtime(arch->get_mtime());
+	      if (parameters->options().incremental_check_hash())
+		entry->set_content_hash(arch->get_content_hash());
+	      arch->set_incremental_info(entry);
+	      return;
+	    }
+	  break;
+	}
+    }
+
   Stringpool::Key filename_key;
   Timespec mtime = arch->get_mtime();
 
@@ -1028,6 +1221,8 @@ Incremental_inputs::report_archive_begin(Library_base* arch,
   this->strtab_->add(arch->filename().c_str(), false, &filename_key);
   Incremental_archive_entry* entry =
       new Incremental_archive_entry(filename_key, arg_serial, mtime);
+  if (parameters->options().incremental_check_hash())
+    entry->set_content_hash(arch->get_content_hash());
   arch->set_incremental_info(entry);
 
   if (script_info != NULL)
@@ -1112,7 +1307,10 @@ Incremental_inputs::report_object(Object* obj, unsigned int arg_serial,
 	{
 	  Incremental_archive_entry* arch_entry = arch->incremental_info();
 	  gold_assert(arch_entry != NULL);
-	  arch_entry->add_object(this->current_object_entry_);
+	  Incremental_member_info info;
+	  if (parameters->options().incremental_check_hash())
+	    arch->get_member_info(obj, &info);
+	  arch_entry->add_object(this->current_object_entry_, info);
 	}
     }
   else
@@ -1132,6 +1330,9 @@ Incremental_inputs::report_object(Object* obj, unsigned int arg_serial,
   if (obj->as_needed())
     input_entry->set_as_needed();
 
+  if (parameters->options().incremental_check_hash())
+    input_entry->set_content_hash(obj->get_content_hash());
+
   this->inputs_.push_back(input_entry);
 
   if (script_info != NULL)
@@ -1186,6 +1387,10 @@ Incremental_inputs::report_script(Script_info* script,
   this->strtab_->add(script->filename().c_str(), false, &filename_key);
   Incremental_script_entry* entry =
       new Incremental_script_entry(filename_key, arg_serial, script, mtime);
+  uint64_t content_hash;
+  if (parameters->options().incremental_check_hash()
+      && get_content_hash(script->filename().c_str(), &content_hash))
+    entry->set_content_hash(content_hash);
   this->inputs_.push_back(entry);
   script->set_incremental_info(entry);
 }
@@ -1270,7 +1475,7 @@ Output_section_incremental_inputs<size, big_endian>::set_final_data_size()
   // Offset of each supplemental info block.
   unsigned int file_index = 0;
   unsigned int info_offset = this->header_size;
-  info_offset += this->input_entry_size * inputs->input_file_count();
+  info_offset += this->input_entry_size() * inputs->input_file_count();
 
   // Count each input file and its supplemental information block.
   for (Incremental_inputs::Input_list::const_iterator p =
@@ -1281,7 +1486,7 @@ Output_section_incremental_inputs<size, big_endian>::set_final_data_size()
       // Set the index and offset of the input file entry.
       (*p)->set_offset(file_index, input_offset);
       ++file_index;
-      input_offset += this->input_entry_size;
+      input_offset += this->input_entry_size();
 
       // Set the offset of the supplemental info block.
       switch ((*p)->type())
@@ -1350,7 +1555,8 @@ Output_section_incremental_inputs<size, big_endian>::set_final_data_size()
 	    // Member count + unused global symbol count.
 	    info_offset += 8;
 	    // Each member.
-	    info_offset += (entry->get_member_count() * 4);
+	    info_offset += (entry->get_member_count()
+			    * this->archive_member_entry_size());
 	    // Each global symbol.
 	    info_offset += (entry->get_unused_global_symbol_count() * 4);
 	  }
@@ -1459,7 +1665,9 @@ Output_section_incremental_inputs<size, big_endian>::write_header(
     unsigned int input_file_count,
     section_offset_type command_line_offset)
 {
-  Swap32::writeval(pov, INCREMENTAL_LINK_VERSION);
+  Swap32::writeval(pov, (this->has_content_hashes_
+			 ? INCREMENTAL_LINK_HASH_VERSION
+			 : INCREMENTAL_LINK_VERSION));
   Swap32::writeval(pov + 4, input_file_count);
   Swap32::writeval(pov + 8, command_line_offset);
   Swap32::writeval(pov + 12, 0);
@@ -1498,8 +1706,9 @@ Output_section_incremental_inputs<size, big_endian>::write_input_files(
       Swap32::writeval(pov + 16, mtime.nanoseconds);
       Swap16::writeval(pov + 20, flags);
       Swap16::writeval(pov + 22, (*p)->arg_serial());
-      gold_assert(this->input_entry_size == 24);
-      pov += this->input_entry_size;
+      if (this->has_content_hashes_)
+	Swap64::writeval(pov + 24, (*p)->get_content_hash());
+      pov += this->input_entry_size();
     }
   return pov;
 }
@@ -1753,11 +1962,22 @@ Output_section_incremental_inputs<size, big_endian>::write_info_blocks(
 	    pov += 8;
 
 	    // For each member, write the offset to its input file entry.
+	    // With content hashes, follow it with 4 bytes of padding,
+	    // and the location and contents hash of the member.
 	    for (unsigned int i = 0; i < nmembers; ++i)
 	      {
 		Incremental_object_entry* member = entry->get_member(i);
 		Swap32::writeval(pov, member->get_offset());
-		pov += 4;
+		if (this->has_content_hashes_)
+		  {
+		    const Incremental_member_info& info =
+			entry->get_member_info(i);
+		    Swap32::writeval(pov + 4, 0);
+		    Swap64::writeval(pov + 8, info.offset);
+		    Swap64::writeval(pov + 16, info.size);
+		    Swap64::writeval(pov + 24, info.hash);
+		  }
+		pov += this->archive_member_entry_size();
 	      }
 
 	    // For each global symbol, write the name offset.
@@ -3074,6 +3294,20 @@ Incremental_library::do_for_all_unused_symbols(Symbol_visitor_base* v) const
   v->visit(p->c_str());
 }
 
+// Get the location and contents hash of a member kept from the
+// previous link.
+bool
+Incremental_library::do_get_member_info(Object* obj,
+					Incremental_member_info* info)
+{
+  std::map<Object*, Incremental_member_info>::const_iterator p =
+      this->member_info_.find(obj);
+  if (p == this->member_info_.end())
+    return false;
+  *info = p->second;
+  return true;
+}
+
 // Instantiate the templates we need.
 
 #ifdef HAVE_TARGET_32_LITTLE
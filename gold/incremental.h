@@ -100,8 +100,8 @@ class Incremental_input_entry
   Incremental_input_entry(Stringpool::Key filename_key, unsigned int arg_serial,
 			  Timespec mtime)
     : filename_key_(filename_key), file_index_(0), offset_(0), info_offset_(0),
-      arg_serial_(arg_serial), mtime_(mtime), is_in_system_directory_(false),
-      as_needed_(false)
+      arg_serial_(arg_serial), mtime_(mtime), content_hash_(0),
+      is_in_system_directory_(false), as_needed_(false)
   { }
 
   virtual
@@ -156,6 +156,22 @@ class Incremental_input_entry
   get_mtime() const
   { return this->mtime_; }
 
+  // Set the modification time of the input file.
+  void
+  set_mtime(const Timespec& mtime)
+  { this->mtime_ = mtime; }
+
+  // Set the hash of the contents of the input file.
+  void
+  set_content_hash(uint64_t content_hash)
+  { this->content_hash_ = content_hash; }
+
+  // Get the hash of the contents of the input file, or 0 if none was
+  // computed.
+  uint64_t
+  get_content_hash() const
+  { return this->content_hash_; }
+
   // Record that the file was found in a system directory.
   void
   set_is_in_system_directory()
@@ -248,6 +264,9 @@ class Incremental_input_entry
   // Last modification time of the file.
   Timespec mtime_;
 
+  // Hash of the contents of the file, for --incremental-check-hash.
+  uint64_t content_hash_;
+
   // TRUE if the file was found in a system directory.
   bool is_in_system_directory_;
 
@@ -488,6 +507,27 @@ class Incremental_dynobj_entry : public Incremental_input_entry
   Object* obj_;
 };
 
+// The location of a member in an archive and a hash of its contents,
+// so that an incremental update can tell which members of a changed
+// archive are still the same.  OFFSET is the offset of the member
+// header; it is 0 if the location is not known, as for the external
+// members of a thin archive.
+
+struct Incremental_member_info
+{
+  Incremental_member_info()
+    : offset(0), size(0), hash(0)
+  { }
+
+  Incremental_member_info(off_t off, off_t sz, uint64_t h)
+    : offset(off), size(sz), hash(h)
+  { }
+
+  off_t offset;
+  off_t size;
+  uint64_t hash;
+};
+
 // Class for recording archive library input files.
 
 class Incremental_archive_entry : public Incremental_input_entry
@@ -496,14 +536,16 @@ class Incremental_archive_entry : public Incremental_input_entry
   Incremental_archive_entry(Stringpool::Key filename_key,
 			    unsigned int arg_serial, Timespec mtime)
     : Incremental_input_entry(filename_key, arg_serial, mtime), members_(),
-      unused_syms_()
+      member_info_(), unused_syms_()
   { }
 
   // Add a member object to the archive.
   void
-  add_object(Incremental_object_entry* obj_entry)
+  add_object(Incremental_object_entry* obj_entry,
+	     const Incremental_member_info& info)
   {
     this->members_.push_back(obj_entry);
+    this->member_info_.push_back(info);
     obj_entry->set_is_member();
   }
 
@@ -522,6 +564,11 @@ class Incremental_archive_entry : public Incremental_input_entry
   get_member(unsigned int n)
   { return this->members_[n]; }
 
+  // Return the location and hash of the Nth member object.
+  const Incremental_member_info&
+  get_member_info(unsigned int n)
+  { return this->member_info_[n]; }
+
   // Return the number of unused global symbols in this archive.
   unsigned int
   get_unused_global_symbol_count()
@@ -546,6 +593,9 @@ class Incremental_archive_entry : public Incremental_input_entry
   // Members of the archive that have been included in the link.
   std::vector<Incremental_object_entry*> members_;
 
+  // The location and hash of each member in MEMBERS_.
+  std::vector<Incremental_member_info> member_info_;
+
   // Unused global symbols from this archive.
   std::vector<Stringpool::Key> unused_syms_;
 };
@@ -561,8 +611,8 @@ class Incremental_inputs
   Incremental_inputs()
     : inputs_(), command_line_(), command_line_key_(0),
       strtab_(new Stringpool()), current_object_(NULL),
-      current_object_entry_(NULL), inputs_section_(NULL),
-      symtab_section_(NULL), relocs_section_(NULL),
+      current_object_entry_(NULL), changed_libraries_(),
+      inputs_section_(NULL), symtab_section_(NULL), relocs_section_(NULL),
       reloc_count_(0)
   { }
 
@@ -581,6 +631,14 @@ class Incremental_inputs
   void
   report_archive_end(Library_base* arch);
 
+  // Record that the archive library LIB from the base file has
+  // changed, and will be read again.  Members of LIB which are kept
+  // from the previous link are recorded in the same entry as the
+  // members included from the new archive.
+  void
+  report_changed_archive(Incremental_library* lib)
+  { this->changed_libraries_.push_back(lib); }
+
   // Record the info for object file OBJ.  If ARCH is not NULL,
   // attach the object file to the archive.
   void
@@ -688,6 +746,9 @@ class Incremental_inputs
   Object* current_object_;
   Incremental_object_entry* current_object_entry_;
 
+  // Changed archive libraries which will be read again, in order.
+  std::vector<Incremental_library*> changed_libraries_;
+
   // The .gnu_incremental_inputs section.
   Output_section_data* inputs_section_;
 
@@ -762,6 +823,9 @@ class Incremental_inputs_reader
   // Size of an input file entry.
   // (2 x 4-byte fields, 1 x 12-byte field, 2 x 2-byte fields.)
   static const unsigned int input_entry_size = 24;
+  // Size of an input file entry in a section with content hashes.
+  // (As above, plus 1 x 8-byte field.)
+  static const unsigned int hashed_input_entry_size = 32;
   // Size of the first part of the supplemental info block for
   // relocatable objects and archive members.
   // (7 x 4-byte fields, plus 4 bytes padding.)
@@ -772,21 +836,37 @@ class Incremental_inputs_reader
   // Size of a global symbol entry in the supplemental info block.
   // (5 x 4-byte fields.)
   static const unsigned int global_sym_entry_size = 20;
+  // Size of an archive member entry in the supplemental info block.
+  // (1 x 4-byte field.)
+  static const unsigned int archive_member_entry_size = 4;
+  // Size of an archive member entry in a section with content hashes.
+  // (1 x 4-byte field, plus 4 bytes padding, 3 x 8-byte fields.)
+  static const unsigned int hashed_archive_member_entry_size = 32;
 
   Incremental_inputs_reader()
-    : p_(NULL), strtab_(NULL, 0), input_file_count_(0)
+    : p_(NULL), strtab_(NULL, 0), input_file_count_(0),
+      has_content_hashes_(false)
   { }
 
   Incremental_inputs_reader(const unsigned char* p,
 			    const elfcpp::Elf_strtab& strtab)
     : p_(p), strtab_(strtab)
-  { this->input_file_count_ = Swap32::readval(this->p_ + 4); }
+  {
+    this->input_file_count_ = Swap32::readval(this->p_ + 4);
+    this->has_content_hashes_ = has_content_hashes(this->version());
+  }
 
   // Return the version number.
   unsigned int
   version() const
   { return Swap32::readval(this->p_); }
 
+  // Return TRUE if a section with version number VERSION records a
+  // hash of the contents of each input file and archive member.
+  static bool
+  has_content_hashes(unsigned int version)
+  { return version >= 3; }
+
   // Return the count of input file entries.
   unsigned int
   input_file_count() const
@@ -846,6 +926,15 @@ class Incremental_inputs_reader
       return t;
     }
 
+    // Return the hash of the file contents, or 0 if none was recorded.
+    uint64_t
+    get_content_hash() const
+    {
+      if (!this->inputs_->has_content_hashes_)
+	return 0;
+      return Swap64::readval(this->inputs_->p_ + this->offset_ + 24);
+    }
+
     // Return the type of input file.
     Incremental_input_type
     type() const
@@ -994,18 +1083,36 @@ class Incremental_inputs_reader
     {
       gold_assert(this->type() == INCREMENTAL_INPUT_ARCHIVE);
       return Swap32::readval(this->inputs_->p_ + this->info_offset_
-			     + 8 + n * 4);
+			     + 8 + n * this->inputs_->member_entry_size());
     }
 
+    // Return the offset of the header of archive member N within the
+    // archive, or 0 if it is not known -- for archives only.
+    off_t
+    get_member_file_offset(unsigned int n) const
+    { return this->get_member_field(n, 8); }
+
+    // Return the size of archive member N -- for archives only.
+    off_t
+    get_member_size(unsigned int n) const
+    { return this->get_member_field(n, 16); }
+
+    // Return the hash of the contents of archive member N, or 0 if
+    // none was recorded -- for archives only.
+    uint64_t
+    get_member_hash(unsigned int n) const
+    { return this->get_member_field(n, 24); }
+
     // Return the Nth unused global symbol -- for archives only.
     const char*
     get_unused_symbol(unsigned int n) const
     {
       gold_assert(this->type() == INCREMENTAL_INPUT_ARCHIVE);
-      unsigned int member_count = this->get_member_count();
+      unsigned int members_size = (this->get_member_count()
+				   * this->inputs_->member_entry_size());
       unsigned int offset = Swap32::readval(this->inputs_->p_
 					    + this->info_offset_ + 8
-					    + member_count * 4
+					    + members_size
 					    + n * 4);
       return this->inputs_->get_string(offset);
     }
@@ -1099,6 +1206,19 @@ class Incremental_inputs_reader
     }
 
    private:
+    // Return the 8-byte field at offset OFF in the entry for archive
+    // member N, or 0 if the section has no content hashes.
+    uint64_t
+    get_member_field(unsigned int n, unsigned int off) const
+    {
+      gold_assert(this->type() == INCREMENTAL_INPUT_ARCHIVE);
+      if (!this->inputs_->has_content_hashes_)
+	return 0;
+      return Swap64::readval(this->inputs_->p_ + this->info_offset_
+			     + 8 + n * this->inputs_->member_entry_size()
+			     + off);
+    }
+
     // The reader instance for the containing section.
     const Incremental_inputs_reader* inputs_;
     // The flags, including the type of input file.
@@ -1114,14 +1234,14 @@ class Incremental_inputs_reader
   input_file_offset(unsigned int n) const
   {
     gold_assert(n < this->input_file_count_);
-    return this->header_size + n * this->input_entry_size;
+    return this->header_size + n * this->entry_size();
   }
 
   // Return the index of an input file entry given its OFFSET.
   unsigned int
   input_file_index(unsigned int offset) const
   {
-    int n = ((offset - this->header_size) / this->input_entry_size);
+    int n = ((offset - this->header_size) / this->entry_size());
     gold_assert(input_file_offset(n) == offset);
     return n;
   }
@@ -1136,7 +1256,7 @@ class Incremental_inputs_reader
   input_file_at_offset(unsigned int offset) const
   {
     gold_assert(offset < (this->header_size
-			  + this->input_file_count_ * this->input_entry_size));
+			  + this->input_file_count_ * this->entry_size()));
     return Incremental_input_entry_reader(this, offset);
   }
 
@@ -1149,6 +1269,24 @@ class Incremental_inputs_reader
   }
 
  private:
+  // Return the size of an input file entry.
+  unsigned int
+  entry_size() const
+  {
+    return (this->has_content_hashes_
+	    ? this->hashed_input_entry_size
+	    : this->input_entry_size);
+  }
+
+  // Return the size of an archive member entry.
+  unsigned int
+  member_entry_size() const
+  {
+    return (this->has_content_hashes_
+	    ? this->hashed_archive_member_entry_size
+	    : this->archive_member_entry_size);
+  }
+
   // Lookup a string in the ELF string table.
   const char* get_string(unsigned int offset) const
   {
@@ -1164,6 +1302,9 @@ class Incremental_inputs_reader
   elfcpp::Elf_strtab strtab_;
   // The number of input file entries in this section.
   unsigned int input_file_count_;
+  // TRUE if the entries include content hashes, for
+  // --incremental-check-hash.
+  bool has_content_hashes_;
 };
 
 // Reader class for the .gnu_incremental_symtab section.
@@ -1380,6 +1521,10 @@ class Incremental_binary
     get_mtime() const
     { return this->do_get_mtime(); }
 
+    uint64_t
+    get_content_hash() const
+    { return this->do_get_content_hash(); }
+
     Incremental_input_type
     type() const
     { return this->do_type(); }
@@ -1403,6 +1548,9 @@ class Incremental_binary
     virtual Timespec
     do_get_mtime() const = 0;
 
+    virtual uint64_t
+    do_get_content_hash() const = 0;
+
     virtual Incremental_input_type
     do_type() const = 0;
 
@@ -1428,9 +1576,25 @@ class Incremental_binary
 
   // Return TRUE if the input file N has changed since the last link.
   bool
-  file_has_changed(unsigned int n) const
+  file_has_changed(unsigned int n)
   { return this->do_file_has_changed(n); }
 
+  // Set *INFO to the location and contents hash of archive member N
+  // recorded by the last link.
+  void
+  get_member_info(unsigned int n, Incremental_member_info* info) const
+  { this->do_get_member_info(n, info); }
+
+  // Return TRUE if archive member N has changed since the last link.
+  // This is called when the archive containing the member has changed.
+  // TASK reads the new version of the archive, which is found using
+  // DIRPATH.  If the member has not changed, set *INFO to its location
+  // and contents hash in the new archive.
+  bool
+  member_has_changed(Task* task, Dirsearch* dirpath, unsigned int n,
+		     Incremental_member_info* info)
+  { return this->do_member_has_changed(task, dirpath, n, info); }
+
   // Return the Input_argument for input file N.  Returns NULL if
   // the Input_argument is not available.
   const Input_argument*
@@ -1541,7 +1705,16 @@ class Incremental_binary
 
   // Return TRUE if input file N has changed since the last incremental link.
   virtual bool
-  do_file_has_changed(unsigned int n) const = 0;
+  do_file_has_changed(unsigned int n) = 0;
+
+  // Get the recorded location and contents hash of archive member N.
+  virtual void
+  do_get_member_info(unsigned int n, Incremental_member_info* info) const = 0;
+
+  // Return TRUE if archive member N has changed since the last link.
+  virtual bool
+  do_member_has_changed(Task* task, Dirsearch* dirpath, unsigned int n,
+			Incremental_member_info* info) = 0;
 
   // Initialize the layout of the output file based on the existing
   // output file.
@@ -1596,7 +1769,8 @@ class Sized_incremental_binary : public Incremental_binary
       input_objects_(), section_map_(), symbol_map_(), copy_relocs_(),
       main_symtab_loc_(), main_strtab_loc_(), has_incremental_info_(false),
       inputs_reader_(), symtab_reader_(), relocs_reader_(), got_plt_reader_(),
-      input_entry_readers_()
+      input_entry_readers_(), content_hash_checked_(), member_slots_(),
+      archive_members_()
   { this->setup_readers(); }
 
   // Returns TRUE if the file contains incremental info.
@@ -1675,7 +1849,16 @@ class Sized_incremental_binary : public Incremental_binary
 
   // Return TRUE if input file N has changed since the last incremental link.
   virtual bool
-  do_file_has_changed(unsigned int n) const;
+  do_file_has_changed(unsigned int n);
+
+  // Get the recorded location and contents hash of archive member N.
+  virtual void
+  do_get_member_info(unsigned int n, Incremental_member_info* info) const;
+
+  // Return TRUE if archive member N has changed since the last link.
+  virtual bool
+  do_member_has_changed(Task* task, Dirsearch* dirpath, unsigned int n,
+			Incremental_member_info* info);
 
   // Initialize the layout of the output file based on the existing
   // output file.
@@ -1705,13 +1888,21 @@ class Sized_incremental_binary : public Incremental_binary
   {
    public:
     Sized_input_reader(Input_entry_reader r)
-      : Input_reader(), reader_(r)
+      : Input_reader(), reader_(r), mtime_(r.get_mtime())
     { }
 
     virtual
     ~Sized_input_reader()
     { }
 
+    // Set the modification time to record for the file in the new
+    // incremental info.  This is used for a file which was touched
+    // but whose contents have not changed, so that the next link
+    // does not need to hash it again.
+    void
+    set_mtime(const Timespec& mtime)
+    { this->mtime_ = mtime; }
+
    private:
     const char*
     do_filename() const
@@ -1719,7 +1910,11 @@ class Sized_incremental_binary : public Incremental_binary
 
     Timespec
     do_get_mtime() const
-    { return this->reader_.get_mtime(); }
+    { return this->mtime_; }
+
+    uint64_t
+    do_get_content_hash() const
+    { return this->reader_.get_content_hash(); }
 
     Incremental_input_type
     do_type() const
@@ -1738,6 +1933,8 @@ class Sized_incremental_binary : public Incremental_binary
     { return this->reader_.get_unused_symbol(n); }
 
     Input_entry_reader reader_;
+    // The modification time of the file.
+    Timespec mtime_;
   };
 
   virtual unsigned int
@@ -1805,6 +2002,29 @@ class Sized_incremental_binary : public Incremental_binary
   Incremental_relocs_reader<size, big_endian> relocs_reader_;
   Incremental_got_plt_reader<big_endian> got_plt_reader_;
   std::vector<Sized_input_reader> input_entry_readers_;
+
+  // For --incremental-check-hash, the result of comparing the hash of
+  // each input file with the recorded hash: 0 if not yet compared,
+  // 1 if the hashes match, 2 if they differ.  Each archive member asks
+  // about its archive, so we only want to hash the archive once.
+  std::vector<unsigned char> content_hash_checked_;
+
+  // For each archive member, the index of the member in the list of
+  // members of its archive.
+  std::vector<unsigned int> member_slots_;
+
+  // The members of a changed archive library, found by reading the
+  // new version of the archive.  The key is the name that Archive
+  // gives to the object for the member.
+  typedef std::map<std::string, Incremental_member_info> Archive_members;
+
+  // Return the members of the archive library for input file N,
+  // reading the archive from TASK the first time.
+  const Archive_members&
+  get_archive_members(Task* task, Dirsearch* dirpath, unsigned int n);
+
+  // Map from input file index to the members of a changed archive.
+  std::map<unsigned int, Archive_members> archive_members_;
 };
 
 // An incremental Relobj.  This class represents a relocatable object
@@ -1867,7 +2087,14 @@ class Sized_relobj_incr : public Sized_relobj<size, big_endian>
   // Return the last modified time of the file.
   Timespec
   do_get_mtime()
-  { return this->input_reader_.get_mtime(); }
+  {
+    return this->ibase_->get_input_reader(this->input_file_index_)->get_mtime();
+  }
+
+  // Return the hash of the file contents recorded by the last link.
+  uint64_t
+  do_get_content_hash()
+  { return this->input_reader_.get_content_hash(); }
 
   // Read the symbols.
   void
@@ -2078,7 +2305,14 @@ class Sized_incr_dynobj : public Dynobj
   // Return the last modified time of the file.
   Timespec
   do_get_mtime()
-  { return this->input_reader_.get_mtime(); }
+  {
+    return this->ibase_->get_input_reader(this->input_file_index_)->get_mtime();
+  }
+
+  // Return the hash of the file contents recorded by the last link.
+  uint64_t
+  do_get_content_hash()
+  { return this->input_reader_.get_content_hash(); }
 
   // Read the symbols.
   void
@@ -2191,7 +2425,7 @@ class Incremental_library : public Library_base
 		      const Incremental_binary::Input_reader* input_reader)
     : Library_base(NULL), filename_(filename),
       input_file_index_(input_file_index), input_reader_(input_reader),
-      unused_symbols_(), is_reported_(false)
+      unused_symbols_(), member_info_(), is_reported_(false)
   { }
 
   // Return the input file index.
@@ -2211,6 +2445,12 @@ class Incremental_library : public Library_base
   void
   copy_unused_symbols();
 
+  // Record the location and contents hash of the member OBJ, which is
+  // kept from the previous link.
+  void
+  set_member_info(Object* obj, const Incremental_member_info& info)
+  { this->member_info_[obj] = info; }
+
   // Return FALSE on the first call to indicate that the library needs
   // to be recorded; return TRUE subsequently.
   bool
@@ -2234,10 +2474,19 @@ class Incremental_library : public Library_base
   do_get_mtime()
   { return this->input_reader_->get_mtime(); }
 
+  // Return the hash of the archive contents recorded by the last link.
+  uint64_t
+  do_get_content_hash()
+  { return this->input_reader_->get_content_hash(); }
+
   // Iterator for unused global symbols in the library.
   void
   do_for_all_unused_symbols(Symbol_visitor_base* v) const;
 
+  // The location and contents hash of a member.
+  bool
+  do_get_member_info(Object* obj, Incremental_member_info* info);
+
   // The name of the library.
   std::string filename_;
   // The input file index of this library.
@@ -2246,6 +2495,9 @@ class Incremental_library : public Library_base
   const Incremental_binary::Input_reader* input_reader_;
   // List of unused symbols defined in this library.
   Symbol_list unused_symbols_;
+  // The location and contents hash of each member kept from the
+  // previous link.
+  std::map<Object*, Incremental_member_info> member_info_;
   // TRUE when this library has been reported to the new incremental info.
   bool is_reported_;
 };
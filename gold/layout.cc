@@ -53,6 +53,7 @@
 #include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "hash.h"
 #include "layout.h"
 
 namespace gold
@@ -81,22 +82,189 @@ unsigned int Free_list::num_allocate_visits = 0;
 void
 Free_list::init(off_t len, bool extend)
 {
-  this->list_.push_front(Free_list_node(0, len));
-  this->last_remove_ = this->list_.begin();
+  this->insert_node(0, len);
   this->extend_ = extend;
   this->length_ = len;
   ++Free_list::num_lists;
   ++Free_list::num_nodes;
 }
 
+// Recompute the length of the longest chunk in the subtree T.
+
+void
+Free_list::update(Free_list_node* t)
+{
+  off_t len = t->end_ - t->start_;
+  len = std::max(len, Free_list::max_length(t->left_));
+  len = std::max(len, Free_list::max_length(t->right_));
+  t->max_length_ = len;
+}
+
+// Split the subtree T into the nodes which start before KEY and the
+// others.
+
+void
+Free_list::split(Free_list_node* t, off_t key, Free_list_node** pleft,
+		 Free_list_node** pright)
+{
+  if (t == NULL)
+    {
+      *pleft = NULL;
+      *pright = NULL;
+    }
+  else if (t->start_ < key)
+    {
+      Free_list::split(t->right_, key, &t->right_, pright);
+      Free_list::update(t);
+      *pleft = t;
+    }
+  else
+    {
+      Free_list::split(t->left_, key, pleft, &t->left_);
+      Free_list::update(t);
+      *pright = t;
+    }
+}
+
+// Merge the subtrees LEFT and RIGHT, keeping the node with the higher
+// priority on top.
+
+Free_list::Free_list_node*
+Free_list::merge(Free_list_node* left, Free_list_node* right)
+{
+  if (left == NULL)
+    return right;
+  if (right == NULL)
+    return left;
+  if (left->priority_ >= right->priority_)
+    {
+      left->right_ = Free_list::merge(left->right_, right);
+      Free_list::update(left);
+      return left;
+    }
+  else
+    {
+      right->left_ = Free_list::merge(left, right->left_);
+      Free_list::update(right);
+      return right;
+    }
+}
+
+// Delete the subtree T.
+
+void
+Free_list::delete_tree(Free_list_node* t)
+{
+  if (t == NULL)
+    return;
+  Free_list::delete_tree(t->left_);
+  Free_list::delete_tree(t->right_);
+  delete t;
+}
+
+// Add a chunk from START to END.  The priorities come from a simple
+// xorshift generator; they only need to look random to keep the
+// treap balanced.
+
+void
+Free_list::insert_node(off_t start, off_t end)
+{
+  unsigned int x = this->priority_seed_;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  this->priority_seed_ = x;
+
+  Free_list_node* node = new Free_list_node(start, end, x);
+  Free_list_node* left;
+  Free_list_node* right;
+  Free_list::split(this->root_, start, &left, &right);
+  this->root_ = Free_list::merge(Free_list::merge(left, node), right);
+}
+
+// Remove the chunk which starts at START.
+
+void
+Free_list::erase_node(off_t start)
+{
+  Free_list_node* left;
+  Free_list_node* middle;
+  Free_list_node* right;
+  Free_list::split(this->root_, start, &left, &right);
+  Free_list::split(right, start + 1, &middle, &right);
+  gold_assert(middle != NULL
+	      && middle->left_ == NULL
+	      && middle->right_ == NULL);
+  delete middle;
+  this->root_ = Free_list::merge(left, right);
+}
+
+// Return the first chunk.
+
+Free_list::Const_iterator
+Free_list::begin() const
+{
+  const Free_list_node* t = this->root_;
+  if (t != NULL)
+    while (t->left_ != NULL)
+      t = t->left_;
+  return Const_iterator(this, t);
+}
+
+// Return the chunk which follows NODE, or NULL.
+
+const Free_list::Free_list_node*
+Free_list::next_node(const Free_list_node* node) const
+{
+  const Free_list_node* ret = NULL;
+  const Free_list_node* t = this->root_;
+  while (t != NULL)
+    {
+      if (t->start_ > node->start_)
+	{
+	  ret = t;
+	  t = t->left_;
+	}
+      else
+	t = t->right_;
+    }
+  return ret;
+}
+
+// Remove START to END from the chunk NODE.  Add some fuzz to avoid
+// creating tiny free chunks.
+
+void
+Free_list::carve(Free_list_node* node, off_t start, off_t end, off_t fuzz)
+{
+  off_t node_start = node->start_;
+  off_t node_end = node->end_;
+  this->erase_node(node_start);
+
+  // Case 1: the indicated region spans the whole node.
+  if (node_start + fuzz >= start && node_end <= end + fuzz)
+    ;
+  // Case 2: remove a chunk from the start of the node.
+  else if (node_start + fuzz >= start)
+    this->insert_node(end, node_end);
+  // Case 3: remove a chunk from the end of the node.
+  else if (node_end <= end + fuzz)
+    this->insert_node(node_start, start);
+  // Case 4: remove a chunk from the middle, and split the node into
+  // two.
+  else
+    {
+      this->insert_node(node_start, start);
+      this->insert_node(end, node_end);
+      ++Free_list::num_nodes;
+    }
+}
+
 // Remove a chunk from the free list.  Because we start with a single
 // node that covers the entire section, and remove chunks from it one
 // at a time, we do not need to coalesce chunks or handle cases that
-// span more than one free node.  We expect to remove chunks from the
-// free list in order, and we expect to have only a few chunks of free
-// space left (corresponding to files that have changed since the last
-// incremental link), so a simple linear list should provide sufficient
-// performance.
+// span more than one free node.  The only chunk which can contain the
+// region is the last one which starts at or before START.
 
 void
 Free_list::remove(off_t start, off_t end)
@@ -107,38 +275,24 @@ Free_list::remove(off_t start, off_t end)
 
   ++Free_list::num_removes;
 
-  Iterator p = this->last_remove_;
-  if (p->start_ > start)
-    p = this->list_.begin();
-
-  for (; p != this->list_.end(); ++p)
+  Free_list_node* p = NULL;
+  for (Free_list_node* t = this->root_; t != NULL; )
     {
       ++Free_list::num_remove_visits;
-      // Find a node that wholly contains the indicated region.
-      if (p->start_ <= start && p->end_ >= end)
+      if (t->start_ <= start)
 	{
-	  // Case 1: the indicated region spans the whole node.
-	  // Add some fuzz to avoid creating tiny free chunks.
-	  if (p->start_ + 3 >= start && p->end_ <= end + 3)
-	    p = this->list_.erase(p);
-	  // Case 2: remove a chunk from the start of the node.
-	  else if (p->start_ + 3 >= start)
-	    p->start_ = end;
-	  // Case 3: remove a chunk from the end of the node.
-	  else if (p->end_ <= end + 3)
-	    p->end_ = start;
-	  // Case 4: remove a chunk from the middle, and split
-	  // the node into two.
-	  else
-	    {
-	      Free_list_node newnode(p->start_, start);
-	      p->start_ = end;
-	      this->list_.insert(p, newnode);
-	      ++Free_list::num_nodes;
-	    }
-	  this->last_remove_ = p;
-	  return;
+	  p = t;
+	  t = t->right_;
 	}
+      else
+	t = t->left_;
+    }
+
+  // Find a node that wholly contains the indicated region.
+  if (p != NULL && p->end_ >= end)
+    {
+      this->carve(p, start, end, 3);
+      return;
     }
 
   // Did not find a node containing the given chunk.  This could happen
@@ -148,9 +302,43 @@ Free_list::remove(off_t start, off_t end)
 	     static_cast<int>(start), static_cast<int>(end));
 }
 
+// Return the first chunk in the subtree T from which we can allocate
+// LEN bytes with alignment ALIGN at or after MINOFF, without
+// extending it.  We skip the subtrees whose chunks are all too short,
+// and the chunks which end at or before MINOFF.
+
+Free_list::Free_list_node*
+Free_list::find_fit(Free_list_node* t, off_t len, uint64_t align,
+		    off_t minoff, off_t* pstart)
+{
+  if (t == NULL || t->max_length_ < len)
+    return NULL;
+
+  // If T ends at or before MINOFF, so does everything to its left.
+  if (t->end_ > minoff)
+    {
+      Free_list_node* p = this->find_fit(t->left_, len, align, minoff,
+					 pstart);
+      if (p != NULL)
+	return p;
+
+      ++Free_list::num_allocate_visits;
+      off_t start = t->start_ > minoff ? t->start_ : minoff;
+      start = align_address(start, align);
+      off_t end = start + len;
+      if (end == t->end_ || (end <= t->end_ - this->min_hole_))
+	{
+	  *pstart = start;
+	  return t;
+	}
+    }
+
+  return this->find_fit(t->right_, len, align, minoff, pstart);
+}
+
 // Allocate a chunk of size LEN from the free list.  Returns -1ULL
 // if a sufficiently large chunk of free space is not found.
-// We use a simple first-fit algorithm.
+// We use a first-fit algorithm.
 
 off_t
 Free_list::allocate(off_t len, uint64_t align, off_t minoff)
@@ -169,35 +357,40 @@ Free_list::allocate(off_t len, uint64_t align, off_t minoff)
   // to keep track of all free chunks.
   const int fuzz = this->min_hole_ > 0 ? 0 : 3;
 
-  for (Iterator p = this->list_.begin(); p != this->list_.end(); ++p)
+  off_t start;
+  Free_list_node* p = this->find_fit(this->root_, len, align, minoff, &start);
+  if (p == NULL && this->extend_)
     {
-      ++Free_list::num_allocate_visits;
-      off_t start = p->start_ > minoff ? p->start_ : minoff;
-      start = align_address(start, align);
-      off_t end = start + len;
-      if (end > p->end_ && p->end_ == this->length_ && this->extend_)
+      // We may be able to grow the last chunk, if it reaches the end.
+      Free_list_node* last = this->root_;
+      if (last != NULL)
+	while (last->right_ != NULL)
+	  last = last->right_;
+      if (last != NULL && last->end_ == this->length_)
 	{
-	  this->length_ = end;
-	  p->end_ = end;
-	}
-      if (end == p->end_ || (end <= p->end_ - this->min_hole_))
-	{
-	  if (p->start_ + fuzz >= start && p->end_ <= end + fuzz)
-	    this->list_.erase(p);
-	  else if (p->start_ + fuzz >= start)
-	    p->start_ = end;
-	  else if (p->end_ <= end + fuzz)
-	    p->end_ = start;
-	  else
+	  ++Free_list::num_allocate_visits;
+	  start = last->start_ > minoff ? last->start_ : minoff;
+	  start = align_address(start, align);
+	  off_t end = start + len;
+	  if (end > last->end_)
 	    {
-	      Free_list_node newnode(p->start_, start);
-	      p->start_ = end;
-	      this->list_.insert(p, newnode);
-	      ++Free_list::num_nodes;
+	      off_t last_start = last->start_;
+	      this->erase_node(last_start);
+	      this->insert_node(last_start, end);
+	      this->length_ = end;
+	      p = this->root_;
+	      while (p->right_ != NULL)
+		p = p->right_;
 	    }
-	  return start;
 	}
     }
+
+  if (p != NULL)
+    {
+      this->carve(p, start, start + len, fuzz);
+      return start;
+    }
+
   if (this->extend_)
     {
       off_t start = align_address(this->length_, align);
@@ -212,7 +405,7 @@ void
 Free_list::dump()
 {
   gold_info("Free list:\n     start      end   length\n");
-  for (Iterator p = this->list_.begin(); p != this->list_.end(); ++p)
+  for (Const_iterator p = this->begin(); p != this->end(); ++p)
     gold_info("  %08lx %08lx %08lx", static_cast<long>(p->start_),
 	      static_cast<long>(p->end_),
 	      static_cast<long>(p->end_ - p->start_));
@@ -236,25 +429,36 @@ Free_list::print_stats()
 	  program_name, Free_list::num_allocate_visits);
 }
 
-// A Hash_task computes the MD5 checksum of an array of char.
+// The hash used for each chunk of a --build-id=tree build ID.
+
+static void
+md5_hash_buffer(const unsigned char* src, size_t size, unsigned char* dst)
+{ md5_buffer(reinterpret_cast<const char*>(src), size, dst); }
+
+// A Hash_task computes the checksum of an array of char, using MD5
+// for --build-id=tree or fast_hash_buffer for --build-id=fast.
 // It has a blocker on either side (i.e., the task cannot run until
 // the first is unblocked, and it unblocks the second after running).
 
 class Hash_task : public Task
 {
  public:
-  Hash_task(const unsigned char* src,
+  typedef void (*Hash_function)(const unsigned char*, size_t,
+				unsigned char*);
+
+  Hash_task(Hash_function hash_function,
+	    const unsigned char* src,
 	    size_t size,
 	    unsigned char* dst,
 	    Task_token* build_id_blocker,
 	    Task_token* final_blocker)
-    : src_(src), size_(size), dst_(dst), build_id_blocker_(build_id_blocker),
-      final_blocker_(final_blocker)
+    : hash_function_(hash_function), src_(src), size_(size), dst_(dst),
+      build_id_blocker_(build_id_blocker), final_blocker_(final_blocker)
   { }
 
   void
   run(Workqueue*)
-  { md5_buffer(reinterpret_cast<const char*>(src_), size_, dst_); }
+  { this->hash_function_(this->src_, this->size_, this->dst_); }
 
   Task_token*
   is_runnable();
@@ -269,6 +473,7 @@ class Hash_task : public Task
   { return "Hash_task"; }
 
  private:
+  const Hash_function hash_function_;
   const unsigned char* const src_;
   const size_t size_;
   unsigned char* const dst_;
@@ -279,11 +484,342 @@ class Hash_task : public Task
 Task_token*
 Hash_task::is_runnable()
 {
-  if (this->build_id_blocker_->is_blocked())
+  if (this->build_id_blocker_ != NULL && this->build_id_blocker_->is_blocked())
     return this->build_id_blocker_;
   return NULL;
 }
 
+// A Hash_chunk_queuer queues a Hash_task for each chunk of the output
+// file as soon as all of the chunk has been written, so that hashing
+// the file for a tree-style build ID overlaps with writing it.
+
+class Hash_chunk_queuer : public Output_file::Range_listener
+{
+ public:
+  Hash_chunk_queuer(Hash_task::Hash_function hash_function,
+		    Output_file* of, const unsigned char* src,
+		    size_t filesize, size_t chunk_size, unsigned char* dst,
+		    size_t hash_size, Task_token* post_hash_tasks_blocker)
+    : hash_function_(hash_function), of_(of), src_(src),
+      filesize_(filesize), chunk_size_(chunk_size), dst_(dst),
+      hash_size_(hash_size),
+      post_hash_tasks_blocker_(post_hash_tasks_blocker),
+      queued_((filesize - 1) / chunk_size + 1, false), lock_()
+  { }
+
+  void
+  range_finished(Workqueue*, off_t start, off_t len);
+
+ private:
+  const Hash_task::Hash_function hash_function_;
+  Output_file* const of_;
+  const unsigned char* const src_;
+  const size_t filesize_;
+  const size_t chunk_size_;
+  unsigned char* const dst_;
+  const size_t hash_size_;
+  Task_token* const post_hash_tasks_blocker_;
+  // Whether a Hash_task has been queued for each chunk.
+  std::vector<bool> queued_;
+  // Lock for queued_.
+  Lock lock_;
+};
+
+// Queue a Hash_task for each chunk touching the LEN bytes at START
+// which is now complete.
+
+void
+Hash_chunk_queuer::range_finished(Workqueue* workqueue, off_t start,
+				  off_t len)
+{
+  const size_t first = static_cast<size_t>(start) / this->chunk_size_;
+  const size_t last = std::min(((static_cast<size_t>(start + len) - 1)
+				/ this->chunk_size_),
+			       this->queued_.size() - 1);
+  Hold_lock hl(this->lock_);
+  for (size_t i = first; i <= last; ++i)
+    {
+      if (this->queued_[i])
+	continue;
+      const size_t offset = i * this->chunk_size_;
+      const size_t size = std::min(this->chunk_size_,
+				   this->filesize_ - offset);
+      if (!this->of_->is_range_finished(offset, size))
+	continue;
+      this->queued_[i] = true;
+      workqueue->queue(new Hash_task(this->hash_function_,
+				     this->src_ + offset,
+				     size,
+				     this->dst_ + i * this->hash_size_,
+				     NULL,
+				     this->post_hash_tasks_blocker_));
+    }
+}
+
+// A Gap_finisher reports each gap between the parts of the output
+// file which are written, such as the padding between sections, once
+// the parts on both sides of it are finished.  No task writes to the
+// gaps, which are left as zeroes: any fill a section needs is within
+// its data size.  Waiting for the neighbouring parts means that a gap
+// is never hashed or written out before a task which could reach into
+// it has finished.
+
+class Gap_finisher : public Output_file::Range_listener
+{
+ public:
+  Gap_finisher(Output_file* of, off_t filesize)
+    : of_(of), filesize_(filesize), gaps_()
+  { }
+
+  // Add the gap from START to END.  This is thread-unsafe, and is
+  // only used before the listener is added to the output file.
+  void
+  add_gap(off_t start, off_t end)
+  { this->gaps_[start] = end; }
+
+  void
+  range_finished(Workqueue*, off_t start, off_t len);
+
+ private:
+  // Return whether the byte at OFF, which is next to a gap, is
+  // finished.  The ends of the file count as finished.
+  bool
+  is_finished(off_t off)
+  {
+    return (off < 0
+	    || off >= this->filesize_
+	    || this->of_->is_range_finished(off, 1));
+  }
+
+  Output_file* const of_;
+  const off_t filesize_;
+  // Map from the start of each gap to its end.
+  std::map<off_t, off_t> gaps_;
+};
+
+// Report the gaps next to the LEN bytes at START whose other side is
+// also finished.  If both sides of a gap are finished at the same
+// time, the threads may both report it, which is harmless.
+
+void
+Gap_finisher::range_finished(Workqueue* workqueue, off_t start, off_t len)
+{
+  std::map<off_t, off_t>::const_iterator p = this->gaps_.upper_bound(start);
+  if (p != this->gaps_.begin())
+    --p;
+  for (; p != this->gaps_.end() && p->first <= start + len; ++p)
+    {
+      if (p->second < start)
+	continue;
+      if (this->is_finished(p->first - 1) && this->is_finished(p->second))
+	this->of_->finish_range(workqueue, p->first, p->second - p->first);
+    }
+}
+
+// A Hash_remaining_chunks_task runs after everything has been written
+// to the output file.  It tells the Hash_chunk_queuer that the whole
+// file is complete, so that it queues the chunks which were not
+// covered by a finished section, such as the symbol tables.  Then it
+// frees the counts of the tasks writing each section, which are no
+// longer needed.
+
+class Hash_remaining_chunks_task : public Task
+{
+ public:
+  Hash_remaining_chunks_task(Layout* layout, Output_file* of, off_t filesize,
+			     Task_token* build_id_blocker,
+			     Task_token* post_hash_tasks_blocker)
+    : layout_(layout), of_(of), filesize_(filesize),
+      build_id_blocker_(build_id_blocker),
+      post_hash_tasks_blocker_(post_hash_tasks_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->build_id_blocker_->is_blocked())
+      return this->build_id_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->post_hash_tasks_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    this->of_->finish_range(workqueue, 0, this->filesize_);
+    this->layout_->free_section_writers();
+  }
+
+  std::string
+  get_name() const
+  { return "Hash_remaining_chunks_task"; }
+
+ private:
+  Layout* const layout_;
+  Output_file* const of_;
+  const off_t filesize_;
+  Task_token* const build_id_blocker_;
+  Task_token* const post_hash_tasks_blocker_;
+};
+
+// A Queue_hash_tasks_task queues the tasks which hash the chunks of
+// the output file for a tree-style build ID once the output file has
+// its final size.  This is used when there are sections which need
+// postprocessing, as Write_after_input_sections_task may resize the
+// file.
+
+class Queue_hash_tasks_task : public Task
+{
+ public:
+  Queue_hash_tasks_task(Layout* layout, Output_file* of,
+			Task_token* build_id_blocker,
+			Task_token* post_hash_tasks_blocker)
+    : layout_(layout), of_(of), build_id_blocker_(build_id_blocker),
+      post_hash_tasks_blocker_(post_hash_tasks_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->build_id_blocker_->is_blocked())
+      return this->build_id_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->post_hash_tasks_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    this->layout_->queue_hash_tasks(workqueue, NULL, NULL, this->of_,
+				    this->post_hash_tasks_blocker_);
+  }
+
+  std::string
+  get_name() const
+  { return "Queue_hash_tasks_task"; }
+
+ private:
+  Layout* const layout_;
+  Output_file* const of_;
+  Task_token* const build_id_blocker_;
+  Task_token* const post_hash_tasks_blocker_;
+};
+
+// Layout::Section_writers.
+
+// This counts the tasks which may still write to each output section
+// whose contents we track.  When the count for a section drops to
+// zero, the section is reported to Output_file::finish_range.  Every
+// section starts with one writer for the Layout task which writes it,
+// plus one for each Relocate_task of an object with an input section
+// mapped to it.
+
+class Layout::Section_writers
+{
+ public:
+  Section_writers()
+    : lock_(), writers_()
+  { }
+
+  // Track OS, which has one writer.
+  void
+  add_section(const Output_section* os)
+  { this->writers_[os] = 1; }
+
+  // Add a writer for each tracked section in SECTIONS.  This is
+  // thread-unsafe, and is only used before the writers are queued.
+  void
+  add_writer(const std::vector<const Output_section*>& sections);
+
+  // Remove a writer from each tracked section in SECTIONS, and report
+  // the sections which are now complete to OF.
+  void
+  remove_writer(Workqueue*, const std::vector<const Output_section*>& sections,
+		Output_file* of);
+
+  // Put the distinct output sections used by RELOBJ into SECTIONS.
+  static void
+  relobj_sections(const Relobj* relobj,
+		  std::vector<const Output_section*>* sections);
+
+ private:
+  typedef Unordered_map<const Output_section*, int> Writer_counts;
+
+  // Lock for writers_.
+  Lock lock_;
+  // The number of writers left for each tracked section.
+  Writer_counts writers_;
+};
+
+void
+Layout::Section_writers::add_writer(
+    const std::vector<const Output_section*>& sections)
+{
+  for (std::vector<const Output_section*>::const_iterator p =
+	 sections.begin();
+       p != sections.end();
+       ++p)
+    {
+      Writer_counts::iterator pw = this->writers_.find(*p);
+      if (pw != this->writers_.end())
+	++pw->second;
+    }
+}
+
+void
+Layout::Section_writers::remove_writer(
+    Workqueue* workqueue,
+    const std::vector<const Output_section*>& sections,
+    Output_file* of)
+{
+  std::vector<const Output_section*> finished;
+  {
+    Hold_lock hl(this->lock_);
+    for (std::vector<const Output_section*>::const_iterator p =
+	   sections.begin();
+	 p != sections.end();
+	 ++p)
+      {
+	Writer_counts::iterator pw = this->writers_.find(*p);
+	if (pw != this->writers_.end())
+	  {
+	    gold_assert(pw->second > 0);
+	    if (--pw->second == 0)
+	      finished.push_back(*p);
+	  }
+      }
+  }
+
+  for (std::vector<const Output_section*>::const_iterator p =
+	 finished.begin();
+       p != finished.end();
+       ++p)
+    of->finish_range(workqueue, (*p)->offset(), (*p)->data_size());
+}
+
+void
+Layout::Section_writers::relobj_sections(
+    const Relobj* relobj,
+    std::vector<const Output_section*>* sections)
+{
+  const unsigned int shnum = relobj->shnum();
+  for (unsigned int i = 1; i < shnum; ++i)
+    {
+      const Output_section* os = relobj->output_section(i);
+      if (os != NULL)
+	sections->push_back(os);
+    }
+  std::sort(sections->begin(), sections->end());
+  sections->erase(std::unique(sections->begin(), sections->end()),
+		  sections->end());
+}
+
 // Layout::Relaxation_debug_check methods.
 
 // Check that sections and special data are in reset states.
@@ -369,7 +905,7 @@ void
 Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 {
   // See if any of the input definitions violate the One Definition Rule.
-  // TODO: if this is too slow, do this as a task, rather than inline.
+  // With threads, the line numbers have already been read by tasks.
   this->symtab_->detect_odr_violations(task, this->options_.output_file_name());
 
   Layout* layout = this->layout_;
@@ -453,8 +989,10 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     array_of_hashes_(NULL),
     size_of_array_of_hashes_(0),
     input_view_(NULL),
+    section_writers_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
+    compressed_sections_(),
     group_signatures_(),
     output_file_size_(-1),
     have_added_input_section_(false),
@@ -1609,8 +2147,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* ocs =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_sections_.push_back(ocs);
+      os = ocs;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -2185,6 +2728,26 @@ Layout::define_section_symbols(Symbol_table* symtab)
     }
 }
 
+// Add the tasks for the merge sections in all output sections.
+
+void
+Layout::add_merge_tasks(Task_token* blocker, std::vector<Task*>* tasks)
+{
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->add_merge_tasks(blocker, tasks);
+}
+
+// Add the tasks which scan the DWARF info for the .gdb_index section.
+
+void
+Layout::add_gdb_index_tasks(Task_token* blocker, std::vector<Task*>* tasks)
+{
+  if (this->gdb_index_data_ != NULL)
+    this->gdb_index_data_->add_scan_tasks(blocker, tasks);
+}
+
 // Define symbols for group signatures.
 
 void
@@ -3008,7 +3571,7 @@ Layout::create_build_id()
   // set DESC to the note descriptor contents.
   size_t descsz;
   std::string desc;
-  if (strcmp(style, "md5") == 0)
+  if (strcmp(style, "md5") == 0 || strcmp(style, "fast") == 0)
     descsz = 128 / 8;
   else if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
     descsz = 160 / 8;
@@ -5341,45 +5904,295 @@ Layout::write_sections_after_input_sections(Output_file* of)
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
+// --build-id=fast always uses a tree, with fast_hash_buffer for both the
+// chunks and the string of hashes; its chunks do not depend on the
+// file size, so the result does not depend on the thread count.
 // We compute a checksum over the entire file because that is simplest.
 
 Task_token*
 Layout::queue_build_id_tasks(Workqueue* workqueue, Task_token* build_id_blocker,
+			     const Input_objects* input_objects,
 			     Output_file* of)
+{
+  if (this->build_id_note_ == NULL
+      || parameters->options().build_id_chunk_size_for_treehash() == 0)
+    return build_id_blocker;
+
+  const char* style = parameters->options().build_id();
+  if (strcmp(style, "fast") != 0 && strcmp(style, "tree") != 0)
+    return build_id_blocker;
+
+  Task_token* post_hash_tasks_blocker = new Task_token(true);
+
+  // Write_after_input_sections_task may still resize the output file,
+  // which can also move its mapping, so we can't look at the file
+  // until BUILD_ID_BLOCKER is unblocked.
+  if (input_objects == NULL)
+    {
+      post_hash_tasks_blocker->add_blocker();
+      workqueue->queue(new Queue_hash_tasks_task(this, of, build_id_blocker,
+						 post_hash_tasks_blocker));
+      return post_hash_tasks_blocker;
+    }
+
+  if (!this->queue_hash_tasks(workqueue, build_id_blocker, input_objects, of,
+			      post_hash_tasks_blocker))
+    {
+      delete post_hash_tasks_blocker;
+      return build_id_blocker;
+    }
+  return post_hash_tasks_blocker;
+}
+
+// Queue the tasks which hash the chunks of the output file for a
+// tree-style build ID, adding a blocker to POST_HASH_TASKS_BLOCKER for
+// each of them.  Return false if the file is too small to be split
+// into chunks, in which case write_build_id hashes the whole file.
+
+bool
+Layout::queue_hash_tasks(Workqueue* workqueue, Task_token* build_id_blocker,
+			 const Input_objects* input_objects, Output_file* of,
+			 Task_token* post_hash_tasks_blocker)
 {
   const size_t filesize = (this->output_file_size() <= 0 ? 0
 			   : static_cast<size_t>(this->output_file_size()));
-  if (this->build_id_note_ != NULL
-      && strcmp(parameters->options().build_id(), "tree") == 0
-      && parameters->options().build_id_chunk_size_for_treehash() > 0
-      && filesize > 0
-      && (filesize >=
-	  parameters->options().build_id_min_file_size_for_treehash()))
-    {
-      static const size_t MD5_OUTPUT_SIZE_IN_BYTES = 16;
-      const size_t chunk_size =
-	  parameters->options().build_id_chunk_size_for_treehash();
-      const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
-      Task_token* post_hash_tasks_blocker = new Task_token(true);
-      post_hash_tasks_blocker->add_blockers(num_hashes);
-      this->size_of_array_of_hashes_ = num_hashes * MD5_OUTPUT_SIZE_IN_BYTES;
-      const unsigned char* src = of->get_input_view(0, filesize);
-      this->input_view_ = src;
-      unsigned char *dst = new unsigned char[this->size_of_array_of_hashes_];
-      this->array_of_hashes_ = dst;
-      for (size_t i = 0, src_offset = 0; i < num_hashes;
-	   i++, dst += MD5_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
-	{
-	  size_t size = std::min(chunk_size, filesize - src_offset);
-	  workqueue->queue(new Hash_task(src + src_offset,
-					 size,
-					 dst,
-					 build_id_blocker,
-					 post_hash_tasks_blocker));
-	}
-      return post_hash_tasks_blocker;
+  if (filesize == 0)
+    return false;
+
+  Hash_task::Hash_function hash_function;
+  if (strcmp(parameters->options().build_id(), "fast") == 0)
+    hash_function = fast_hash_buffer;
+  else if (filesize
+	   >= parameters->options().build_id_min_file_size_for_treehash())
+    hash_function = md5_hash_buffer;
+  else
+    return false;
+
+  // Both MD5 and fast_hash_buffer produce 16 bytes.
+  static const size_t HASH_OUTPUT_SIZE_IN_BYTES = 16;
+  const size_t chunk_size =
+      parameters->options().build_id_chunk_size_for_treehash();
+  const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
+  post_hash_tasks_blocker->add_blockers(num_hashes);
+  this->size_of_array_of_hashes_ = num_hashes * HASH_OUTPUT_SIZE_IN_BYTES;
+  const unsigned char* src = of->get_input_view(0, filesize);
+  this->input_view_ = src;
+  unsigned char *dst = new unsigned char[this->size_of_array_of_hashes_];
+  this->array_of_hashes_ = dst;
+
+  // If nothing has been written yet, hash each chunk as soon as the
+  // sections covering it are complete, and let BUILD_ID_BLOCKER only
+  // hold back the chunks which are left over.  Incremental links
+  // update an existing file, and -r and --emit-relocs write reloc
+  // sections from the Relocate_tasks, so for those we simply wait
+  // for the whole file.
+  if (input_objects != NULL
+      && !parameters->incremental()
+      && !parameters->options().relocatable()
+      && !parameters->options().emit_relocs())
+    {
+      post_hash_tasks_blocker->add_blocker();
+      of->add_range_listener(new Hash_chunk_queuer(hash_function, of, src,
+						   filesize, chunk_size, dst,
+						   HASH_OUTPUT_SIZE_IN_BYTES,
+						   post_hash_tasks_blocker));
+      this->track_section_writers(input_objects, of);
+      workqueue->queue(new Hash_remaining_chunks_task(this, of, filesize,
+						      build_id_blocker,
+						      post_hash_tasks_blocker));
+      return true;
     }
-  return build_id_blocker;
+
+  for (size_t i = 0, src_offset = 0; i < num_hashes;
+       i++, dst += HASH_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
+    {
+      size_t size = std::min(chunk_size, filesize - src_offset);
+      workqueue->queue(new Hash_task(hash_function,
+				     src + src_offset,
+				     size,
+				     dst,
+				     build_id_blocker,
+				     post_hash_tasks_blocker));
+    }
+  return true;
+}
+
+// Set up section_writers_ to count the tasks which will write each
+// output section, so that the sections can be reported to OF as they
+// are completed.  The symbol tables are written by several kinds of
+// task, so they are not tracked, and are only finished when the
+// whole file is.
+
+void
+Layout::track_section_writers(const Input_objects* input_objects,
+			      Output_file* of)
+{
+  Section_writers* section_writers = new Section_writers();
+
+  // The start and end of each part of the file which is written.
+  std::vector<std::pair<off_t, off_t> > written;
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    {
+      const Output_section* os = *p;
+      if (os->type() == elfcpp::SHT_NOBITS
+	  || !os->is_offset_valid()
+	  || os->data_size() == 0)
+	continue;
+      written.push_back(std::make_pair(os->offset(),
+				       os->offset() + os->data_size()));
+      if (os->type() != elfcpp::SHT_SYMTAB
+	  && os->type() != elfcpp::SHT_DYNSYM
+	  && os->type() != elfcpp::SHT_SYMTAB_SHNDX)
+	section_writers->add_section(os);
+    }
+
+  std::vector<const Output_data*> data;
+  data.insert(data.end(), this->special_output_list_.begin(),
+	      this->special_output_list_.end());
+  data.insert(data.end(), this->relax_output_list_.begin(),
+	      this->relax_output_list_.end());
+  if (this->section_headers_ != NULL)
+    data.push_back(this->section_headers_);
+  for (std::vector<const Output_data*>::const_iterator p = data.begin();
+       p != data.end();
+       ++p)
+    if ((*p)->is_offset_valid() && (*p)->data_size() > 0)
+      written.push_back(std::make_pair((*p)->offset(),
+				       (*p)->offset() + (*p)->data_size()));
+
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    {
+      std::vector<const Output_section*> sections;
+      Section_writers::relobj_sections(*p, &sections);
+      section_writers->add_writer(sections);
+    }
+
+  this->section_writers_ = section_writers;
+
+  // Report the gaps between the parts which are written once their
+  // neighbours are done.
+  Gap_finisher* gap_finisher = new Gap_finisher(of, this->output_file_size_);
+  std::sort(written.begin(), written.end());
+  off_t off = 0;
+  for (std::vector<std::pair<off_t, off_t> >::const_iterator p =
+	 written.begin();
+       p != written.end();
+       ++p)
+    {
+      if (p->first > off)
+	gap_finisher->add_gap(off, p->first);
+      off = std::max(off, p->second);
+    }
+  if (off < this->output_file_size_)
+    gap_finisher->add_gap(off, this->output_file_size_);
+  of->add_range_listener(gap_finisher);
+}
+
+// Free the counts used by track_section_writers.
+
+void
+Layout::free_section_writers()
+{
+  delete this->section_writers_;
+  this->section_writers_ = NULL;
+}
+
+// Report the output sections which are complete now that the
+// Relocate_task for RELOBJ has finished.
+
+void
+Layout::finish_relobj_sections(Workqueue* workqueue, const Relobj* relobj,
+			       Output_file* of) const
+{
+  if (this->section_writers_ == NULL)
+    return;
+  std::vector<const Output_section*> sections;
+  Section_writers::relobj_sections(relobj, &sections);
+  this->section_writers_->remove_writer(workqueue, sections, of);
+}
+
+// Report the output sections which are complete now that the Layout
+// task writing the sections which are (or, if AFTER_INPUT_SECTIONS is
+// false, are not) written after the input sections has finished.
+// The section headers are written with the former.
+
+void
+Layout::finish_output_sections(Workqueue* workqueue,
+			       bool after_input_sections,
+			       Output_file* of) const
+{
+  if (this->section_writers_ == NULL)
+    return;
+  std::vector<const Output_section*> sections;
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    if ((*p)->after_input_sections() == after_input_sections)
+      sections.push_back(*p);
+  this->section_writers_->remove_writer(workqueue, sections, of);
+
+  if (after_input_sections && this->section_headers_ != NULL)
+    of->finish_range(workqueue, this->section_headers_->offset(),
+		     this->section_headers_->data_size());
+}
+
+// Report the data which is not in a section as complete once
+// Write_data_task has written it.
+
+void
+Layout::finish_data(Workqueue* workqueue, Output_file* of) const
+{
+  if (this->section_writers_ == NULL)
+    return;
+  for (Data_list::const_iterator p = this->special_output_list_.begin();
+       p != this->special_output_list_.end();
+       ++p)
+    of->finish_range(workqueue, (*p)->offset(), (*p)->data_size());
+  for (Data_list::const_iterator p = this->relax_output_list_.begin();
+       p != this->relax_output_list_.end();
+       ++p)
+    of->finish_range(workqueue, (*p)->offset(), (*p)->data_size());
+}
+
+// Compressing a large debug section can take much longer than
+// writing it, so when using threads we compress each section in
+// pieces in parallel before Write_after_input_sections_task sets the
+// final section sizes.
+
+Task_token*
+Layout::queue_compress_tasks(Workqueue* workqueue,
+			     Task_token* compress_blocker)
+{
+  bool use_threads = false;
+#ifdef ENABLE_THREADS
+  use_threads = parameters->options().threads();
+#endif
+  if (!use_threads || this->compressed_sections_.empty())
+    return compress_blocker;
+
+  // Add all the blockers before queuing any task that might release
+  // one.
+  Task_token* post_compress_tasks_blocker = new Task_token(true);
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    if ((*p)->has_postprocessing_buffer())
+      post_compress_tasks_blocker->add_blockers((*p)->chunk_count());
+
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    if ((*p)->has_postprocessing_buffer())
+      (*p)->queue_compress_tasks(workqueue, compress_blocker,
+				 post_compress_tasks_blocker);
+
+  return post_compress_tasks_blocker;
 }
 
 // If a tree-style build ID was requested, the parallel part of that computation
@@ -5407,6 +6220,13 @@ Layout::write_build_id(Output_file* of) const
 	sha1_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
       else if (strcmp(style, "md5") == 0)
 	md5_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+      else if (strcmp(style, "fast") == 0)
+	{
+	  // Without chunks, hash the whole file as a single chunk.
+	  unsigned char chunk_hash[fast_hash_size];
+	  fast_hash_buffer(iv, output_file_size, chunk_hash);
+	  fast_hash_buffer(chunk_hash, fast_hash_size, ov);
+	}
       else
 	gold_unreachable();
 
@@ -5415,9 +6235,14 @@ Layout::write_build_id(Output_file* of) const
   else
     {
       // Non-overlapping substrings of the output file have been hashed.
-      // Compute SHA-1 hash of the hashes.
-      sha1_buffer(reinterpret_cast<const char*>(this->array_of_hashes_),
-		  this->size_of_array_of_hashes_, ov);
+      // Compute the hash of the hashes: SHA-1 for --build-id=tree, or
+      // the same fast hash for --build-id=fast.
+      if (strcmp(parameters->options().build_id(), "fast") == 0)
+	fast_hash_buffer(this->array_of_hashes_,
+			 this->size_of_array_of_hashes_, ov);
+      else
+	sha1_buffer(reinterpret_cast<const char*>(this->array_of_hashes_),
+		    this->size_of_array_of_hashes_, ov);
       delete[] this->array_of_hashes_;
       of->free_input_view(0, this->output_file_size(), this->input_view_);
     }
@@ -5525,9 +6350,10 @@ Write_sections_task::locks(Task_locker* tl)
 // Run the task--write out the data.
 
 void
-Write_sections_task::run(Workqueue*)
+Write_sections_task::run(Workqueue* workqueue)
 {
   this->layout_->write_output_sections(this->of_);
+  this->layout_->finish_output_sections(workqueue, false, this->of_);
 }
 
 // Write_data_task methods.
@@ -5551,9 +6377,10 @@ Write_data_task::locks(Task_locker* tl)
 // Run the task--write out the data.
 
 void
-Write_data_task::run(Workqueue*)
+Write_data_task::run(Workqueue* workqueue)
 {
   this->layout_->write_data(this->symtab_, this->of_);
+  this->layout_->finish_data(workqueue, this->of_);
 }
 
 // Write_symbols_task methods.
@@ -5581,7 +6408,8 @@ Write_symbols_task::run(Workqueue*)
 {
   this->symtab_->write_globals(this->sympool_, this->dynpool_,
 			       this->layout_->symtab_xindex(),
-			       this->layout_->dynsym_xindex(), this->of_);
+			       this->layout_->dynsym_xindex(), this->of_,
+			       this->first_, this->last_);
 }
 
 // Write_after_input_sections_task methods.
@@ -5607,9 +6435,10 @@ Write_after_input_sections_task::locks(Task_locker* tl)
 // Run the task.
 
 void
-Write_after_input_sections_task::run(Workqueue*)
+Write_after_input_sections_task::run(Workqueue* workqueue)
 {
   this->layout_->write_sections_after_input_sections(this->of_);
+  this->layout_->finish_output_sections(workqueue, true, this->of_);
 }
 
 // Close_task_runner methods.
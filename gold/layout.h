@@ -58,6 +58,7 @@ class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
 class Eh_frame;
 class Gdb_index;
 class Target;
@@ -68,26 +69,76 @@ extern bool
 is_compressed_debug_section(const char* secname);
 
 // Maintain a list of free space within a section, segment, or file.
-// Used for incremental update links.
+// Used for incremental update links.  The free chunks are kept in a
+// treap ordered by offset, in which each node also records the length
+// of the longest chunk below it, so that we can find the first chunk
+// which is long enough without looking at the shorter ones.
 
 class Free_list
 {
  public:
   struct Free_list_node
   {
-    Free_list_node(off_t start, off_t end)
-      : start_(start), end_(end)
+    Free_list_node(off_t start, off_t end, unsigned int priority)
+      : start_(start), end_(end), left_(NULL), right_(NULL),
+	priority_(priority), max_length_(end - start)
     { }
     off_t start_;
     off_t end_;
+    // The chunks before and after this one in the treap.
+    Free_list_node* left_;
+    Free_list_node* right_;
+    // The treap priority; a node's priority is no lower than those of
+    // its children.
+    unsigned int priority_;
+    // The length of the longest chunk in the subtree rooted here.
+    off_t max_length_;
+  };
+
+  // An iterator over the free chunks, in order of offset.
+  class Const_iterator
+  {
+   public:
+    Const_iterator(const Free_list* list, const Free_list_node* node)
+      : list_(list), node_(node)
+    { }
+
+    const Free_list_node&
+    operator*() const
+    { return *this->node_; }
+
+    const Free_list_node*
+    operator->() const
+    { return this->node_; }
+
+    Const_iterator&
+    operator++()
+    {
+      this->node_ = this->list_->next_node(this->node_);
+      return *this;
+    }
+
+    bool
+    operator==(const Const_iterator& p) const
+    { return this->node_ == p.node_; }
+
+    bool
+    operator!=(const Const_iterator& p) const
+    { return this->node_ != p.node_; }
+
+   private:
+    const Free_list* list_;
+    const Free_list_node* node_;
   };
-  typedef std::list<Free_list_node>::const_iterator Const_iterator;
 
   Free_list()
-    : list_(), last_remove_(list_.begin()), extend_(false), length_(0),
+    : root_(NULL), priority_seed_(2463534242U), extend_(false), length_(0),
       min_hole_(0)
   { }
 
+  ~Free_list()
+  { delete_tree(this->root_); }
+
   // Initialize the free list for a section of length LEN.
   // If EXTEND is true, free space may be allocated past the end.
   void
@@ -110,13 +161,12 @@ class Free_list
 
   // Return an iterator for the beginning of the free list.
   Const_iterator
-  begin() const
-  { return this->list_.begin(); }
+  begin() const;
 
   // Return an iterator for the end of the free list.
   Const_iterator
   end() const
-  { return this->list_.end(); }
+  { return Const_iterator(this, NULL); }
 
   // Dump the free list (for debugging).
   void
@@ -127,13 +177,62 @@ class Free_list
   print_stats();
 
  private:
-  typedef std::list<Free_list_node>::iterator Iterator;
+  Free_list(const Free_list&);
+  Free_list& operator=(const Free_list&);
+
+  // Return the length of the longest chunk in the subtree T.
+  static off_t
+  max_length(const Free_list_node* t)
+  { return t == NULL ? -1 : t->max_length_; }
 
-  // The free list.
-  std::list<Free_list_node> list_;
+  // Recompute T->max_length_ from T and its children.
+  static void
+  update(Free_list_node* t);
+
+  // Split the subtree T into the nodes which start before KEY, in
+  // *PLEFT, and the others, in *PRIGHT.
+  static void
+  split(Free_list_node* t, off_t key, Free_list_node** pleft,
+	Free_list_node** pright);
 
-  // The last node visited during a remove operation.
-  Iterator last_remove_;
+  // Merge the subtrees LEFT and RIGHT, where every node in LEFT starts
+  // before every node in RIGHT.
+  static Free_list_node*
+  merge(Free_list_node* left, Free_list_node* right);
+
+  // Delete the subtree T.
+  static void
+  delete_tree(Free_list_node* t);
+
+  // Add a chunk from START to END.
+  void
+  insert_node(off_t start, off_t end);
+
+  // Remove the chunk which starts at START.
+  void
+  erase_node(off_t start);
+
+  // Return the chunk which follows NODE, or NULL.
+  const Free_list_node*
+  next_node(const Free_list_node* node) const;
+
+  // Remove START to END from the chunk NODE, dropping any remaining
+  // pieces no longer than FUZZ.
+  void
+  carve(Free_list_node* node, off_t start, off_t end, off_t fuzz);
+
+  // Return the first chunk in the subtree T from which we can
+  // allocate LEN bytes with alignment ALIGN at or after MINOFF without
+  // growing it, and set *PSTART to the offset to use.
+  Free_list_node*
+  find_fit(Free_list_node* t, off_t len, uint64_t align, off_t minoff,
+	   off_t* pstart);
+
+  // The root of the treap of free chunks.
+  Free_list_node* root_;
+
+  // The state of the generator for treap priorities.
+  unsigned int priority_seed_;
 
   // Whether we can extend past the original length.
   bool extend_;
@@ -687,6 +786,16 @@ class Layout
   void
   define_section_symbols(Symbol_table*);
 
+  // Add to TASKS the tasks which process the input sections of merge
+  // sections in parallel.  Each task will unblock BLOCKER.
+  void
+  add_merge_tasks(Task_token* blocker, std::vector<Task*>* tasks);
+
+  // Add to TASKS the tasks which scan the DWARF info for the
+  // .gdb_index section in parallel.  Each task will unblock BLOCKER.
+  void
+  add_gdb_index_tasks(Task_token* blocker, std::vector<Task*>* tasks);
+
   // Create automatic note sections.
   void
   create_notes();
@@ -894,10 +1003,59 @@ class Layout
 
   // If a treehash is necessary to compute the build ID, then queue
   // the necessary tasks and return a blocker that will unblock when
-  // they finish.  Otherwise return BUILD_ID_BLOCKER.
+  // they finish.  Otherwise return BUILD_ID_BLOCKER.  If
+  // INPUT_OBJECTS is not NULL, the output file size is final and no
+  // task which writes the file has been queued yet; in that case each
+  // chunk is hashed as soon as it has been written, and the hashing
+  // of any remaining chunks waits for BUILD_ID_BLOCKER.  If
+  // INPUT_OBJECTS is NULL, the file may be resized until
+  // BUILD_ID_BLOCKER is unblocked, so the chunks are only set up then.
   Task_token*
   queue_build_id_tasks(Workqueue* workqueue, Task_token* build_id_blocker,
-		       Output_file* of);
+		       const Input_objects* input_objects, Output_file* of);
+
+  // Queue the tasks which hash each chunk of the output file for a
+  // tree-style build ID, as described for queue_build_id_tasks, and
+  // add a blocker for each to POST_HASH_TASKS_BLOCKER.  Return false
+  // if the file is too small to use chunks.  This is called by
+  // queue_build_id_tasks, or by the task it queues to wait for the
+  // final file size.
+  bool
+  queue_hash_tasks(Workqueue* workqueue, Task_token* build_id_blocker,
+		   const Input_objects* input_objects, Output_file* of,
+		   Task_token* post_hash_tasks_blocker);
+
+  // Free the counts used by track_section_writers.  This is called
+  // by the task which hashes the remaining chunks of the file, once
+  // all of the tasks which write the output file have finished.
+  void
+  free_section_writers();
+
+  // Called by the tasks which write the output file when they are
+  // done, to report the output sections which are now complete to
+  // Output_file::finish_range.  These do nothing unless
+  // queue_build_id_tasks asked for that.  finish_relobj_sections is
+  // called by the Relocate_task for RELOBJ, finish_output_sections
+  // by Write_sections_task and (with AFTER_INPUT_SECTIONS true)
+  // Write_after_input_sections_task, and finish_data by
+  // Write_data_task.
+  void
+  finish_relobj_sections(Workqueue*, const Relobj* relobj,
+			 Output_file*) const;
+
+  void
+  finish_output_sections(Workqueue*, bool after_input_sections,
+			 Output_file*) const;
+
+  void
+  finish_data(Workqueue*, Output_file*) const;
+
+  // If there are compressed debug sections and we are using threads,
+  // queue tasks to compress them once COMPRESS_BLOCKER is unblocked,
+  // and return a blocker that will unblock when they finish.
+  // Otherwise return COMPRESS_BLOCKER.
+  Task_token*
+  queue_compress_tasks(Workqueue* workqueue, Task_token* compress_blocker);
 
   // Compute and write out the build ID if needed.
   void
@@ -1271,6 +1429,16 @@ class Layout
 
   typedef std::vector<Output_section_data*> Output_section_data_list;
 
+  // Counts of the tasks still writing each output section; defined in
+  // layout.cc.
+  class Section_writers;
+
+  // Set up section_writers_ and arrange for the parts of the file
+  // which no task writes to be reported once the parts next to them
+  // are.
+  void
+  track_section_writers(const Input_objects*, Output_file*);
+
   // Debug checker class.
   class Relaxation_debug_check
   {
@@ -1381,10 +1549,15 @@ class Layout
   size_t size_of_array_of_hashes_;
   // Input view for computing tree hash of build ID.  Freed in write_build_id().
   const unsigned char* input_view_;
+  // The tasks still writing each output section, if we are reporting
+  // finished sections to the output file.
+  Section_writers* section_writers_;
   // The output section containing dwarf abbreviations
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
   Output_reduced_debug_info_section* debug_info_;
+  // The output sections whose contents are compressed.
+  std::vector<Output_compressed_section*> compressed_sections_;
   // A list of group sections and their signatures.
   Group_signatures group_signatures_;
   // The size of the output file.
@@ -1518,7 +1691,9 @@ class Write_data_task : public Task
   Task_token* final_blocker_;
 };
 
-// This task handles writing out the global symbols.
+// This task handles writing out the global symbols numbered from
+// FIRST to LAST - 1 by Symbol_table::finalize.  Several of these
+// tasks may run in parallel for different ranges.
 
 class Write_symbols_task : public Task
 {
@@ -1526,10 +1701,11 @@ class Write_symbols_task : public Task
   Write_symbols_task(const Layout* layout, const Symbol_table* symtab,
 		     const Input_objects* /*input_objects*/,
 		     const Stringpool* sympool, const Stringpool* dynpool,
-		     Output_file* of, Task_token* final_blocker)
+		     Output_file* of, size_t first, size_t last,
+		     Task_token* final_blocker)
     : layout_(layout), symtab_(symtab),
       sympool_(sympool), dynpool_(dynpool), of_(of),
-      final_blocker_(final_blocker)
+      first_(first), last_(last), final_blocker_(final_blocker)
   { }
 
   // The standard Task methods.
@@ -1553,6 +1729,8 @@ class Write_symbols_task : public Task
   const Stringpool* sympool_;
   const Stringpool* dynpool_;
   Output_file* of_;
+  size_t first_;
+  size_t last_;
   Task_token* final_blocker_;
 };
 
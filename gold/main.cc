@@ -251,6 +251,9 @@ main(int argc, char** argv)
   // Run the main task processing loop.
   workqueue.process(0);
 
+  if (command_line.options().user_set_trace_profile())
+    workqueue.write_trace_profile();
+
   if (command_line.options().print_output_format())
     print_output_format();
 
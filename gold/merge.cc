@@ -27,6 +27,7 @@
 
 #include "merge.h"
 #include "compressed_output.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -448,6 +449,12 @@ Output_merge_data::do_add_input_section(Relobj* object, unsigned int shndx)
 
   if (is_new)
     delete[] p;
+  else
+    {
+      // The constants have been copied, so we no longer need any
+      // cached decompressed contents.
+      object->release_decompressed_section(shndx);
+    }
 
   return true;
 }
@@ -498,6 +505,61 @@ Output_merge_data::do_print_merge_stats(const char* section_name)
 
 // Class Output_merge_string.
 
+// A task to read the strings of an input section of a merged string
+// section and intern them.  These run in parallel, before the output
+// section is finalized.
+
+template<typename Char_type>
+class Output_merge_string<Char_type>::Merge_string_task : public Task
+{
+ public:
+  Merge_string_task(Output_merge_string<Char_type>* merge,
+		    Merged_strings_list* merged_strings_list,
+		    Task_token* blocker)
+    : merge_(merge), merged_strings_list_(merged_strings_list),
+      blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    Relobj* object = this->merged_strings_list_->object;
+    if (object->is_locked())
+      return object->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->merged_strings_list_->object->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->merge_->read_strings(this->merged_strings_list_);
+    this->merged_strings_list_->object->release();
+  }
+
+  std::string
+  get_name() const
+  {
+    return ("Merge_string_task "
+	    + this->merged_strings_list_->object->name());
+  }
+
+ private:
+  Output_merge_string<Char_type>* merge_;
+  Merged_strings_list* merged_strings_list_;
+  Task_token* blocker_;
+};
+
 // Add an input section to a merged string section.
 
 template<typename Char_type>
@@ -505,6 +567,63 @@ bool
 Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 						     unsigned int shndx)
 {
+  // Check the length here, rather than when reading the strings, so
+  // that we can fail even if a Merge_string_task reads them later.
+  section_size_type sec_len;
+  if (!object->section_is_compressed(shndx, &sec_len))
+    sec_len = convert_to_section_size_type(object->section_size(shndx));
+  if (sec_len % sizeof(Char_type) != 0)
+    {
+      object->error(_("mergeable string section length not multiple of "
+		      "character size"));
+      return false;
+    }
+
+  Merged_strings_list* merged_strings_list =
+      new Merged_strings_list(object, shndx);
+  this->merged_strings_lists_.push_back(merged_strings_list);
+
+  if (!this->parallel_ || this->tasks_added_)
+    this->read_strings(merged_strings_list);
+
+  // For script processing, we keep the input sections.
+  if (this->keeps_input_sections())
+    record_input_section(object, shndx);
+
+  return true;
+}
+
+// Add a Merge_string_task for each input section whose strings have
+// not been read.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_add_merge_tasks(Task_token* blocker,
+						   std::vector<Task*>* tasks)
+{
+  if (!this->parallel_ || this->tasks_added_)
+    return;
+  this->tasks_added_ = true;
+
+  for (typename Merged_strings_lists::const_iterator p =
+	 this->merged_strings_lists_.begin();
+       p != this->merged_strings_lists_.end();
+       ++p)
+    if (!(*p)->is_read)
+      tasks->push_back(new Merge_string_task(this, *p, blocker));
+}
+
+// Read the strings in an input section and add them to the pool.  The
+// object must be locked.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::read_strings(
+    Merged_strings_list* merged_strings_list)
+{
+  Relobj* object = merged_strings_list->object;
+  unsigned int shndx = merged_strings_list->shndx;
+
   section_size_type sec_len;
   bool is_new;
   const unsigned char* pdata = object->decompressed_section_contents(shndx,
@@ -515,15 +634,6 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   const Char_type* pend = p + sec_len / sizeof(Char_type);
   const Char_type* pend0 = pend;
 
-  if (sec_len % sizeof(Char_type) != 0)
-    {
-      object->error(_("mergeable string section length not multiple of "
-		      "character size"));
-      if (is_new)
-	delete[] pdata;
-      return false;
-    }
-
   if (pend[-1] != 0)
     {
       gold_warning(_("%s: last entry in mergeable string section '%s' "
@@ -535,9 +645,6 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	--pend0;
     }
 
-  Merged_strings_list* merged_strings_list =
-      new Merged_strings_list(object, shndx);
-  this->merged_strings_lists_.push_back(merged_strings_list);
   Merged_strings& merged_strings = merged_strings_list->merged_strings;
 
   // Count the number of non-null strings in the section and size the list.
@@ -574,10 +681,7 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	      != init_align_modulo))
 	  has_misaligned_strings = true;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
-
-      merged_strings.push_back(Merged_string(i, key));
+      this->add_merged_string(p, len, i, &merged_strings);
       p += len + 1;
       i += (len + 1) * sizeof(Char_type);
     }
@@ -585,10 +689,7 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
     {
       size_t len = pend - p;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
-
-      merged_strings.push_back(Merged_string(i, key));
+      this->add_merged_string(p, len, i, &merged_strings);
 
       i += (len + 1) * sizeof(Char_type);
     }
@@ -597,8 +698,8 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   // compute the length of the last string.
   merged_strings.push_back(Merged_string(i, 0));
 
-  this->input_count_ += count;
-  this->input_size_ += i;
+  merged_strings_list->input_count = count;
+  merged_strings_list->is_read = true;
 
   if (has_misaligned_strings)
     gold_warning(_("%s: section %s contains incorrectly aligned strings;"
@@ -606,14 +707,36 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 		 object->name().c_str(),
 		 object->section_name(shndx).c_str());
 
-  // For script processing, we keep the input sections.
-  if (this->keeps_input_sections())
-    record_input_section(object, shndx);
-
   if (is_new)
     delete[] pdata;
+  else
+    {
+      // The strings have been copied into the pool, so we no longer
+      // need any cached decompressed contents.
+      object->release_decompressed_section(shndx);
+    }
+}
 
-  return true;
+// Add a string from an input section to the pool.  When running in
+// parallel, we only intern the string here; finalize_merged_data
+// gives it a key.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::add_merged_string(
+    const Char_type* p,
+    size_t len,
+    section_size_type offset,
+    Merged_strings* merged_strings)
+{
+  Merged_string merged_string(offset, 0);
+  if (this->parallel_)
+    this->stringpool_.intern(p, len, string_hash<Char_type>(p, len),
+			     &merged_string.key_location);
+  else
+    this->stringpool_.add_with_length(p, len, true,
+				      &merged_string.stringpool_key);
+  merged_strings->push_back(merged_string);
 }
 
 // Finalize the mappings from the input sections to the output
@@ -623,6 +746,31 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
+  // Give interned strings their keys in the order in which the input
+  // sections were added, so that the keys do not depend on the order
+  // in which the Merge_string_tasks ran.
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    {
+      gold_assert((*l)->is_read);
+      Merged_strings& merged_strings((*l)->merged_strings);
+      if (this->parallel_)
+	{
+	  for (size_t i = 0; i + 1 < merged_strings.size(); ++i)
+	    {
+	      Merged_string* p = &merged_strings[i];
+	      size_t len = ((p[1].offset - p[0].offset) / sizeof(Char_type)
+			    - 1);
+	      p->stringpool_key = this->stringpool_.add_interned(p->key_location,
+								 len);
+	    }
+	}
+      this->input_count_ += (*l)->input_count;
+      this->input_size_ += merged_strings.back().offset;
+    }
+
   this->stringpool_.set_string_offsets();
 
   for (typename Merged_strings_lists::const_iterator l =
@@ -277,6 +277,14 @@ class Output_merge_base : public Output_section_data
     gold_assert(this->keeps_input_sections_);
     return this->input_sections_.end();
   }
+
+  // Add to TASKS any tasks which should process the input sections
+  // seen so far in parallel.  Each task will unblock BLOCKER.  The
+  // caller is responsible for adding the blockers and queuing the
+  // tasks.
+  void
+  add_merge_tasks(Task_token* blocker, std::vector<Task*>* tasks)
+  { this->do_add_merge_tasks(blocker, tasks); }
  
  protected:
   // Return the output offset for an input offset.
@@ -310,6 +318,11 @@ class Output_merge_base : public Output_section_data
   do_set_keeps_input_sections()
   { this->keeps_input_sections_ = true; }
 
+  // This may be overridden by the child class.
+  virtual void
+  do_add_merge_tasks(Task_token*, std::vector<Task*>*)
+  { }
+
   // Record the merged input section for script processing.
   void
   record_input_section(Relobj* relobj, unsigned int shndx);
@@ -462,9 +475,21 @@ class Output_merge_string : public Output_merge_base
  public:
   Output_merge_string(uint64_t addralign)
     : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
-      merged_strings_lists_(), input_count_(0), input_size_(0)
+      merged_strings_lists_(), input_count_(0), input_size_(0),
+      parallel_(false), tasks_added_(false)
   {
     this->stringpool_.set_no_zero_null();
+#ifdef ENABLE_THREADS
+    // With threads, Merge_string_tasks read the input sections and
+    // intern their strings in parallel.  An incremental link wants
+    // the strings in the order they were added, so we don't do it
+    // there.
+    if (parameters->options().threads() && !parameters->incremental())
+      {
+	this->stringpool_.set_concurrent();
+	this->parallel_ = true;
+      }
+#endif
   }
 
  protected:
@@ -517,11 +542,17 @@ class Output_merge_string : public Output_merge_base
   void
   do_set_keeps_input_sections()
   {
-    gold_assert(this->input_count_ == 0);
+    gold_assert(this->merged_strings_lists_.empty());
     Output_merge_base::do_set_keeps_input_sections();
   }
 
+  // Add tasks to read the strings of the input sections.
+  void
+  do_add_merge_tasks(Task_token* blocker, std::vector<Task*>* tasks);
+
  private:
+  class Merge_string_task;
+
   // The name of the string type, for stats.
   const char*
   string_name();
@@ -532,8 +563,15 @@ class Output_merge_string : public Output_merge_base
   {
     // The offset in the input section.
     section_offset_type offset;
-    // The key in the Stringpool.
-    Stringpool::Key stringpool_key;
+    union
+    {
+      // The key in the Stringpool.
+      Stringpool::Key stringpool_key;
+      // When the string was interned by a Merge_string_task, the
+      // location where the Stringpool will store its key.
+      // finalize_merged_data replaces this with the key.
+      Stringpool::Key* key_location;
+    };
 
     Merged_string(section_offset_type offseta, Stringpool::Key stringpool_keya)
       : offset(offseta), stringpool_key(stringpool_keya)
@@ -550,14 +588,29 @@ class Output_merge_string : public Output_merge_base
     unsigned int shndx;
     // The list of merged strings.
     Merged_strings merged_strings;
+    // The number of non-empty strings in the input section.
+    size_t input_count;
+    // Whether the strings have been read.
+    bool is_read;
 
     Merged_strings_list(Relobj* objecta, unsigned int shndxa)
-      : object(objecta), shndx(shndxa), merged_strings()
+      : object(objecta), shndx(shndxa), merged_strings(), input_count(0),
+	is_read(false)
     { }
   };
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
+  // Read the strings from an input section and add them to the pool.
+  void
+  read_strings(Merged_strings_list*);
+
+  // Add a string of LEN characters at P, found at OFFSET in an input
+  // section, to the pool and to MERGED_STRINGS.
+  void
+  add_merged_string(const Char_type* p, size_t len, section_size_type offset,
+		    Merged_strings* merged_strings);
+
   // As we see the strings, we add them to a Stringpool.
   Stringpool_template<Char_type> stringpool_;
   // Map from a location in an input object to an entry in the
@@ -567,6 +620,12 @@ class Output_merge_string : public Output_merge_base
   size_t input_count_;
   // The total size of input sections.
   size_t input_size_;
+  // Whether the strings are interned in parallel, rather than added
+  // one at a time.
+  bool parallel_;
+  // Whether add_merge_tasks has been called.  Input sections added
+  // after that are read immediately.
+  bool tasks_added_;
 };
 
 } // End namespace gold.
@@ -267,6 +267,20 @@ Object::handle_split_stack_section(const char* name)
   return false;
 }
 
+// Return a hash of the contents of the file, for
+// --incremental-check-hash.
+
+uint64_t
+Object::do_get_content_hash()
+{
+  if (this->offset() != 0)
+    return 0;
+  uint64_t hash;
+  if (!gold::get_content_hash(this->name().c_str(), &hash))
+    return 0;
+  return hash;
+}
+
 // Class Relobj
 
 // To copy the symbols data read from the file to a local data structure.
@@ -614,6 +628,46 @@ Sized_relobj_file<size, big_endian>::find_eh_frame(
     }
 }
 
+// The decompressed contents of compressed debug sections may be
+// wanted several times: for string merging, --gdb-index,
+// --detect-odr-violations, and finally to write the output.  Rather
+// than decompress the section each time, we keep the contents as
+// long as the total stays within --decompress-cache-size.
+
+// A lock for decompressed_cache_bytes.
+static Lock* decompressed_cache_lock = NULL;
+static Initialize_lock
+decompressed_cache_initialize_lock(&decompressed_cache_lock);
+
+// The number of bytes of decompressed contents being kept.
+static uint64_t decompressed_cache_bytes;
+
+// Try to reserve SIZE bytes for decompressed contents.  Return false
+// if that would exceed the limit.
+
+static bool
+reserve_decompressed_cache(uint64_t size)
+{
+  decompressed_cache_initialize_lock.initialize();
+  Hold_optional_lock hl(decompressed_cache_lock);
+  if (decompressed_cache_bytes + size
+      > parameters->options().decompress_cache_size())
+    return false;
+  decompressed_cache_bytes += size;
+  return true;
+}
+
+// Release SIZE bytes previously reserved.
+
+static void
+release_decompressed_cache(uint64_t size)
+{
+  decompressed_cache_initialize_lock.initialize();
+  Hold_optional_lock hl(decompressed_cache_lock);
+  gold_assert(decompressed_cache_bytes >= size);
+  decompressed_cache_bytes -= size;
+}
+
 // Return TRUE if this is a section whose contents will be needed in the
 // Add_symbols task.  This function is only called for sections that have
 // already passed the test in is_compressed_debug_section(), so we know
@@ -648,6 +702,12 @@ need_decompressed_section(const char* name)
 	      || strcmp(name, "ranges") == 0
 	      || strcmp(name, "abbrev") == 0))
 	return true;
+
+      // We will need the line tables when looking for ODR
+      // violations.
+      if (parameters->options().detect_odr_violations()
+	  && strcmp(name, "line") == 0)
+	return true;
     }
 #endif
 
@@ -704,8 +764,12 @@ build_compressed_section_map(
 	      info.contents = NULL;
 	      if (uncompressed_size != -1ULL)
 		{
+		  // Only decompress the section now if the contents fit
+		  // in the cache; otherwise it is decompressed when it is
+		  // needed.
 		  unsigned char* uncompressed_data = NULL;
-		  if (need_decompressed_section(name))
+		  if (need_decompressed_section(name)
+		      && reserve_decompressed_cache(uncompressed_size))
 		    {
 		      uncompressed_data = new unsigned char[uncompressed_size];
 		      if (decompress_input_section(contents, len,
@@ -713,7 +777,10 @@ build_compressed_section_map(
 						   uncompressed_size))
 			info.contents = uncompressed_data;
 		      else
-			delete[] uncompressed_data;
+			{
+			  delete[] uncompressed_data;
+			  release_decompressed_cache(uncompressed_size);
+			}
 		    }
 		  (*uncompressed_map)[i] = info;
 		}
@@ -837,6 +904,63 @@ Sized_relobj_file<size, big_endian>::do_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+#ifdef ENABLE_THREADS
+  // Doing this now will help only if we're multithreaded.  We don't
+  // do it for an incremental link, which handles symbol versions
+  // differently.
+  if (parameters->options().threads()
+      && parameters->options().prehash_symbols()
+      && !parameters->incremental())
+    this->prehash_global_symbols(sd);
+#endif
+}
+
+// Split the names of the external symbols into name and version, and
+// compute the hash codes that Symbol_table::add_from_relobj will use
+// to add them to the symbol table.  This only looks at the data in
+// SD, so it is safe to run in parallel with other tasks.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::prehash_global_symbols(
+    Read_symbols_data* sd)
+{
+  const int sym_size = This::sym_size;
+  size_t symcount = ((sd->symbols_size - sd->external_symbols_offset)
+		     / sym_size);
+  const unsigned char* p = sd->symbols->data() + sd->external_symbols_offset;
+  const char* sym_names =
+    reinterpret_cast<const char*>(sd->symbol_names->data());
+  const section_size_type sym_names_size = sd->symbol_names_size;
+
+  sd->global_symbol_names.resize(symcount);
+  for (size_t i = 0; i < symcount; ++i, p += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(p);
+      unsigned int st_name = sym.get_st_name();
+
+      // add_from_relobj will report the error.
+      if (st_name >= sym_names_size)
+	continue;
+
+      Global_symbol_name* gsn = &sd->global_symbol_names[i];
+      const char* name = sym_names + st_name;
+      const char* ver = strchr(name, '@');
+      if (ver == NULL)
+	gsn->name_length = strlen(name);
+      else
+	{
+	  gsn->version = ver;
+	  gsn->name_length = ver - name;
+	  ++ver;
+	  if (*ver == '@')
+	    ++ver;
+	  gsn->version_length = strlen(ver);
+	  gsn->version_hash = string_hash<char>(ver, gsn->version_length);
+	}
+      gsn->name_hash = string_hash<char>(name, gsn->name_length);
+    }
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -1932,10 +2056,17 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 
   const char* sym_names =
     reinterpret_cast<const char*>(sd->symbol_names->data());
+  const Global_symbol_name* global_names = NULL;
+  if (!sd->global_symbol_names.empty())
+    {
+      gold_assert(sd->global_symbol_names.size() == symcount);
+      global_names = &sd->global_symbol_names[0];
+    }
   symtab->add_from_relobj(this,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
 			  sym_names, sd->symbol_names_size,
+			  global_names,
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -2801,7 +2932,7 @@ Sized_relobj_file<size, big_endian>::do_decompressed_section_contents(
       return buffer;
     }
 
-  Compressed_section_map::const_iterator p =
+  Compressed_section_map::iterator p =
       this->compressed_sections_->find(shndx);
   if (p == this->compressed_sections_->end())
     {
@@ -2810,13 +2941,21 @@ Sized_relobj_file<size, big_endian>::do_decompressed_section_contents(
       return buffer;
     }
 
-  section_size_type uncompressed_size = p->second.size;
-  if (p->second.contents != NULL)
-    {
-      *plen = uncompressed_size;
-      *is_new = false;
-      return p->second.contents;
-    }
+  // The map itself does not change after it is built, but the
+  // contents of an entry may be set or freed by another thread, so
+  // only look at them while holding the lock.
+  Compressed_section_info* info = &p->second;
+  section_size_type uncompressed_size = info->size;
+  decompressed_cache_initialize_lock.initialize();
+  {
+    Hold_optional_lock hl(decompressed_cache_lock);
+    if (info->contents != NULL)
+      {
+	*plen = uncompressed_size;
+	*is_new = false;
+	return info->contents;
+      }
+  }
 
   unsigned char* uncompressed_data = new unsigned char[uncompressed_size];
   if (!decompress_input_section(buffer,
@@ -2826,18 +2965,30 @@ Sized_relobj_file<size, big_endian>::do_decompressed_section_contents(
     this->error(_("could not decompress section %s"),
 		this->do_section_name(shndx).c_str());
 
-  // We could cache the results in p->second.contents and store
-  // false in *IS_NEW, but build_compressed_section_map() would
-  // have done so if it had expected it to be profitable.  If
-  // we reach this point, we expect to need the contents only
-  // once in this pass.
+  // Keep the contents for the next user if there is room, unless
+  // another thread has decompressed the same section meanwhile.
   *plen = uncompressed_size;
+  {
+    Hold_optional_lock hl(decompressed_cache_lock);
+    if (info->contents == NULL
+	&& (decompressed_cache_bytes + uncompressed_size
+	    <= parameters->options().decompress_cache_size()))
+      {
+	decompressed_cache_bytes += uncompressed_size;
+	info->contents = uncompressed_data;
+	*is_new = false;
+	return uncompressed_data;
+      }
+  }
+
   *is_new = true;
   return uncompressed_data;
 }
 
 // Discard any buffers of uncompressed sections.  This is done
-// at the end of the Add_symbols task.
+// at the end of the Add_symbols task.  Cached contents of sections
+// which will be written to the output file are kept, to be released
+// once they have been copied or merged.
 
 template<int size, bool big_endian>
 void
@@ -2849,13 +3000,64 @@ Sized_relobj_file<size, big_endian>::do_discard_decompressed_sections()
   for (Compressed_section_map::iterator p = this->compressed_sections_->begin();
        p != this->compressed_sections_->end();
        ++p)
+    if (this->output_section(p->first) == NULL)
+      this->do_release_decompressed_section(p->first);
+}
+
+// Release the decompressed contents of section SHNDX, if we have
+// them.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_release_decompressed_section(
+    unsigned int shndx)
+{
+  delete[] this->take_decompressed_section(shndx);
+}
+
+// Remove the cached decompressed contents of section SHNDX from the
+// cache, and return them.  The caller must free them.  Return NULL if
+// they are not cached.
+
+template<int size, bool big_endian>
+const unsigned char*
+Sized_relobj_file<size, big_endian>::take_decompressed_section(
+    unsigned int shndx)
+{
+  if (this->compressed_sections_ == NULL)
+    return NULL;
+
+  Compressed_section_map::iterator p = this->compressed_sections_->find(shndx);
+  if (p == this->compressed_sections_->end())
+    return NULL;
+
+  decompressed_cache_initialize_lock.initialize();
+  Hold_optional_lock hl(decompressed_cache_lock);
+  const unsigned char* contents = p->second.contents;
+  if (contents != NULL)
     {
-      if (p->second.contents != NULL)
-	{
-	  delete[] p->second.contents;
-	  p->second.contents = NULL;
-	}
+      p->second.contents = NULL;
+      gold_assert(decompressed_cache_bytes >= p->second.size);
+      decompressed_cache_bytes -= p->second.size;
     }
+  return contents;
+}
+
+// Free the decompressed contents of all sections.  This is done once
+// the sections have been relocated, when nothing will read them
+// again.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::free_decompressed_sections()
+{
+  if (this->compressed_sections_ == NULL)
+    return;
+
+  for (Compressed_section_map::iterator p = this->compressed_sections_->begin();
+       p != this->compressed_sections_->end();
+       ++p)
+    this->do_release_decompressed_section(p->first);
 }
 
 // Input_objects methods.
@@ -53,13 +53,41 @@ struct Symbols_data;
 template<typename Stringpool_char>
 class Stringpool_template;
 
+// Information about the name of a global symbol in a relocatable
+// object.  When running multi-threaded with --prehash-symbols, this
+// is computed by the Read_symbols task, which runs in parallel with
+// other tasks, so that the Add_symbols task, which must run in
+// command line order, has less work to do.
+
+struct Global_symbol_name
+{
+  Global_symbol_name()
+    : version(NULL), name_length(0), name_hash(0), version_length(0),
+      version_hash(0)
+  { }
+
+  // The '@' which separates the name from the version, or NULL if
+  // the symbol name has no version.
+  const char* version;
+  // The length of the name, not including any version.
+  size_t name_length;
+  // The hash code of the name, as computed by string_hash.
+  size_t name_hash;
+  // The length of the version, not including any leading '@'
+  // characters.
+  size_t version_length;
+  // The hash code of the version.
+  size_t version_hash;
+};
+
 // Data to pass from read_symbols() to add_symbols().
 
 struct Read_symbols_data
 {
   Read_symbols_data()
     : section_headers(NULL), section_names(NULL), symbols(NULL),
-      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL)
+      symbol_names(NULL), global_symbol_names(), versym(NULL), verdef(NULL),
+      verneed(NULL)
   { }
 
   ~Read_symbols_data();
@@ -82,6 +110,10 @@ struct Read_symbols_data
   File_view* symbol_names;
   // Size of symbol name data in bytes.
   section_size_type symbol_names_size;
+  // Precomputed names of the external symbols, indexed by the
+  // external symbol index.  This is empty unless the names were
+  // prehashed.
+  std::vector<Global_symbol_name> global_symbol_names;
 
   // Version information.  This is only used on dynamic objects.
   // Version symbol data (from SHT_GNU_versym section).
@@ -415,6 +447,18 @@ class Object
     return this->input_file_;
   }
 
+  // Read the object through INPUT_FILE, which is another Input_file
+  // for the same file.  This is used for archive members whose
+  // symbols were read through a separate Input_file.
+  void
+  set_input_file(Input_file* input_file)
+  {
+    gold_assert(this->input_file_ != NULL);
+    this->input_file_->file().remove_object();
+    this->input_file_ = input_file;
+    input_file->file().add_object();
+  }
+
   // Lock the underlying file.
   void
   lock(const Task* t)
@@ -436,6 +480,14 @@ class Object
   is_locked() const
   { return this->input_file_ != NULL && this->input_file_->file().is_locked(); }
 
+  // Return whether the underlying file is locked by task T.
+  bool
+  is_locked_by(const Task* t) const
+  {
+    return (this->input_file_ != NULL
+	    && this->input_file_->file().is_locked_by(t));
+  }
+
   // Return the token, so that the task can be queued.
   Task_token*
   token()
@@ -468,6 +520,12 @@ class Object
   get_mtime()
   { return this->do_get_mtime(); }
 
+  // Return a hash of the contents of the file, or 0 if it can not be
+  // computed.
+  uint64_t
+  get_content_hash()
+  { return this->do_get_content_hash(); }
+
   // Get the number of sections.
   unsigned int
   shnum() const
@@ -747,6 +805,12 @@ class Object
   discard_decompressed_sections()
   { this->do_discard_decompressed_sections(); }
 
+  // Release the cached decompressed contents of section SHNDX, once
+  // the last user of them is done.
+  void
+  release_decompressed_section(unsigned int shndx)
+  { this->do_release_decompressed_section(shndx); }
+
   // Return the index of the first incremental relocation for symbol SYMNDX.
   unsigned int
   get_incremental_reloc_base(unsigned int symndx) const
@@ -784,6 +848,13 @@ class Object
   do_get_mtime()
   { return this->input_file()->file().get_mtime(); }
 
+  // Return a hash of the contents of the file.  Archive members are
+  // covered by the hash of the archive, so this returns 0 for them.
+  // This method is overridden by incremental objects, which return
+  // the hash recorded by the previous link.
+  virtual uint64_t
+  do_get_content_hash();
+
   // Read the symbols--implemented by child class.
   virtual void
   do_read_symbols(Read_symbols_data*) = 0;
@@ -951,6 +1022,11 @@ class Object
   do_discard_decompressed_sections()
   { }
 
+  // Release the cached decompressed contents of a section.
+  virtual void
+  do_release_decompressed_section(unsigned int)
+  { }
+
   // Return the index of the first incremental relocation for symbol SYMNDX--
   // implemented by child class.
   virtual unsigned int
@@ -1868,6 +1944,9 @@ class Reloc_symbol_changes
 struct Compressed_section_info
 {
   section_size_type size;
+  // The decompressed contents, if they are cached.  These are counted
+  // against --decompress-cache-size.  Only access this while holding
+  // the decompressed cache lock.
   const unsigned char* contents;
 };
 typedef std::map<unsigned int, Compressed_section_info> Compressed_section_map;
@@ -2477,6 +2556,19 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   do_discard_decompressed_sections();
 
+  // Release the cached decompressed contents of a section.
+  void
+  do_release_decompressed_section(unsigned int shndx);
+
+  // Free the decompressed contents of all sections.
+  void
+  free_decompressed_sections();
+
+  // Remove the cached decompressed contents of a section from the
+  // cache and return them.
+  const unsigned char*
+  take_decompressed_section(unsigned int shndx);
+
  private:
   // For convenience.
   typedef Sized_relobj_file<size, big_endian> This;
@@ -2503,6 +2595,11 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   find_symtab(const unsigned char* pshdrs);
 
+  // Split the names of the external symbols into name and version,
+  // and compute their hash codes.
+  void
+  prehash_global_symbols(Read_symbols_data*);
+
   // Return whether SHDR has the right flags for a GNU style exception
   // frame section.
   bool
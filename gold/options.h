@@ -680,12 +680,14 @@ class General_options
 	      N_("Bind defined function symbols locally"), NULL);
 
   DEFINE_optional_string(build_id, options::TWO_DASHES, '\0', "tree",
-			 N_("Generate build ID note"),
+			 N_("Generate build ID note; STYLE is md5, sha1,"
+			    " tree, fast, uuid, 0xHEX or none"),
 			 N_("[=STYLE]"));
 
   DEFINE_uint64(build_id_chunk_size_for_treehash,
 		options::TWO_DASHES, '\0', 2 << 20,
-		N_("Chunk size for '--build-id=tree'"), N_("SIZE"));
+		N_("Chunk size for '--build-id=tree' and '--build-id=fast'"),
+		N_("SIZE"));
 
   DEFINE_uint64(build_id_min_file_size_for_treehash, options::TWO_DASHES,
 		'\0', 40 << 20,
@@ -743,6 +745,10 @@ class General_options
 	      N_("Do not demangle C++ symbols in log messages"),
 	      NULL);
 
+  DEFINE_uint64(decompress_cache_size, options::TWO_DASHES, '\0', 256 << 20,
+		N_("Memory to use for keeping decompressed debug sections "
+		   "(default 256MB)"), N_("SIZE"));
+
   DEFINE_bool(detect_odr_violations, options::TWO_DASHES, '\0', false,
 	      N_("Look for violations of the C++ One Definition Rule"),
 	      N_("Do not look for violations of the C++ One Definition Rule"));
@@ -885,6 +891,11 @@ class General_options
 		 N_("Assume startup files unchanged "
 		    "(files preceding this option)"), NULL);
 
+  DEFINE_bool(incremental_check_hash, options::TWO_DASHES, '\0', false,
+	      N_("Record a hash of each input file, and treat a file "
+		 "whose timestamp changed as unchanged if the hash matches"),
+	      N_("Use only timestamps to check files (default)"));
+
   DEFINE_percent(incremental_patch, options::TWO_DASHES, '\0', 10,
 		 N_("Amount of extra space to allocate for patches"),
 		 N_("PERCENT"));
@@ -903,6 +914,10 @@ class General_options
   DEFINE_bool(keep_files_mapped, options::TWO_DASHES, '\0', true,
 	      N_("Keep files mapped across passes (default)"),
 	      N_("Release mapped files after each pass"));
+  DEFINE_uint64(mapped_input_budget, options::TWO_DASHES, '\0', 0,
+		N_("Unmap cached views of input files while more than SIZE "
+		   "megabytes of input are mapped (0 for no limit)"),
+		N_("SIZE"));
 
   DEFINE_bool(ld_generated_unwind_info, options::TWO_DASHES, '\0', true,
 	      N_("Generate unwind information for PLT (default)"),
@@ -1005,6 +1020,10 @@ class General_options
 		 " (default)."),
 	      N_("Use fallocate or ftruncate to reserve space."));
 
+  DEFINE_bool(prehash_symbols, options::TWO_DASHES, '\0', false,
+	      N_("Hash symbol names while reading them when multi-threaded"),
+	      N_("Hash symbol names while adding them to the symbol table"));
+
   DEFINE_bool(preread_archive_symbols, options::TWO_DASHES, '\0', false,
 	      N_("Preread archive symbols when multi-threaded"), NULL);
 
@@ -1138,6 +1157,10 @@ class General_options
   DEFINE_bool(trace, options::TWO_DASHES, 't', false,
 	      N_("Print the name of each input file"), NULL);
 
+  DEFINE_string(trace_profile, options::TWO_DASHES, '\0', NULL,
+		N_("Write a trace of task run times to FILENAME"),
+		N_("FILENAME"));
+
   DEFINE_special(script, options::TWO_DASHES, 'T',
 		 N_("Read linker script"), N_("FILE"));
 
@@ -1516,6 +1539,21 @@ class General_options
   endianness() const
   { return this->endianness_; }
 
+  // Set the threading options.  This is for programs such as dwp
+  // which use a Workqueue but do not parse a linker command line.
+  void
+  set_thread_options(bool threads, int thread_count)
+  {
+    this->set_threads(threads);
+    this->set_thread_count(thread_count);
+  }
+
+  // Set the output file name.  This is for programs such as dwp, so
+  // that gold_exit removes the file they are writing if they fail.
+  void
+  set_output_file_name(const char* name)
+  { this->set_output(name); }
+
  private:
   // Don't copy this structure.
   General_options(const General_options&);
@@ -3587,6 +3587,19 @@ Output_section::update_section_layout(
     }
 }
 
+// Add the tasks for the merge sections.
+
+void
+Output_section::add_merge_tasks(Task_token* blocker,
+				std::vector<Task*>* tasks)
+{
+  for (Input_section_list::iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    if (p->is_merge_section())
+      p->output_merge_base()->add_merge_tasks(blocker, tasks);
+}
+
 // Sort the input sections attached to an output section.
 
 void
@@ -4939,7 +4952,10 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    range_listeners_(),
+    finished_ranges_(),
+    finished_ranges_lock_(NULL)
 {
 }
 
@@ -5276,6 +5292,104 @@ Output_file::close()
     if (::close(this->o_) < 0)
       gold_error(_("%s: close: %s"), this->name_, strerror(errno));
   this->o_ = -1;
+
+  // No more ranges can be finished.
+  for (std::vector<Range_listener*>::const_iterator p =
+	 this->range_listeners_.begin();
+       p != this->range_listeners_.end();
+       ++p)
+    delete *p;
+  this->range_listeners_.clear();
+  this->finished_ranges_.clear();
+  delete this->finished_ranges_lock_;
+  this->finished_ranges_lock_ = NULL;
+}
+
+// Add a listener for finished ranges.
+
+void
+Output_file::add_range_listener(Range_listener* listener)
+{
+  if (this->finished_ranges_lock_ == NULL)
+    this->finished_ranges_lock_ = new Lock();
+  this->range_listeners_.push_back(listener);
+}
+
+// Record that the LEN bytes at START are final.  The range is merged
+// with any finished ranges which it touches, so that
+// is_range_finished only has to look at a single entry.  Only the
+// parts of the range which were not already finished are passed to
+// the listeners.
+
+void
+Output_file::finish_range(Workqueue* workqueue, off_t start, off_t len)
+{
+  if (this->range_listeners_.empty() || len <= 0)
+    return;
+
+  // The start and length of each newly finished part of the range.
+  std::vector<std::pair<off_t, off_t> > added;
+  {
+    Hold_lock hl(*this->finished_ranges_lock_);
+    const off_t range_end = start + len;
+    off_t first = start;
+    off_t end = range_end;
+    // The first byte of the range which may not be finished yet.
+    off_t pos = start;
+    Finished_ranges::iterator p = this->finished_ranges_.upper_bound(first);
+    if (p != this->finished_ranges_.begin())
+      {
+	Finished_ranges::iterator prev = p;
+	--prev;
+	if (prev->second >= first)
+	  {
+	    first = prev->first;
+	    p = prev;
+	  }
+      }
+    while (p != this->finished_ranges_.end() && p->first <= end)
+      {
+	if (p->first > pos && pos < range_end)
+	  added.push_back(std::make_pair(pos,
+					 std::min(p->first, range_end) - pos));
+	pos = std::max(pos, p->second);
+	end = std::max(end, p->second);
+	this->finished_ranges_.erase(p++);
+      }
+    if (pos < range_end)
+      added.push_back(std::make_pair(pos, range_end - pos));
+    this->finished_ranges_[first] = end;
+  }
+
+  // Call the listeners without holding the lock, as they will
+  // normally call is_range_finished.
+  for (std::vector<std::pair<off_t, off_t> >::const_iterator pa =
+	 added.begin();
+       pa != added.end();
+       ++pa)
+    for (std::vector<Range_listener*>::const_iterator p =
+	   this->range_listeners_.begin();
+	 p != this->range_listeners_.end();
+	 ++p)
+      (*p)->range_finished(workqueue, pa->first, pa->second);
+}
+
+// Return whether the LEN bytes at START are final.
+
+bool
+Output_file::is_range_finished(off_t start, off_t len)
+{
+  if (this->finished_ranges_lock_ == NULL)
+    return false;
+  if (len <= 0)
+    return true;
+
+  Hold_lock hl(*this->finished_ranges_lock_);
+  Finished_ranges::const_iterator p = this->finished_ranges_.upper_bound(start);
+  if (p == this->finished_ranges_.begin())
+    return false;
+  --p;
+  return p->second >= start + len;
 }
 
 // Instantiate the templates we need.  We could use the configure
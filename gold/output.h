@@ -25,9 +25,11 @@
 #define GOLD_OUTPUT_H
 
 #include <list>
+#include <map>
 #include <vector>
 
 #include "elfcpp.h"
+#include "gold-threads.h"
 #include "mapfile.h"
 #include "layout.h"
 #include "reloc-types.h"
@@ -2716,13 +2718,17 @@ class Output_symtab_xindex : public Output_section_data
  public:
   Output_symtab_xindex(size_t symcount)
     : Output_section_data(symcount * 4, 4, true),
-      entries_()
+      entries_(), lock_()
   { }
 
-  // Add an entry: symbol number SYMNDX has section SHNDX.
+  // Add an entry: symbol number SYMNDX has section SHNDX.  This may
+  // be called by several tasks at once.
   void
   add(unsigned int symndx, unsigned int shndx)
-  { this->entries_.push_back(std::make_pair(symndx, shndx)); }
+  {
+    Hold_lock hl(this->lock_);
+    this->entries_.push_back(std::make_pair(symndx, shndx));
+  }
 
  protected:
   void
@@ -2745,6 +2751,8 @@ class Output_symtab_xindex : public Output_section_data
 
   // The entries we need.
   Xindex_entries entries_;
+  // Lock for entries_.
+  Lock lock_;
 };
 
 // A relaxed input section.
@@ -3117,6 +3125,11 @@ class Output_section : public Output_data
   void
   update_section_layout(const Section_layout_order* order_map);
 
+  // Add to TASKS the tasks which process the input sections of the
+  // merge sections in parallel.  Each task will unblock BLOCKER.
+  void
+  add_merge_tasks(Task_token* blocker, std::vector<Task*>* tasks);
+
   // Update the output section flags based on input section flags.
   void
   update_flags_for_input_section(elfcpp::Elf_Xword flags);
@@ -3453,6 +3466,11 @@ class Output_section : public Output_data
   void
   create_postprocessing_buffer();
 
+  // Whether the postprocessing buffer has been created.
+  bool
+  has_postprocessing_buffer() const
+  { return this->postprocessing_buffer_ != NULL; }
+
   // If a section requires postprocessing, this is the size of the
   // buffer to which relocations should be applied.
   off_t
@@ -4827,7 +4845,43 @@ class Output_file
   free_input_view(off_t, size_t, const unsigned char*)
   { }
 
+  // An interface for code which wants to know when parts of the
+  // output file have been completely written.
+  class Range_listener
+  {
+   public:
+    virtual
+    ~Range_listener()
+    { }
+
+    // Called after the LEN bytes at START become final.  This may be
+    // called by any thread.
+    virtual void
+    range_finished(Workqueue*, off_t start, off_t len) = 0;
+  };
+
+  // Add a listener which is told about finished ranges.  This method
+  // is thread-unsafe, and must be called before queuing any task
+  // which calls finish_range.  The Output_file takes ownership of
+  // the listener, and deletes it when the file is closed.
+  void
+  add_range_listener(Range_listener*);
+
+  // Record that the LEN bytes at START will not be written again, and
+  // tell the listeners about the parts of the range which were not
+  // already finished.  This does nothing if there are no listeners.
+  void
+  finish_range(Workqueue*, off_t start, off_t len);
+
+  // Return whether all of the LEN bytes at START have been finished.
+  bool
+  is_range_finished(off_t start, off_t len);
+
  private:
+  // Map from the start of a finished range to its end.  Adjacent
+  // ranges are coalesced.
+  typedef std::map<off_t, off_t> Finished_ranges;
+
   // Map the file into memory or, if that fails, allocate anonymous
   // memory.
   void
@@ -4859,6 +4913,12 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // Listeners told about finished ranges.
+  std::vector<Range_listener*> range_listeners_;
+  // The ranges which have been finished.
+  Finished_ranges finished_ranges_;
+  // Lock for finished_ranges_; created with the first listener.
+  Lock* finished_ranges_lock_;
 };
 
 } // End namespace gold.
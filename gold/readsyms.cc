@@ -304,20 +304,22 @@ Read_symbols::do_read_symbols(Workqueue* workqueue)
 				      this->dirpath_, this);
 	  arch->setup();
 
+	  Task_token* members_blocker =
+	    arch->queue_read_members(workqueue);
+
 	  // Unlock the archive so it can be used in the next task.
 	  arch->unlock(this);
 
-	  workqueue->queue_next(new Add_archive_symbols(this->symtab_,
-							this->layout_,
-							this->input_objects_,
-							this->dirpath_,
-							this->dirindex_,
-							this->mapfile_,
-							this->input_argument_,
-							arch,
-							this->input_group_,
-							this->this_blocker_,
-							this->next_blocker_));
+	  Add_archive_symbols* add_archive_symbols =
+	    new Add_archive_symbols(this->symtab_, this->layout_,
+				    this->input_objects_, this->dirpath_,
+				    this->dirindex_, this->mapfile_,
+				    this->input_argument_, arch,
+				    this->input_group_, this->this_blocker_,
+				    this->next_blocker_);
+	  if (members_blocker != NULL)
+	    add_archive_symbols->set_members_blocker(members_blocker);
+	  workqueue->queue_next(add_archive_symbols);
 	  return true;
 	}
     }
@@ -672,8 +674,8 @@ void
 Read_member::run(Workqueue*)
 {
   // This task doesn't need to do anything for now.  The Read_symbols task
-  // that is queued for the archive library will cause the archive to be
-  // processed from scratch.
+  // that is queued for the archive library will read the changed member
+  // again if it is still needed.
 }
 
 // Class Check_script.
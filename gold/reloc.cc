@@ -234,9 +234,10 @@ Relocate_task::locks(Task_locker* tl)
 // Run the task.
 
 void
-Relocate_task::run(Workqueue*)
+Relocate_task::run(Workqueue* workqueue)
 {
   this->object_->relocate(this->symtab_, this->layout_, this->of_);
+  this->layout_->finish_relobj_sections(workqueue, this->object_, this->of_);
 
   // This is normally the last thing we will do with an object, so
   // uncache all views.
@@ -673,6 +674,10 @@ Sized_relobj_file<size, big_endian>::do_relocate(const Symbol_table* symtab,
   // since we no longer need them.
   this->free_input_to_output_maps();
 
+  // Nothing reads the decompressed contents of the input sections
+  // after this.
+  this->free_decompressed_sections();
+
   // Write out the accumulated views.
   for (unsigned int i = 1; i < shnum; ++i)
     {
@@ -863,12 +868,23 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
 
       if (must_decompress)
         {
-	  // Read and decompress the section.
-          section_size_type len;
-	  const unsigned char* p = this->section_contents(i, &len, false);
-	  if (!decompress_input_section(p, len, view, view_size))
-	    this->error(_("could not decompress section %s"),
-			this->section_name(i).c_str());
+	  // If we kept the decompressed contents, copy them and release
+	  // them, since this is the last use.  Otherwise read and
+	  // decompress the section.
+	  const unsigned char* pc = this->take_decompressed_section(i);
+	  if (pc != NULL)
+	    {
+	      memcpy(view, pc, view_size);
+	      delete[] pc;
+	    }
+	  else
+	    {
+	      section_size_type len;
+	      const unsigned char* p = this->section_contents(i, &len, false);
+	      if (!decompress_input_section(p, len, view, view_size))
+		this->error(_("could not decompress section %s"),
+			    this->section_name(i).c_str());
+	    }
         }
 
       pvs->view = view;
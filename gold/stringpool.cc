@@ -28,6 +28,7 @@
 
 #include "output.h"
 #include "parameters.h"
+#include "gold-threads.h"
 #include "stringpool.h"
 
 namespace gold
@@ -35,11 +36,13 @@ namespace gold
 
 template<typename Stringpool_char>
 Stringpool_template<Stringpool_char>::Stringpool_template(uint64_t addralign)
-  : string_set_(), key_to_offset_(), strings_(), strtab_size_(0),
+  : shards_(1), key_to_offset_(), strtab_size_(0),
     zero_null_(true), optimize_(false), offset_(sizeof(Stringpool_char)),
     addralign_(addralign)
 {
-  if (parameters->options_valid() && parameters->options().optimize() >= 2)
+  // Suffix merging is cheap enough to do by default, but an
+  // incremental link wants each string to keep its own space.
+  if (parameters->options_valid() && !parameters->incremental())
     this->optimize_ = true;
 }
 
@@ -47,19 +50,57 @@ template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::clear()
 {
-  for (typename std::list<Stringdata*>::iterator p = this->strings_.begin();
-       p != this->strings_.end();
-       ++p)
-    delete[] reinterpret_cast<char*>(*p);
-  this->strings_.clear();
+  for (typename Shards::iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    {
+      for (typename Stringdata_list::iterator p = ps->strings.begin();
+	   p != ps->strings.end();
+	   ++p)
+	delete[] reinterpret_cast<char*>(*p);
+      ps->strings.clear();
+      ps->string_set.clear();
+    }
   this->key_to_offset_.clear();
-  this->string_set_.clear();
 }
 
 template<typename Stringpool_char>
 Stringpool_template<Stringpool_char>::~Stringpool_template()
 {
   this->clear();
+  for (typename Shards::iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    delete ps->lock;
+}
+
+// Split the pool into shards for concurrent use.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::set_concurrent()
+{
+  gold_assert(this->string_count() == 0);
+  this->shards_.resize(concurrent_shard_count);
+  for (typename Shards::iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    if (ps->lock == NULL)
+      ps->lock = new Lock();
+}
+
+// Return the number of strings in the pool.
+
+template<typename Stringpool_char>
+size_t
+Stringpool_template<Stringpool_char>::string_count() const
+{
+  size_t count = 0;
+  for (typename Shards::const_iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    count += ps->string_set.size();
+  return count;
 }
 
 // Resize the internal hashtable with the expectation we'll get n new
@@ -73,22 +114,31 @@ Stringpool_template<Stringpool_char>::reserve(unsigned int n)
 {
   this->key_to_offset_.reserve(n);
 
+  // Assume that the strings will be spread evenly across the shards.
+  size_t shard_n = n / this->shards_.size();
+  for (typename Shards::iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    {
+      String_set_type& string_set(ps->string_set);
+
 #if defined(HAVE_UNORDERED_MAP)
-  this->string_set_.rehash(this->string_set_.size() + n);
-  return;
+      string_set.rehash(string_set.size() + shard_n);
+      continue;
 #elif defined(HAVE_TR1_UNORDERED_MAP)
-  // rehash() implementation is broken in gcc 4.0.3's stl
-  //this->string_set_.rehash(this->string_set_.size() + n);
-  //return;
+      // rehash() implementation is broken in gcc 4.0.3's stl
+      //string_set.rehash(string_set.size() + shard_n);
+      //continue;
 #elif defined(HAVE_EXT_HASH_MAP)
-  this->string_set_.resize(this->string_set_.size() + n);
-  return;
+      string_set.resize(string_set.size() + shard_n);
+      continue;
 #endif
 
-  // This is the generic "reserve" code, if no #ifdef above triggers.
-  String_set_type new_string_set(this->string_set_.size() + n);
-  new_string_set.insert(this->string_set_.begin(), this->string_set_.end());
-  this->string_set_.swap(new_string_set);
+      // This is the generic "reserve" code, if no #ifdef above triggers.
+      String_set_type new_string_set(string_set.size() + shard_n);
+      new_string_set.insert(string_set.begin(), string_set.end());
+      string_set.swap(new_string_set);
+    }
 }
 
 // Compare two strings of arbitrary character type for equality.
@@ -138,19 +188,16 @@ Stringpool_template<Stringpool_char>::string_hash(const Stringpool_char* s,
   return gold::string_hash<Stringpool_char>(s, length);
 }
 
-// Add the string S to the list of canonical strings.  Return a
-// pointer to the canonical string.  If PKEY is not NULL, set *PKEY to
-// the key.  LENGTH is the length of S in characters.  Note that S may
-// not be NUL terminated.
+// Add the string S to STRINGS, a list of canonical strings.  Return a
+// pointer to the canonical string.  LENGTH is the length of S in
+// characters.  Note that S may not be NUL terminated.
 
 template<typename Stringpool_char>
 const Stringpool_char*
-Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
+Stringpool_template<Stringpool_char>::add_string(Stringdata_list* strings,
+						 const Stringpool_char* s,
 						 size_t len)
 {
-  // We are in trouble if we've already computed the string offsets.
-  gold_assert(this->strtab_size_ == 0);
-
   // The size we allocate for a new Stringdata.
   const size_t buffer_size = 1000;
   // The amount we multiply the Stringdata index when calculating the
@@ -169,11 +216,11 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
       alc = sizeof(Stringdata) + len;
       front = false;
     }
-  else if (this->strings_.empty())
+  else if (strings->empty())
     alc = sizeof(Stringdata) + buffer_size;
   else
     {
-      Stringdata* psd = this->strings_.front();
+      Stringdata* psd = strings->front();
       if (len > psd->alc - psd->len)
 	alc = sizeof(Stringdata) + buffer_size;
       else
@@ -197,9 +244,9 @@ Stringpool_template<Stringpool_char>::add_string(const Stringpool_char* s,
   psd->len = len;
 
   if (front)
-    this->strings_.push_front(psd);
+    strings->push_front(psd);
   else
-    this->strings_.push_back(psd);
+    strings->push_back(psd);
 
   return reinterpret_cast<const Stringpool_char*>(psd->data);
 }
@@ -240,10 +287,28 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 						      size_t length,
 						      bool copy,
 						      Key* pkey)
+{
+  return this->add_prehashed(s, length, string_hash(s, length), copy, pkey);
+}
+
+// Add a string whose hash code has already been computed.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_prehashed(const Stringpool_char* s,
+						    size_t length,
+						    size_t hash_code,
+						    bool copy,
+						    Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
-  // We add 1 so that 0 is always invalid.
+  Shard& shard(this->shard(hash_code));
+  Hold_optional_lock hl(shard.lock);
+
+  // Keys are only assigned by add, which is never called by more
+  // than one thread at a time, so the next key does not change while
+  // we hold the shard lock.  We add 1 so that 0 is always invalid.
   const Key k = this->key_to_offset_.size() + 1;
 
   if (!copy)
@@ -251,11 +316,11 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(Hashkey(s, length, hash_code), k);
 
-      Insert_type ins = this->string_set_.insert(element);
+      Insert_type ins = shard.string_set.insert(element);
 
-      typename String_set_type::const_iterator p = ins.first;
+      typename String_set_type::iterator p = ins.first;
 
       if (ins.second)
 	{
@@ -263,6 +328,12 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 	  // used.
 	  this->new_key_offset(length);
 	}
+      else if (p->second == 0)
+	{
+	  // The string was interned but had no key.
+	  p->second = k;
+	  this->new_key_offset(length);
+	}
       else
 	{
 	  gold_assert(k != p->second);
@@ -278,24 +349,32 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   // canonicalize it by copying it into the canonical list. The hash
   // code will only be computed once.
 
-  Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
+  Hashkey hk(s, length, hash_code);
+  typename String_set_type::iterator p = shard.string_set.find(hk);
+  if (p != shard.string_set.end())
     {
+      if (p->second == 0)
+	{
+	  p->second = k;
+	  this->new_key_offset(length);
+	}
       if (pkey != NULL)
 	*pkey = p->second;
       return p->first.string;
     }
 
+  // We are in trouble if we've already computed the string offsets.
+  gold_assert(this->strtab_size_ == 0);
+
   this->new_key_offset(length);
 
-  hk.string = this->add_string(s, length);
+  hk.string = add_string(&shard.strings, s, length);
   // The contents of the string stay the same, so we don't need to
   // adjust hk.hash_code or hk.length.
 
   std::pair<Hashkey, Hashval> element(hk, k);
 
-  Insert_type ins = this->string_set_.insert(element);
+  Insert_type ins = shard.string_set.insert(element);
   gold_assert(ins.second);
 
   if (pkey != NULL)
@@ -303,14 +382,61 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   return hk.string;
 }
 
+// Intern a string without giving it a key.  This only touches the
+// shard which holds the string, so with a concurrent pool it may run
+// in several threads at once.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::intern(const Stringpool_char* s,
+					     size_t length,
+					     size_t hash_code,
+					     Key** pkey)
+{
+  Shard& shard(this->shard(hash_code));
+  Hold_optional_lock hl(shard.lock);
+
+  Hashkey hk(s, length, hash_code);
+  typename String_set_type::iterator p = shard.string_set.find(hk);
+  if (p == shard.string_set.end())
+    {
+      gold_assert(this->strtab_size_ == 0);
+      hk.string = add_string(&shard.strings, s, length);
+      std::pair<Hashkey, Hashval> element(hk, 0);
+      p = shard.string_set.insert(element).first;
+    }
+
+  // Elements of the hash table do not move when it grows, so the
+  // caller may hold on to the location of the key.
+  if (pkey != NULL)
+    *pkey = &p->second;
+  return p->first.string;
+}
+
+// Give an interned string a key.
+
+template<typename Stringpool_char>
+typename Stringpool_template<Stringpool_char>::Key
+Stringpool_template<Stringpool_char>::add_interned(Key* pkey, size_t length)
+{
+  if (*pkey == 0)
+    {
+      *pkey = this->key_to_offset_.size() + 1;
+      this->new_key_offset(length);
+    }
+  return *pkey;
+}
+
 template<typename Stringpool_char>
 const Stringpool_char*
 Stringpool_template<Stringpool_char>::find(const Stringpool_char* s,
 					   Key* pkey) const
 {
   Hashkey hk(s);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p == this->string_set_.end())
+  const Shard& shard(this->shard(hk.hash_code));
+  Hold_optional_lock hl(shard.lock);
+  typename String_set_type::const_iterator p = shard.string_set.find(hk);
+  if (p == shard.string_set.end() || p->second == 0)
     return NULL;
 
   if (pkey != NULL)
@@ -336,12 +462,10 @@ Stringpool_template<Stringpool_char>::Stringpool_sort_comparison::operator()(
   const Stringpool_sort_info& sort_info1,
   const Stringpool_sort_info& sort_info2) const
 {
-  const Hashkey& h1(sort_info1->first);
-  const Hashkey& h2(sort_info2->first);
-  const Stringpool_char* s1 = h1.string;
-  const Stringpool_char* s2 = h2.string;
-  const size_t len1 = h1.length;
-  const size_t len2 = h2.length;
+  const Stringpool_char* s1 = sort_info1.string;
+  const Stringpool_char* s2 = sort_info2.string;
+  const size_t len1 = sort_info1.length;
+  const size_t len2 = sort_info2.length;
   const size_t minlen = len1 < len2 ? len1 : len2;
   const Stringpool_char* p1 = s1 + len1 - 1;
   const Stringpool_char* p2 = s2 + len2 - 1;
@@ -367,6 +491,66 @@ Stringpool_template<Stringpool_char>::is_suffix(const Stringpool_char* s1,
   return memcmp(s1, s2 + len2 - len1, len1 * sizeof(Stringpool_char)) == 0;
 }
 
+// Sort strings for suffix merging.  This is a multikey quicksort on
+// the reversed strings: we partition on a single character at a time,
+// so strings which share a long suffix are not compared over and over
+// again from the end, as they are when using a comparison sort.  The
+// strings in the pool are distinct, so the result is the same as
+// sorting with Stringpool_sort_comparison.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::suffix_sort(Stringpool_sort_info* v,
+						  size_t n, size_t depth)
+{
+  while (n > 1)
+    {
+      if (n < 16)
+	{
+	  std::sort(v, v + n, Stringpool_sort_comparison());
+	  return;
+	}
+
+      // Use the median of three characters as the pivot.
+      long long a = suffix_sort_char(v[0], depth);
+      long long b = suffix_sort_char(v[n / 2], depth);
+      long long c = suffix_sort_char(v[n - 1], depth);
+      long long pivot;
+      if (a < b)
+	pivot = b < c ? b : (a < c ? c : a);
+      else
+	pivot = a < c ? a : (b < c ? c : b);
+
+      // Partition into strings with a larger character at DEPTH in
+      // [0, lt), an equal character in [lt, gt), and a smaller
+      // character in [gt, n).  Larger characters sort first.
+      size_t lt = 0;
+      size_t i = 0;
+      size_t gt = n;
+      while (i < gt)
+	{
+	  long long ch = suffix_sort_char(v[i], depth);
+	  if (ch > pivot)
+	    std::swap(v[lt++], v[i++]);
+	  else if (ch < pivot)
+	    std::swap(v[i], v[--gt]);
+	  else
+	    ++i;
+	}
+
+      suffix_sort(v, lt, depth);
+      suffix_sort(v + gt, n - gt, depth);
+
+      // Only one string can end at DEPTH.
+      if (pivot == suffix_sort_end)
+	return;
+
+      v += lt;
+      n = gt - lt;
+      ++depth;
+    }
+}
+
 // Turn the stringpool into an ELF strtab: determine the offsets of
 // each string in the table.
 
@@ -385,11 +569,9 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
   // Offset 0 may be reserved for the empty string.
   section_offset_type offset = this->zero_null_ ? charsize : 0;
 
-  // Sorting to find suffixes can take over 25% of the total CPU time
-  // used by the linker.  Since it's merely an optimization to reduce
-  // the strtab size, and gives a relatively small benefit (it's
-  // typically rare for a symbol to be a suffix of another), we only
-  // take the time to sort when the user asks for heavy optimization.
+  // Sorting to find suffixes used to take over 25% of the total CPU
+  // time used by the linker when done with std::sort.  suffix_sort
+  // avoids most of that cost, so we only skip it when asked to.
   if (!this->optimize_)
     {
       // If we are not optimizing, the offsets are already assigned.
@@ -397,17 +579,30 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
     }
   else
     {
-      size_t count = this->string_set_.size();
-
       std::vector<Stringpool_sort_info> v;
-      v.reserve(count);
-
-      for (typename String_set_type::iterator p = this->string_set_.begin();
-           p != this->string_set_.end();
-           ++p)
-        v.push_back(Stringpool_sort_info(p));
-
-      std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
+      v.reserve(this->string_count());
+
+      for (typename Shards::const_iterator ps = this->shards_.begin();
+	   ps != this->shards_.end();
+	   ++ps)
+	for (typename String_set_type::const_iterator p =
+	       ps->string_set.begin();
+	     p != ps->string_set.end();
+	     ++p)
+	  {
+	    // Strings which were only interned are not in the table.
+	    if (p->second == 0)
+	      continue;
+	    Stringpool_sort_info info;
+	    info.string = p->first.string;
+	    info.length = p->first.length;
+	    info.key = p->second;
+	    v.push_back(info);
+	  }
+      size_t count = v.size();
+
+      if (count > 0)
+	suffix_sort(&v[0], count, 0);
 
       section_offset_type last_offset = -1;
       for (typename std::vector<Stringpool_sort_info>::iterator last = v.end(),
@@ -416,22 +611,22 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
            last = curr++)
         {
 	  section_offset_type this_offset;
-          if (this->zero_null_ && (*curr)->first.string[0] == 0)
+          if (this->zero_null_ && curr->string[0] == 0)
             this_offset = 0;
           else if (last != v.end()
-                   && is_suffix((*curr)->first.string,
-				(*curr)->first.length,
-                                (*last)->first.string,
-				(*last)->first.length))
+                   && is_suffix(curr->string, curr->length,
+                                last->string, last->length)
+		   && this->suffix_is_aligned(last_offset
+					      + ((last->length - curr->length)
+						 * charsize)))
             this_offset = (last_offset
-			   + (((*last)->first.length - (*curr)->first.length)
-			      * charsize));
+			   + ((last->length - curr->length) * charsize));
           else
             {
               this_offset = align_address(offset, this->addralign_);
-              offset = this_offset + ((*curr)->first.length + 1) * charsize;
+              offset = this_offset + (curr->length + 1) * charsize;
             }
-	  this->key_to_offset_[(*curr)->second - 1] = this_offset;
+	  this->key_to_offset_[curr->key - 1] = this_offset;
 	  last_offset = this_offset;
         }
     }
@@ -458,8 +653,9 @@ Stringpool_template<Stringpool_char>::get_offset_with_length(
 {
   gold_assert(this->strtab_size_ != 0);
   Hashkey hk(s, length);
-  typename String_set_type::const_iterator p = this->string_set_.find(hk);
-  if (p != this->string_set_.end())
+  const Shard& shard(this->shard(hk.hash_code));
+  typename String_set_type::const_iterator p = shard.string_set.find(hk);
+  if (p != shard.string_set.end() && p->second != 0)
     return this->key_to_offset_[p->second - 1];
   gold_unreachable();
 }
@@ -476,16 +672,22 @@ Stringpool_template<Stringpool_char>::write_to_buffer(
   gold_assert(bufsize >= this->strtab_size_);
   if (this->zero_null_)
     buffer[0] = '\0';
-  for (typename String_set_type::const_iterator p = this->string_set_.begin();
-       p != this->string_set_.end();
-       ++p)
-    {
-      const int len = (p->first.length + 1) * sizeof(Stringpool_char);
-      const section_offset_type offset = this->key_to_offset_[p->second - 1];
-      gold_assert(static_cast<section_size_type>(offset) + len
-		  <= this->strtab_size_);
-      memcpy(buffer + offset, p->first.string, len);
-    }
+  for (typename Shards::const_iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    for (typename String_set_type::const_iterator p = ps->string_set.begin();
+	 p != ps->string_set.end();
+	 ++p)
+      {
+	if (p->second == 0)
+	  continue;
+	const int len = (p->first.length + 1) * sizeof(Stringpool_char);
+	const section_offset_type offset =
+	  this->key_to_offset_[p->second - 1];
+	gold_assert(static_cast<section_size_type>(offset) + len
+		    <= this->strtab_size_);
+	memcpy(buffer + offset, p->first.string, len);
+      }
 }
 
 // Write the ELF strtab into the output file at the specified offset.
@@ -506,16 +708,26 @@ template<typename Stringpool_char>
 void
 Stringpool_template<Stringpool_char>::print_stats(const char* name) const
 {
+  size_t buckets = 0;
+  size_t stringdata = 0;
+  for (typename Shards::const_iterator ps = this->shards_.begin();
+       ps != this->shards_.end();
+       ++ps)
+    {
+#if defined(HAVE_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+      buckets += ps->string_set.bucket_count();
+#endif
+      stringdata += ps->strings.size();
+    }
 #if defined(HAVE_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
   fprintf(stderr, _("%s: %s entries: %zu; buckets: %zu\n"),
-	  program_name, name, this->string_set_.size(),
-	  this->string_set_.bucket_count());
+	  program_name, name, this->string_count(), buckets);
 #else
   fprintf(stderr, _("%s: %s entries: %zu\n"),
-	  program_name, name, this->table_.size());
+	  program_name, name, this->string_count());
 #endif
   fprintf(stderr, _("%s: %s Stringdata structures: %zu\n"),
-	  program_name, name, this->strings_.size());
+	  program_name, name, stringdata);
 }
 
 // Instantiate the templates we need.
@@ -31,6 +31,7 @@ namespace gold
 {
 
 class Output_file;
+class Lock;
 
 // Return the length of a string in units of Char_type.
 
@@ -70,6 +71,15 @@ string_length(const char* p)
 // string pointer so that repeated runs of the linker will generate
 // precisely the same output.
 
+// Adding strings to a Stringpool is normally not thread safe.  A
+// Stringpool may be made concurrent, in which case strings may be
+// interned from several threads at once.  Interning a string does not
+// give it a key; it gets one when it is added in the ordinary way, so
+// the keys are still determined by the order of those calls.  Each
+// shard of a concurrent pool is protected by a lock; the pool is not
+// lock-free.  Only one thread at a time may add strings, although
+// other threads may intern strings while it does so.
+
 // When you add a string to a Stringpool, Stringpool will optionally
 // make a copy of it.  Thus there is no requirement to keep a copy
 // elsewhere.
@@ -200,18 +210,31 @@ class Stringpool_template
   void
   set_no_zero_null()
   {
-    gold_assert(this->string_set_.empty()
+    gold_assert(this->string_count() == 0
 		&& this->offset_ == sizeof(Stringpool_char));
     this->zero_null_ = false;
     this->offset_ = 0;
   }
 
+  // Split the pool into shards, each with its own lock and storage,
+  // so that intern may be called from several threads at once.  This
+  // must be called before any strings are added.
+  void
+  set_concurrent();
+
   // Indicate that this string pool should be optimized, even if not
   // running with -O2.
   void
   set_optimize()
   { this->optimize_ = true; }
 
+  // Indicate that this string pool should not be optimized.  This is
+  // for callers that use the offsets returned by get_offset_from_key
+  // before calling set_string_offsets.
+  void
+  set_no_optimize()
+  { this->optimize_ = false; }
+
   // Add the string S to the pool.  This returns a canonical permanent
   // pointer to the string in the pool.  If COPY is true, the string
   // is copied into permanent storage.  If PKEY is not NULL, this sets
@@ -229,6 +252,39 @@ class Stringpool_template
   const Stringpool_char*
   add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
 
+  // Compute a hash code for a string.  LENGTH is the length of the
+  // string in characters.
+  static size_t
+  string_hash(const Stringpool_char*, size_t length);
+
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value of string_hash(S, LEN).  This permits the
+  // hash code to be computed in advance, possibly in a different
+  // thread.
+  const Stringpool_char*
+  add_prehashed(const Stringpool_char* s, size_t len, size_t hash_code,
+		bool copy, Key* pkey);
+
+  // Copy string S of length LEN characters into the pool if it is not
+  // already there, and return the canonical string pointer.
+  // HASH_CODE is the value of string_hash(S, LEN).  This does not
+  // assign a key; that happens when the string is passed to add or
+  // add_interned.  If PKEY is not NULL, set *PKEY to the location of
+  // the key, for add_interned.  If set_concurrent has been called,
+  // this may be called from several threads at once, and at the same
+  // time as add.
+  const Stringpool_char*
+  intern(const Stringpool_char* s, size_t len, size_t hash_code,
+	 Key** pkey = NULL);
+
+  // Give the interned string whose key is stored at PKEY, as returned
+  // by intern, a key if it does not already have one, and return the
+  // key.  LEN is the length of the string in characters.  This avoids
+  // looking the string up again, but it may not be called at the same
+  // time as intern.
+  Key
+  add_interned(Key* pkey, size_t len);
+
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
   // set *PKEY to the key.
@@ -297,11 +353,6 @@ class Stringpool_template
   static bool
   string_equal(const Stringpool_char*, const Stringpool_char*);
 
-  // Compute a hash code for a string.  LENGTH is the length of the
-  // string in characters.
-  static size_t
-  string_hash(const Stringpool_char*, size_t length);
-
   // We store the actual data in a list of these buffers.
   struct Stringdata
   {
@@ -317,9 +368,12 @@ class Stringpool_template
   void
   new_key_offset(size_t);
 
+  // List of Stringdata structures.
+  typedef std::list<Stringdata*> Stringdata_list;
+
   // Copy a string into the buffers, returning a canonical string.
-  const Stringpool_char*
-  add_string(const Stringpool_char*, size_t);
+  static const Stringpool_char*
+  add_string(Stringdata_list*, const Stringpool_char*, size_t);
 
   // Return whether s1 is a suffix of s2.
   static bool
@@ -353,6 +407,10 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
@@ -380,7 +438,17 @@ class Stringpool_template
 
   // Comparison routine used when sorting into a string table.
 
-  typedef typename String_set_type::iterator Stringpool_sort_info;
+  // We copy the strings out of the hash table before sorting them, so
+  // that the sort does not have to chase pointers into the table.
+  struct Stringpool_sort_info
+  {
+    // The string.
+    const Stringpool_char* string;
+    // Length in characters.
+    size_t length;
+    // The key of the string.
+    Hashval key;
+  };
 
   struct Stringpool_sort_comparison
   {
@@ -388,19 +456,79 @@ class Stringpool_template
     operator()(const Stringpool_sort_info&, const Stringpool_sort_info&) const;
   };
 
+  // Sort V, an array of N strings whose last DEPTH characters are
+  // known to be equal, into the order given by
+  // Stringpool_sort_comparison.
+  static void
+  suffix_sort(Stringpool_sort_info* v, size_t n, size_t depth);
+
+  // Return the character DEPTH characters from the end of the string
+  // in SORT_INFO, or suffix_sort_end if the string is not that long.
+  static long long
+  suffix_sort_char(const Stringpool_sort_info& sort_info, size_t depth)
+  {
+    if (depth >= sort_info.length)
+      return suffix_sort_end;
+    return static_cast<long long>(sort_info.string[sort_info.length - 1
+                                                   - depth]);
+  }
+
+  // A value which sorts before every character.
+  static const long long suffix_sort_end = -0x100000000LL;
+
+  // Return whether a string may be placed at OFFSET, inside another
+  // string, without breaking the alignment of the pool.
+  bool
+  suffix_is_aligned(section_offset_type offset) const
+  { return this->addralign_ <= 1 || offset % this->addralign_ == 0; }
+
   // Keys map to offsets via a Chunked_vector.  We only use the
   // offsets if we turn this into an string table section.
   typedef Chunked_vector<section_offset_type> Key_to_offset;
 
-  // List of Stringdata structures.
-  typedef std::list<Stringdata*> Stringdata_list;
+  // A part of the pool.  Each string lives in the shard selected by
+  // its hash code.  A string which has been interned but not yet
+  // added has a key of zero.
+  struct Shard
+  {
+    Shard()
+      : string_set(), strings(), lock(NULL)
+    { }
+
+    // Mapping from const char* to namepool entry.
+    String_set_type string_set;
+    // List of buffers.
+    Stringdata_list strings;
+    // Lock to hold while using this shard, or NULL if the pool is not
+    // concurrent.
+    Lock* lock;
+  };
+
+  typedef std::vector<Shard> Shards;
+
+  // The number of shards in a concurrent pool.  This must be a power
+  // of two.
+  static const unsigned int concurrent_shard_count = 64;
+
+  // Return the shard to use for a string with hash code HASH_CODE.
+  // The low bits of the hash code select the bucket within the hash
+  // table, so we use higher ones here.
+  Shard&
+  shard(size_t hash_code)
+  { return this->shards_[(hash_code >> 20) & (this->shards_.size() - 1)]; }
+
+  const Shard&
+  shard(size_t hash_code) const
+  { return this->shards_[(hash_code >> 20) & (this->shards_.size() - 1)]; }
+
+  // Return the number of strings in the pool.
+  size_t
+  string_count() const;
 
-  // Mapping from const char* to namepool entry.
-  String_set_type string_set_;
+  // The shards.  There is only one unless set_concurrent was called.
+  Shards shards_;
   // Mapping from Key to string table offset.
   Key_to_offset key_to_offset_;
-  // List of buffers.
-  Stringdata_list strings_;
   // Size of string table.
   section_size_type strtab_size_;
   // Whether to reserve offset 0 to hold the null string.
@@ -531,10 +531,13 @@ Symbol::set_output_section(Output_section* os)
 
 Symbol_table::Symbol_table(unsigned int count,
                            const Version_script_info& version_script)
-  : saw_undefined_(0), offset_(0), table_(count), namepool_(),
+  : saw_undefined_(0), offset_(0), table_(count), output_symbols_(),
+    namepool_(),
     forwarders_(), commons_(), tls_commons_(), small_commons_(),
     large_commons_(), forced_locals_(), warnings_(),
-    version_script_(version_script), gc_(NULL), icf_(NULL)
+    candidate_odr_violations_(), odr_linenos_(), odr_linenos_found_(false),
+    odr_line_cache_(NULL), version_script_(version_script), gc_(NULL),
+    icf_(NULL)
 {
   namepool_.reserve(count);
 }
@@ -1080,6 +1083,7 @@ Symbol_table::add_from_relobj(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Global_symbol_name* global_names,
     typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
     size_t* defined)
 {
@@ -1131,10 +1135,15 @@ Symbol_table::add_from_relobj(
 	  is_defined_in_discarded_section = true;
 	}
 
+      // The name may have been split and hashed in advance.
+      const Global_symbol_name* gsn = (global_names != NULL
+				       ? &global_names[i]
+				       : NULL);
+
       // In an object file, an '@' in the name separates the symbol
       // name from the version name.  If there are two '@' characters,
       // this is the default version.
-      const char* ver = strchr(name, '@');
+      const char* ver = gsn != NULL ? gsn->version : strchr(name, '@');
       Stringpool::Key ver_key = 0;
       int namelen = 0;
       // IS_DEFAULT_VERSION: is the version default?
@@ -1160,14 +1169,19 @@ Symbol_table::add_from_relobj(
 	      is_default_version = true;
 	      ++ver;
 	    }
-	  ver = this->namepool_.add(ver, true, &ver_key);
+	  if (gsn != NULL)
+	    ver = this->namepool_.add_prehashed(ver, gsn->version_length,
+						gsn->version_hash, true,
+						&ver_key);
+	  else
+	    ver = this->namepool_.add(ver, true, &ver_key);
         }
       // We don't want to assign a version to an undefined symbol,
       // even if it is listed in the version script.  FIXME: What
       // about a common symbol?
       else
 	{
-	  namelen = strlen(name);
+	  namelen = gsn != NULL ? gsn->name_length : strlen(name);
 	  if (!this->version_script_.empty()
 	      && st_shndx != elfcpp::SHN_UNDEF)
 	    {
@@ -1239,8 +1253,12 @@ Symbol_table::add_from_relobj(
         }
 
       Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+      if (gsn != NULL)
+	name = this->namepool_.add_prehashed(name, namelen, gsn->name_hash,
+					     true, &name_key);
+      else
+	name = this->namepool_.add_with_length(name, namelen, true,
+					       &name_key);
 
       Sized_symbol<size>* res;
       res = this->add_from_object(relobj, name, name_key, ver, ver_key,
@@ -2525,7 +2543,13 @@ Symbol_table::sized_finalize(off_t off, Stringpool* pool,
 	}
     }
 
-  // Now do all the remaining symbols.
+  // Now do all the remaining symbols.  Remember the order, so that
+  // the symbols can be written out in ranges.  Warn about unresolved
+  // symbols in shared libraries here rather than when writing the
+  // symbols, so that the warnings come out in symbol order even when
+  // the ranges are written in parallel.
+  this->output_symbols_.clear();
+  this->output_symbols_.reserve(this->table_.size());
   for (Symbol_table_type::iterator p = this->table_.begin();
        p != this->table_.end();
        ++p)
@@ -2533,6 +2557,8 @@ Symbol_table::sized_finalize(off_t off, Stringpool* pool,
       Symbol* sym = p->second;
       if (this->sized_finalize_symbol<size>(sym))
 	this->add_to_final_symtab<size>(sym, pool, &index, &off);
+      this->output_symbols_.push_back(sym);
+      this->warn_about_undefined_dynobj_symbol(sym);
     }
 
   this->output_count_ = index - orig_index;
@@ -2768,32 +2794,33 @@ Symbol_table::write_globals(const Stringpool* sympool,
 			    const Stringpool* dynpool,
 			    Output_symtab_xindex* symtab_xindex,
 			    Output_symtab_xindex* dynsym_xindex,
-			    Output_file* of) const
+			    Output_file* of, size_t first,
+			    size_t last) const
 {
   switch (parameters->size_and_endianness())
     {
 #ifdef HAVE_TARGET_32_LITTLE
     case Parameters::TARGET_32_LITTLE:
       this->sized_write_globals<32, false>(sympool, dynpool, symtab_xindex,
-					   dynsym_xindex, of);
+					   dynsym_xindex, of, first, last);
       break;
 #endif
 #ifdef HAVE_TARGET_32_BIG
     case Parameters::TARGET_32_BIG:
       this->sized_write_globals<32, true>(sympool, dynpool, symtab_xindex,
-					  dynsym_xindex, of);
+					  dynsym_xindex, of, first, last);
       break;
 #endif
 #ifdef HAVE_TARGET_64_LITTLE
     case Parameters::TARGET_64_LITTLE:
       this->sized_write_globals<64, false>(sympool, dynpool, symtab_xindex,
-					   dynsym_xindex, of);
+					   dynsym_xindex, of, first, last);
       break;
 #endif
 #ifdef HAVE_TARGET_64_BIG
     case Parameters::TARGET_64_BIG:
       this->sized_write_globals<64, true>(sympool, dynpool, symtab_xindex,
-					  dynsym_xindex, of);
+					  dynsym_xindex, of, first, last);
       break;
 #endif
     default:
@@ -2801,7 +2828,9 @@ Symbol_table::write_globals(const Stringpool* sympool,
     }
 }
 
-// Write out the global symbols.
+// Write out the global symbols numbered from FIRST to LAST - 1 in
+// output_symbols_.  The output symbol indexes were assigned by
+// finalize, so different ranges write different parts of the views.
 
 template<int size, bool big_endian>
 void
@@ -2809,7 +2838,8 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
 				  const Stringpool* dynpool,
 				  Output_symtab_xindex* symtab_xindex,
 				  Output_symtab_xindex* dynsym_xindex,
-				  Output_file* of) const
+				  Output_file* of, size_t first,
+				  size_t last) const
 {
   const Target& target = parameters->target();
 
@@ -2834,14 +2864,11 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
   else
     dynamic_view = of->get_output_view(this->dynamic_offset_, dynamic_size);
 
-  for (Symbol_table_type::const_iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  gold_assert(first <= last && last <= this->output_symbols_.size());
+  for (size_t i = first; i < last; ++i)
     {
-      Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
-
-      // Possibly warn about unresolved symbols in shared libraries.
-      this->warn_about_undefined_dynobj_symbol(sym);
+      Sized_symbol<size>* sym =
+	static_cast<Sized_symbol<size>*>(this->output_symbols_[i]);
 
       unsigned int sym_index = sym->symtab_index();
       unsigned int dynsym_index;
@@ -3196,26 +3223,19 @@ struct Odr_violation_compare
 };
 
 // Returns all of the lines attached to LOC, not just the one the
-// instruction actually came from.
+// instruction actually came from.  TASK must hold the lock of LOC's
+// object.
+
 std::vector<std::string>
-Symbol_table::linenos_from_loc(const Task* task,
+Symbol_table::linenos_from_loc(const Task* task, Addr2line_cache* cache,
                                const Symbol_location& loc)
 {
-  // We need to lock the object in order to read it.  This
-  // means that we have to run in a singleton Task.  If we
-  // want to run this in a general Task for better
-  // performance, we will need one Task for object, plus
-  // appropriate locking to ensure that we don't conflict with
-  // other uses of the object.  Also note, one_addr2line is not
-  // currently thread-safe.
-  Task_lock_obj<Object> tl(task, loc.object);
-
   std::vector<std::string> result;
   Symbol_location code_loc = loc;
   parameters->target().function_location(&code_loc);
-  // 16 is the size of the object-cache that one_addr2line should use.
-  std::string canonical_result = Dwarf_line_info::one_addr2line(
-      code_loc.object, code_loc.shndx, code_loc.offset, 16, &result);
+  std::string canonical_result = cache->addr2line(task, code_loc.object,
+                                                  code_loc.shndx,
+                                                  code_loc.offset, &result);
   if (!canonical_result.empty())
     result.push_back(canonical_result);
   return result;
@@ -3250,28 +3270,173 @@ struct Check_intersection
   bool value_;
 };
 
+// Group the locations of the candidate ODR violations by object, in
+// the order we first see them.  A symbol with a single location can
+// not be a violation, so we skip it.
+
+void
+Symbol_table::collect_odr_locations()
+{
+  if (!this->odr_linenos_.empty() || this->odr_linenos_found_)
+    return;
+
+  Unordered_map<Object*, Odr_object_linenos*> objects;
+  for (Odr_map::const_iterator it = this->candidate_odr_violations_.begin();
+       it != this->candidate_odr_violations_.end();
+       ++it)
+    {
+      if (it->second.size() < 2)
+        continue;
+      for (Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
+             locs = it->second.begin();
+           locs != it->second.end();
+           ++locs)
+        {
+          Odr_object_linenos*& ol(objects[locs->object]);
+          if (ol == NULL)
+            {
+              ol = new Odr_object_linenos(locs->object);
+              this->odr_linenos_.push_back(ol);
+            }
+          ol->locs.push_back(*locs);
+        }
+    }
+
+  if (!this->odr_linenos_.empty())
+    this->odr_line_cache_ = new Addr2line_cache();
+}
+
+// Find the sorted line numbers for each location in one object.  TASK
+// must hold the lock of the object.  We drop the line tables when we
+// are done, as no other location refers to this object.
+
+void
+Symbol_table::find_odr_linenos(const Task* task, Odr_object_linenos* ol)
+{
+  ol->linenos.resize(ol->locs.size());
+  for (size_t i = 0; i < ol->locs.size(); ++i)
+    {
+      std::vector<std::string>& linenos(ol->linenos[i]);
+      linenos = Symbol_table::linenos_from_loc(task, this->odr_line_cache_,
+                                               ol->locs[i]);
+      // Sort by Odr_violation_compare to make std::set_intersection work.
+      std::sort(linenos.begin(), linenos.end(), Odr_violation_compare());
+    }
+  this->odr_line_cache_->release_object(ol->object);
+}
+
+// A task to find the line numbers of the candidate ODR violations in
+// one object.
+
+class Symbol_table::Odr_linenos_task : public Task
+{
+ public:
+  Odr_linenos_task(Symbol_table* symtab, Odr_object_linenos* ol,
+                   Task_token* blocker)
+    : symtab_(symtab), ol_(ol), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->ol_->object->is_locked())
+      return this->ol_->object->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->ol_->object->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->symtab_->find_odr_linenos(this, this->ol_);
+    this->ol_->object->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Odr_linenos_task " + this->ol_->object->name(); }
+
+ private:
+  Symbol_table* symtab_;
+  Odr_object_linenos* ol_;
+  Task_token* blocker_;
+};
+
+// Add the tasks which find the line numbers of the candidate ODR
+// violations.  detect_odr_violations then only compares them.
+
+void
+Symbol_table::add_odr_tasks(Task_token* blocker, std::vector<Task*>* tasks)
+{
+  this->collect_odr_locations();
+  for (Odr_linenos_list::const_iterator p = this->odr_linenos_.begin();
+       p != this->odr_linenos_.end();
+       ++p)
+    tasks->push_back(new Odr_linenos_task(this, *p, blocker));
+  this->odr_linenos_found_ = true;
+}
+
 // Check candidate_odr_violations_ to find symbols with the same name
 // but apparently different definitions (different source-file/line-no
 // for each line assigned to the first instruction).
 
 void
 Symbol_table::detect_odr_violations(const Task* task,
-				    const char* output_file_name) const
+				    const char* output_file_name)
 {
+  // If add_odr_tasks was not called, find the line numbers now.
+  if (!this->odr_linenos_found_)
+    {
+      this->collect_odr_locations();
+      for (Odr_linenos_list::const_iterator p = this->odr_linenos_.begin();
+           p != this->odr_linenos_.end();
+           ++p)
+        {
+          Task_lock_obj<Object> tl(task, (*p)->object);
+          this->find_odr_linenos(task, *p);
+        }
+      this->odr_linenos_found_ = true;
+    }
+
+  Unordered_map<Symbol_location, const std::vector<std::string>*,
+                Symbol_location_hash> linenos_map;
+  for (Odr_linenos_list::const_iterator p = this->odr_linenos_.begin();
+       p != this->odr_linenos_.end();
+       ++p)
+    for (size_t i = 0; i < (*p)->locs.size(); ++i)
+      linenos_map[(*p)->locs[i]] = &(*p)->linenos[i];
+
   for (Odr_map::const_iterator it = candidate_odr_violations_.begin();
        it != candidate_odr_violations_.end();
        ++it)
     {
+      if (it->second.size() < 2)
+        continue;
+
       const char* const symbol_name = it->first;
 
       std::string first_object_name;
-      std::vector<std::string> first_object_linenos;
+      const std::vector<std::string>* first_object_linenos = NULL;
 
       Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
           locs = it->second.begin();
       const Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
           locs_end = it->second.end();
-      for (; locs != locs_end && first_object_linenos.empty(); ++locs)
+      for (;
+           (locs != locs_end
+            && (first_object_linenos == NULL
+                || first_object_linenos->empty()));
+           ++locs)
         {
           // Save the line numbers from the first definition to
           // compare to the other definitions.  Ideally, we'd compare
@@ -3280,26 +3445,19 @@ Symbol_table::detect_odr_violations(const Task* task,
           // false negatives that appear or disappear depending on the
           // link order, but it won't cause false positives.
           first_object_name = locs->object->name();
-          first_object_linenos = this->linenos_from_loc(task, *locs);
+          first_object_linenos = linenos_map[*locs];
         }
 
-      // Sort by Odr_violation_compare to make std::set_intersection work.
-      std::sort(first_object_linenos.begin(), first_object_linenos.end(),
-                Odr_violation_compare());
-
       for (; locs != locs_end; ++locs)
         {
-          std::vector<std::string> linenos =
-              this->linenos_from_loc(task, *locs);
+          const std::vector<std::string>& linenos(*linenos_map[*locs]);
           // linenos will be empty if we couldn't parse the debug info.
           if (linenos.empty())
             continue;
-          // Sort by Odr_violation_compare to make std::set_intersection work.
-          std::sort(linenos.begin(), linenos.end(), Odr_violation_compare());
 
           Check_intersection intersection_result =
-              std::set_intersection(first_object_linenos.begin(),
-                                    first_object_linenos.end(),
+              std::set_intersection(first_object_linenos->begin(),
+                                    first_object_linenos->end(),
                                     linenos.begin(),
                                     linenos.end(),
                                     Check_intersection(),
@@ -3313,10 +3471,10 @@ Symbol_table::detect_odr_violations(const Task* task,
               // which may not be the location we expect to intersect
               // with another definition.  We could print the whole
               // set of locations, but that seems too verbose.
-              gold_assert(!first_object_linenos.empty());
+              gold_assert(!first_object_linenos->empty());
               gold_assert(!linenos.empty());
               fprintf(stderr, _("  %s from %s\n"),
-                      first_object_linenos[0].c_str(),
+                      (*first_object_linenos)[0].c_str(),
                       first_object_name.c_str());
               fprintf(stderr, _("  %s from %s\n"),
                       linenos[0].c_str(),
@@ -3331,8 +3489,15 @@ Symbol_table::detect_odr_violations(const Task* task,
             }
         }
     }
-  // We only call one_addr2line() in this function, so we can clear its cache.
-  Dwarf_line_info::clear_addr2line_cache();
+
+  // We no longer need the line numbers.
+  for (Odr_linenos_list::iterator p = this->odr_linenos_.begin();
+       p != this->odr_linenos_.end();
+       ++p)
+    delete *p;
+  this->odr_linenos_.clear();
+  delete this->odr_line_cache_;
+  this->odr_line_cache_ = NULL;
 }
 
 // Warnings functions.
@@ -3414,6 +3579,7 @@ Symbol_table::add_from_relobj<32, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Global_symbol_name* global_names,
     Sized_relobj_file<32, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3428,6 +3594,7 @@ Symbol_table::add_from_relobj<32, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Global_symbol_name* global_names,
     Sized_relobj_file<32, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3442,6 +3609,7 @@ Symbol_table::add_from_relobj<64, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Global_symbol_name* global_names,
     Sized_relobj_file<64, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3456,6 +3624,7 @@ Symbol_table::add_from_relobj<64, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Global_symbol_name* global_names,
     Sized_relobj_file<64, true>::Symbols* sympointers,
     size_t* defined);
 #endif
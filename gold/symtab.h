@@ -60,6 +60,8 @@ class Output_file;
 class Output_symtab_xindex;
 class Garbage_collection;
 class Icf;
+class Addr2line_cache;
+class Task_token;
 
 // The base class of an entry in the symbol table.  The symbol table
 // can have a lot of entries, so we don't want this class too big.
@@ -1357,15 +1359,17 @@ class Symbol_table
   // Add COUNT external symbols from the relocatable object RELOBJ to
   // the symbol table.  SYMS is the symbols, SYMNDX_OFFSET is the
   // offset in the symbol table of the first symbol, SYM_NAMES is
-  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  This sets
-  // SYMPOINTERS to point to the symbols in the symbol table.  It sets
-  // *DEFINED to the number of defined symbols.
+  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.
+  // GLOBAL_NAMES, if not NULL, is COUNT precomputed names and hash
+  // codes.  This sets SYMPOINTERS to point to the symbols in the
+  // symbol table.  It sets *DEFINED to the number of defined symbols.
   template<int size, bool big_endian>
   void
   add_from_relobj(Sized_relobj_file<size, big_endian>* relobj,
 		  const unsigned char* syms, size_t count,
 		  size_t symndx_offset, const char* sym_names,
 		  size_t sym_name_size,
+		  const Global_symbol_name* global_names,
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
@@ -1491,10 +1495,16 @@ class Symbol_table
 		size_t relnum, off_t reloffset) const
   { this->warnings_.issue_warning(sym, relinfo, relnum, reloffset); }
 
+  // Add to TASKS the tasks which find the line numbers of the
+  // candidate ODR violations in parallel, one task per object.  Each
+  // task will unblock BLOCKER.
+  void
+  add_odr_tasks(Task_token* blocker, std::vector<Task*>* tasks);
+
   // Check candidate_odr_violations_ to find symbols with the same name
   // but apparently different definitions (different source-file/line-no).
   void
-  detect_odr_violations(const Task*, const char* output_file_name) const;
+  detect_odr_violations(const Task*, const char* output_file_name);
 
   // Add any undefined symbols named on the command line to the symbol
   // table.
@@ -1563,11 +1573,18 @@ class Symbol_table
   output_count() const
   { return this->output_count_; }
 
-  // Write out the global symbols.
+  // Return the number of symbols which write_globals looks at.
+  size_t
+  output_symbols_count() const
+  { return this->output_symbols_.size(); }
+
+  // Write out the global symbols numbered from FIRST to LAST - 1 in
+  // the order used by finalize.  This may be called in parallel for
+  // different ranges.
   void
   write_globals(const Stringpool*, const Stringpool*,
 		Output_symtab_xindex*, Output_symtab_xindex*,
-		Output_file*) const;
+		Output_file*, size_t first, size_t last) const;
 
   // Write out a section symbol.  Return the updated offset.
   void
@@ -1641,6 +1658,24 @@ class Symbol_table
                         Unordered_set<Symbol_location, Symbol_location_hash> >
   Odr_map;
 
+  // The locations in one object of the candidate ODR violations, and
+  // the sorted line numbers found for each of them.
+  struct Odr_object_linenos
+  {
+    Odr_object_linenos(Object* obj)
+      : object(obj), locs(), linenos()
+    { }
+
+    Object* object;
+    std::vector<Symbol_location> locs;
+    std::vector<std::vector<std::string> > linenos;
+  };
+
+  typedef std::vector<Odr_object_linenos*> Odr_linenos_list;
+
+  // A task to find the line numbers in one object.
+  class Odr_linenos_task;
+
   // Make FROM a forwarder symbol to TO.
   void
   make_forwarder(Symbol* from, Symbol* to);
@@ -1791,9 +1826,20 @@ class Symbol_table
 
   // Returns all of the lines attached to LOC, not just the one the
   // instruction actually came from.  This helps the ODR checker avoid
-  // false positives.
+  // false positives.  TASK must hold the lock of LOC's object.
   static std::vector<std::string>
-  linenos_from_loc(const Task* task, const Symbol_location& loc);
+  linenos_from_loc(const Task* task, Addr2line_cache* cache,
+		   const Symbol_location& loc);
+
+  // Group the locations in candidate_odr_violations_ by object into
+  // odr_linenos_.
+  void
+  collect_odr_locations();
+
+  // Find the line numbers for the locations in one object, whose lock
+  // TASK holds.
+  void
+  find_odr_linenos(const Task* task, Odr_object_linenos*);
 
   // Implement detect_odr_violations.
   template<int size, bool big_endian>
@@ -1821,7 +1867,7 @@ class Symbol_table
   void
   sized_write_globals(const Stringpool*, const Stringpool*,
 		      Output_symtab_xindex*, Output_symtab_xindex*,
-		      Output_file*) const;
+		      Output_file*, size_t, size_t) const;
 
   // Write out a symbol to P.
   template<int size, bool big_endian>
@@ -1866,6 +1912,9 @@ class Symbol_table
   unsigned int dynamic_count_;
   // The symbol hash table.
   Symbol_table_type table_;
+  // The symbols in table_, in the order used by finalize.  This is
+  // set by finalize so that write_globals can work on ranges.
+  std::vector<Symbol*> output_symbols_;
   // A pool of symbol names.  This is used for all global symbols.
   // Entries in the hash table point into this pool.
   Stringpool namepool_;
@@ -1895,6 +1944,12 @@ class Symbol_table
   Warnings warnings_;
   // Manage potential One Definition Rule (ODR) violations.
   Odr_map candidate_odr_violations_;
+  // The locations of the candidate ODR violations grouped by object,
+  // and whether their line numbers have been found.
+  Odr_linenos_list odr_linenos_;
+  bool odr_linenos_found_;
+  // The line tables read to find them.
+  Addr2line_cache* odr_line_cache_;
 
   // When we emit a COPY reloc for a symbol, we define it in an
   // Output_data.  When it's time to emit version information for it,
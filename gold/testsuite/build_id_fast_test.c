@@ -0,0 +1,57 @@
+/* build_id_fast_test.c -- test --build-id=fast.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   --build-id=fast hashes each chunk of the output file in its own
+   task.  This file has a table which spans many chunks, and functions
+   whose debug information does too, so that the output has several
+   sections of different kinds to hash, with gaps between them.  When
+   the debug sections are compressed, the output file only gets its
+   final size after the input sections have been written.  */
+
+struct point
+{
+  int x;
+  int y;
+};
+
+int table[4096] = { 1, 2, 3 };
+
+#define FUNC(n)					\
+  int						\
+  func_##n (struct point p)			\
+  {						\
+    int sum_##n = p.x * n + p.y;		\
+    table[n] += sum_##n;			\
+    return table[n + 1] + sum_##n;		\
+  }
+
+#define FUNC8(n) \
+  FUNC(n##0) FUNC(n##1) FUNC(n##2) FUNC(n##3) \
+  FUNC(n##4) FUNC(n##5) FUNC(n##6) FUNC(n##7)
+
+FUNC8(1) FUNC8(2) FUNC8(3) FUNC8(4) FUNC8(5) FUNC8(6) FUNC8(7)
+
+int
+main (void)
+{
+  struct point p = { 1, 2 };
+  return func_10 (p) + func_77 (p);
+}
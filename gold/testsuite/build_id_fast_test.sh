@@ -0,0 +1,72 @@
+#!/bin/sh
+
+# build_id_fast_test.sh -- test --build-id=fast
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# --build-id=fast hashes each chunk of the output in its own task.
+# Check that the build ID is 16 bytes, that it does not depend on the
+# number of threads, and that it does depend on the chunk size.  With
+# --compress-debug-sections the file is resized after the input
+# sections are written, and the chunks must be hashed after that.
+
+build_id()
+{
+    sed -n 's/^ *Build ID: \([0-9a-f]*\)$/\1/p' "$1"
+}
+
+id=$(build_id build_id_fast_test.stdout)
+if test ${#id} -ne 32; then
+    echo "Expected a 16 byte build ID in build_id_fast_test.stdout:"
+    cat build_id_fast_test.stdout
+    exit 1
+fi
+
+for f in build_id_fast_test_2 build_id_fast_test_nothreads; do
+    if test "$(build_id $f.stdout)" != "$id"; then
+	echo "Build IDs of build_id_fast_test and $f differ"
+	exit 1
+    fi
+done
+
+if test "$(build_id build_id_fast_test_chunk.stdout)" = "$id"; then
+    echo "Build ID does not depend on the chunk size"
+    exit 1
+fi
+
+if ! grep -q '\.zdebug_info' build_id_fast_test_zlib.sections; then
+    echo "Missing .zdebug_info in build_id_fast_test_zlib.sections:"
+    cat build_id_fast_test_zlib.sections
+    exit 1
+fi
+
+zid=$(build_id build_id_fast_test_zlib.stdout)
+if test ${#zid} -ne 32 || test "$zid" = "$id"; then
+    echo "Bad build ID $zid in build_id_fast_test_zlib.stdout"
+    exit 1
+fi
+
+if test "$(build_id build_id_fast_test_zlib_nothreads.stdout)" != "$zid"; then
+    echo "Build IDs of build_id_fast_test_zlib and build_id_fast_test_zlib_nothreads differ"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,50 @@
+/* build_id_tree_test.c -- test --build-id=tree.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   --build-id=tree hashes each chunk of the output file as soon as the
+   sections covering it are written.  The aligned table here leaves a
+   gap of padding before it, which no task writes, and the functions
+   give the output debug information, which may be compressed.  */
+
+int small_data = 1;
+
+int aligned_table[1024] __attribute__ ((aligned (4096))) = { 1, 2, 3 };
+
+#define FUNC(n)					\
+  int						\
+  func_##n (int x)				\
+  {						\
+    int sum_##n = x * n + small_data;		\
+    aligned_table[n] += sum_##n;		\
+    return aligned_table[n + 1] + sum_##n;	\
+  }
+
+#define FUNC8(n) \
+  FUNC(n##0) FUNC(n##1) FUNC(n##2) FUNC(n##3) \
+  FUNC(n##4) FUNC(n##5) FUNC(n##6) FUNC(n##7)
+
+FUNC8(1) FUNC8(2) FUNC8(3) FUNC8(4)
+
+int
+main (void)
+{
+  return func_10 (1) + func_47 (2);
+}
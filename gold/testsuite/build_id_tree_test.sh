@@ -0,0 +1,122 @@
+#!/bin/sh
+
+# build_id_tree_test.sh -- check --build-id=tree
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# --build-id=tree hashes each chunk of the output as soon as the
+# sections covering it are written.  Recompute the build ID from the
+# final file, with the build ID note zeroed as it was when it was
+# hashed, and check that it matches the one in the file, so that no
+# chunk was hashed before it was complete.  The output has a gap of
+# padding between two sections, which no task writes.  The build ID
+# must also not depend on the number of threads.  With
+# --compress-debug-sections the file is resized after the input
+# sections are written, and must be hashed after that.
+
+build_id()
+{
+    sed -n 's/^ *Build ID: \([0-9a-f]*\)$/\1/p' "$1"
+}
+
+# Check that the build ID of $1 matches its contents.
+check_contents()
+{
+    id=$(build_id $1.stdout)
+    if test ${#id} -ne 40; then
+	echo "Expected a 20 byte build ID in $1.stdout:"
+	cat $1.stdout
+	exit 1
+    fi
+
+    # The descriptor of the note follows the 12 byte header and the
+    # name "GNU\0".
+    off=$(sed -n 's/^.*\] \.note\.gnu\.build-id *NOTE *[0-9a-f]* \([0-9a-f]*\) .*$/\1/p' $1.sections)
+    if test -z "$off"; then
+	echo "Missing .note.gnu.build-id in $1.sections:"
+	cat $1.sections
+	exit 1
+    fi
+    off=$((0x$off + 16))
+
+    rm -f $1.zeroed $1.chunk.*
+    cp $1 $1.zeroed
+    dd if=/dev/zero of=$1.zeroed bs=1 seek=$off count=20 \
+      conv=notrunc 2>/dev/null
+    split -b 256 -a 4 $1.zeroed $1.chunk.
+
+    hashes=$(for f in $1.chunk.*; do
+	       md5sum < $f | sed 's/ .*//'
+	     done)
+    expected=$(for h in $hashes; do
+		 for b in $(echo $h | sed 's/\(..\)/\1 /g'); do
+		   printf "\\$(printf %o 0x$b)"
+		 done
+	       done | sha1sum | sed 's/ .*//')
+    rm -f $1.chunk.*
+
+    if test "$expected" != "$id"; then
+	echo "Build ID $id of $1 does not match its contents ($expected)"
+	exit 1
+    fi
+}
+
+# Check that some section of $1 starts after the end of the one
+# before it in the file.
+check_gap()
+{
+    gap=no
+    end=
+    for s in $(sed -n 's/^ *\[ *[0-9]*\] [^ ]* *\([A-Z_]*\) *[0-9a-f]* \([0-9a-f]*\) \([0-9a-f]*\) .*$/\1:\2:\3/p' $1.sections); do
+	set -- $1 $(echo $s | tr : ' ')
+	case $2 in
+	  NULL | NOBITS) ;;
+	  *)
+	    if test -n "$end" && test $((0x$3)) -gt $end; then
+		gap=yes
+	    fi
+	    end=$((0x$3 + 0x$4))
+	    ;;
+	esac
+	set -- $1
+    done
+    if test "$gap" != "yes"; then
+	echo "No gap between the sections in $1.sections:"
+	cat $1.sections
+	exit 1
+    fi
+}
+
+check_contents build_id_tree_test
+check_gap build_id_tree_test
+if test "$(build_id build_id_tree_test_nothreads.stdout)" != "$id"; then
+    echo "Build IDs of build_id_tree_test and build_id_tree_test_nothreads differ"
+    exit 1
+fi
+
+check_contents build_id_tree_test_zlib
+if ! grep -q '\.zdebug_info' build_id_tree_test_zlib.sections; then
+    echo "Missing .zdebug_info in build_id_tree_test_zlib.sections:"
+    cat build_id_tree_test_zlib.sections
+    exit 1
+fi
+
+exit 0
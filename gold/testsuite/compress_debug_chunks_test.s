@@ -0,0 +1,16 @@
+# compress_debug_chunks_test.s: an object with 1.5 MiB of debug
+# information, so that --compress-debug-sections splits the section
+# into more than one chunk.  The contents are pseudo-random, so that
+# they do not compress to almost nothing.
+
+	.text
+	.globl	main
+main:
+	.long	0
+
+	.section	.debug_ranges,"",@progbits
+	.set	v, 1
+	.rept	196608
+	.quad	v
+	.set	v, (v * 1103515245 + 12345) & 0x7fffffff
+	.endr
@@ -0,0 +1,58 @@
+#!/bin/sh
+
+# compress_debug_chunks_test.sh -- test --compress-debug-sections with several chunks.
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# --compress-debug-sections compresses each 1 MiB chunk of a section in
+# its own task, and joins the chunks into a single zlib stream.
+# compress_debug_chunks_test_dec is the compressed output after
+# decompressing it with objcopy.  Check that its debug section is the
+# same as in an uncompressed link, and that the output does not depend
+# on the number of threads.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check compress_debug_chunks_test.sections '\.zdebug_ranges'
+
+if ! cmp -s compress_debug_chunks_test_dec.stdout \
+    compress_debug_chunks_test_none.stdout; then
+    echo "Decompressed .debug_ranges differs from the uncompressed link"
+    exit 1
+fi
+
+if ! cmp -s compress_debug_chunks_test compress_debug_chunks_test_nothreads; then
+    echo "compress_debug_chunks_test and compress_debug_chunks_test_nothreads differ"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,78 @@
+#!/bin/sh
+
+# decompress_cache_test.sh -- test --decompress-cache-size
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The inputs have compressed debug sections.  Their decompressed
+# contents may be cached, up to --decompress-cache-size.  The small
+# links use a cache of 4096 bytes, which holds the short sections but
+# not .debug_info or .debug_str.  Check that every link of the
+# compressed objects, whatever the cache size and with or without
+# --threads, writes the same output as a link of the same objects
+# compiled without compression.
+
+check()
+{
+    if ! grep -q "$2" $1
+    then
+	echo "Did not find expected section in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+# check_size FILE SECTION: check that SECTION is bigger than the cache.
+check_size()
+{
+    size=`sed -n -e "s/.* $2 *PROGBITS *[0-9a-f]* [0-9a-f]* \([0-9a-f]*\) .*/\1/p" $1`
+    if test -z "$size" || test `printf "%d" 0x$size` -le 4096; then
+	echo "$2 in $1 is not bigger than 4096 bytes:"
+	cat $1
+	exit 1
+    fi
+}
+
+check decompress_cache_test_1.stdout "\.zdebug_info "
+check decompress_cache_test_1.stdout "\.zdebug_str "
+check_size decompress_cache_test_ref.stdout .debug_info
+check_size decompress_cache_test_ref.stdout .debug_str
+
+for f in decompress_cache_test decompress_cache_test_none \
+	 decompress_cache_test_small decompress_cache_test_threads \
+	 decompress_cache_test_threads_small; do
+    if ! cmp -s decompress_cache_test_ref $f; then
+	echo "decompress_cache_test_ref and $f differ"
+	exit 1
+    fi
+done
+
+for f in decompress_cache_test_gdb_index decompress_cache_test_gdb_index_none; do
+    if ! cmp -s decompress_cache_test_gdb_index_ref $f; then
+	echo "decompress_cache_test_gdb_index_ref and $f differ"
+	exit 1
+    fi
+done
+
+exit 0
@@ -0,0 +1,55 @@
+/* decompress_cache_test_2.c -- test --decompress-cache-size, file 2 of 2.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   See decompress_cache_test_1.c.  */
+
+#define FUNC_PREFIX sum_2
+
+#define FUNC_NAME(p, n) FUNC_NAME2 (p, n)
+#define FUNC_NAME2(p, n) p##_##n
+
+#define STRUCT(n)						\
+  struct record_##n							\
+  {									\
+    int record_##n##_first_field;					\
+    long record_##n##_second_field;					\
+    const char* record_##n##_third_field;				\
+    struct record_##n* record_##n##_next;				\
+  };									\
+  int									\
+  FUNC_NAME (FUNC_PREFIX, n) (struct record_##n* r)			\
+  {									\
+    int total_##n = 0;							\
+    for (; r != 0; r = r->record_##n##_next)				\
+      total_##n += r->record_##n##_first_field				\
+		   + (int) r->record_##n##_second_field;		\
+    return total_##n;							\
+  }
+
+#define STRUCT8(n) \
+  STRUCT(n##0) STRUCT(n##1) STRUCT(n##2) STRUCT(n##3) \
+  STRUCT(n##4) STRUCT(n##5) STRUCT(n##6) STRUCT(n##7)
+
+#define STRUCT64(n) \
+  STRUCT8(n##0) STRUCT8(n##1) STRUCT8(n##2) STRUCT8(n##3) \
+  STRUCT8(n##4) STRUCT8(n##5) STRUCT8(n##6) STRUCT8(n##7)
+
+STRUCT64(1) STRUCT64(2)
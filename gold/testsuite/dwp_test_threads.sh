@@ -0,0 +1,36 @@
+#!/bin/sh
+
+# dwp_test_threads.sh -- test dwp --threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# With --threads, dwp reads its input files in parallel.  Check that
+# the packages are the same as those built with --no-threads, both from
+# .dwo files and from other packages.
+
+for f in dwp_test_1 dwp_test_2; do
+    if ! cmp -s $f.dwp ${f}_threads.dwp; then
+	echo "$f.dwp and ${f}_threads.dwp differ"
+	exit 1
+    fi
+done
+
+exit 0
@@ -0,0 +1,92 @@
+#!/bin/sh
+
+# dwp_test_update.sh -- test dwp --update
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# dwp_test_update_old.dwp was built for an executable using
+# dwp_test_2.dwo.  dwp_test_update_new.dwp was updated from it for an
+# executable using dwp_test_3.dwo instead, as if dwp_test_2.cc had
+# changed.  Check that only dwp_test_3.dwo was read, and that the
+# package has the same units and strings as a full repackage.
+# dwp_test_update_drop.dwp was updated for an executable that no longer
+# uses dwp_test_2.dwo.  Check that its unit and strings were dropped.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_num()
+{
+    n=$(grep -c "$2" "$1")
+    if test "$n" -ne "$3"
+    then
+	echo "Found $n occurrences (should find $3):"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check dwp_test_update_new.stderr "^dwp_test_3.dwo$"
+check_num dwp_test_update_new.stderr "\.dwo$" 1
+
+# The units are in a different order, so compare only the names, DWO
+# IDs and strings.
+units()
+{
+    grep "DW_AT_name\|DW_AT_GNU_dwo_id\|^  \[" "$1" \
+	| sed -e 's/^ *<[0-9a-f]*> *//' -e 's/^ *\[ *[0-9a-f]*\] *//' \
+	| sort
+}
+
+units dwp_test_update_new.stdout > dwp_test_update_new.units
+units dwp_test_update_new_full.stdout > dwp_test_update_new_full.units
+if ! cmp -s dwp_test_update_new.units dwp_test_update_new_full.units; then
+    echo "dwp_test_update_new.dwp and dwp_test_update_new_full.dwp differ:"
+    diff dwp_test_update_new.units dwp_test_update_new_full.units
+    exit 1
+fi
+
+check_num dwp_test_update_drop.stdout "DW_TAG_compile_unit" 3
+check dwp_test_update_drop.stdout "^String dump of section '.debug_str.dwo'"
+if sed -n '/^String dump/,$p' dwp_test_update_drop.stdout \
+    | grep -q "_ZN2C13t1aEv\|_ZN2C32f4Ev"
+then
+    echo "Strings used only by dwp_test_2.dwo were not dropped:"
+    echo ""
+    echo "Actual output below:"
+    cat dwp_test_update_drop.stdout
+    exit 1
+fi
+
+exit 0
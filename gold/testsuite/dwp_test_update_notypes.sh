@@ -0,0 +1,83 @@
+#!/bin/sh
+
+# dwp_test_update_notypes.sh -- test dwp --update without type units.
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# dwp_test_update_notypes_old.dwp has no type units, so it has an
+# empty .debug_tu_index section and no .debug_types.dwo section.
+# dwp_test_update_notypes_new.dwp was updated from it for an
+# executable using dwp_test_update_notypes_3.dwo instead of
+# dwp_test_update_notypes_2.dwo.  Check that only the new .dwo file
+# was read, and that the package has the same units as a full
+# repackage.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_num()
+{
+    n=$(grep -c "$2" "$1")
+    if test "$n" -ne "$3"
+    then
+	echo "Found $n occurrences (should find $3):"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check dwp_test_update_notypes_new.stderr "^dwp_test_update_notypes_3.dwo$"
+check_num dwp_test_update_notypes_new.stderr "\.dwo$" 1
+
+check_num dwp_test_update_notypes_new.stdout "DW_TAG_compile_unit" 2
+check_num dwp_test_update_notypes_new.stdout "DW_TAG_type_unit" 0
+
+# The units may be in a different order, so compare only the names
+# and DWO IDs.
+units()
+{
+    grep "DW_AT_name\|DW_AT_GNU_dwo_id" "$1" \
+	| sed -e 's/^ *<[0-9a-f]*> *//' \
+	| sort
+}
+
+units dwp_test_update_notypes_new.stdout > dwp_test_update_notypes_new.units
+units dwp_test_update_notypes_full.stdout > dwp_test_update_notypes_full.units
+if ! cmp -s dwp_test_update_notypes_new.units dwp_test_update_notypes_full.units; then
+    echo "dwp_test_update_notypes_new.dwp and dwp_test_update_notypes_full.dwp differ:"
+    diff dwp_test_update_notypes_new.units dwp_test_update_notypes_full.units
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,38 @@
+/* dwp_test_update_notypes_1.c -- test dwp --update without type units.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This file and dwp_test_update_notypes_2.c are compiled with
+   -gsplit-dwarf but without -fdebug-types-section, so the package
+   built from them has no type units.  */
+
+extern int f2 (int);
+
+int
+f1 (int x)
+{
+  return x + 1;
+}
+
+int
+main (void)
+{
+  return f1 (2) + f2 (3);
+}
@@ -0,0 +1,34 @@
+/* dwp_test_update_notypes_2.c -- test dwp --update without type units.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This file is also compiled with -DCHANGED, as if it had been
+   edited, to give a compilation unit with a different DWO ID.  */
+
+int
+f2 (int x)
+{
+#ifdef CHANGED
+  int y = x * 3;
+  return y;
+#else
+  return x * 2;
+#endif
+}
@@ -0,0 +1,72 @@
+#!/bin/sh
+
+# gc_threads_test.sh -- test --gc-sections with --threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The relocs used by --gc-sections are processed by one task per
+# object when linking with --threads.  Check that the same sections
+# are collected, and that the output is the same, as when linking with
+# --no-threads.
+
+check_collected()
+{
+    if ! grep -q "removing unused section from '\.$2' in file '[^']*'" $1
+    then
+	echo "$2 was not collected in $1:"
+	cat $1
+	exit 1
+    fi
+}
+
+check_kept()
+{
+    if grep -q "removing unused section from '\.$2' in file" $1
+    then
+	echo "$2 was collected in $1:"
+	cat $1
+	exit 1
+    fi
+}
+
+for f in gc_threads_test.stderr gc_threads_test_nothreads.stderr; do
+    check_collected $f text.unused_func_1
+    check_collected $f text.unused_func_2
+    check_collected $f data.unused_data_1
+    check_collected $f data.unused_data_2
+    check_kept $f text.used_func_1
+    check_kept $f text.used_func_2
+    check_kept $f data.used_data_1
+    check_kept $f data.used_data_2
+done
+
+if ! cmp -s gc_threads_test.stderr gc_threads_test_nothreads.stderr; then
+    echo "--threads collected different sections:"
+    diff gc_threads_test.stderr gc_threads_test_nothreads.stderr
+    exit 1
+fi
+
+if ! cmp -s gc_threads_test gc_threads_test_nothreads; then
+    echo "gc_threads_test and gc_threads_test_nothreads differ"
+    exit 1
+fi
+
+exit 0
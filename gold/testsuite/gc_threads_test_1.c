@@ -0,0 +1,56 @@
+/* gc_threads_test_1.c -- test --gc-sections with --threads, file 1 of 2.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The relocs used by --gc-sections are read by one task per object.
+   The used_* functions here are reached from main through references
+   between the two files, and the unused_* functions refer to each
+   other but are not reached.  Linking with --threads must collect the
+   same sections, and produce the same output, as linking with
+   --no-threads.  */
+
+extern int used_data_2;
+int used_data_1 = 1;
+int unused_data_1 = 1;
+
+extern int used_func_2 (int);
+extern int unused_func_2 (int);
+
+int
+used_func_1 (int x)
+{
+  if (x <= 0)
+    return used_data_2;
+  return used_func_2 (x - 1) + used_data_1;
+}
+
+int
+unused_func_1 (int x)
+{
+  if (x <= 0)
+    return unused_data_1;
+  return unused_func_2 (x - 1);
+}
+
+int
+main (void)
+{
+  return used_func_1 (3);
+}
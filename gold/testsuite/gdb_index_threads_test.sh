@@ -0,0 +1,80 @@
+#!/bin/sh
+
+# gdb_index_threads_test.sh -- test --gdb-index with threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# With --threads, the DWARF of each object is scanned for --gdb-index
+# in its own task, and the results are merged in input order.  Check
+# that the index lists the right compilation units for names found in
+# one object and for names found in two, that the address table covers
+# each object, and that the output does not depend on the number of
+# threads.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+# Print each symbol in the index on one line, as "NAME: CU...".
+awk '/^\[ *[0-9]+\] / { if (entry != "") print entry
+			  sub(/^\[ *[0-9]+\] /, "")
+			  entry = $0
+			  sub(/ \[.*/, "", entry)
+			  next }
+     /^\t[0-9]/ && entry != "" { entry = entry " " $1; next }
+     { if (entry != "") print entry; entry = "" }
+     END { if (entry != "") print entry }' \
+    gdb_index_threads_test.stdout > gdb_index_threads_test.symbols
+
+check gdb_index_threads_test.stdout "^\[ *3\] "
+for cu in 0 1 2 3; do
+    check gdb_index_threads_test.stdout "^[0-9a-f]\{16\} [0-9a-f]\{16\} $cu\$"
+done
+
+check gdb_index_threads_test.symbols "^one::c1v: 0\$"
+check gdb_index_threads_test.symbols "^gdb_index_test_main: 0\$"
+check gdb_index_threads_test.symbols "^gdb_index_test_3_main: 1\$"
+check gdb_index_threads_test.symbols "^gdb_index_threads_func_3: 2\$"
+check gdb_index_threads_test.symbols "^gdb_index_threads_count_3: 2\$"
+check gdb_index_threads_test.symbols "^gdb_index_threads_func_4: 3\$"
+check gdb_index_threads_test.symbols "^gdb_index_threads_color_4: 3\$"
+check gdb_index_threads_test.symbols "^gdb_index_threads_color: 3\$"
+check gdb_index_threads_test.symbols "^GDB_INDEX_THREADS_GREEN: 3\$"
+check gdb_index_threads_test.symbols "^gdb_index_threads_helper: 2 3\$"
+check gdb_index_threads_test.symbols "^gdb_index_threads_point: 2 3\$"
+
+for f in gdb_index_threads_test_2 gdb_index_threads_test_nothreads; do
+    if ! cmp -s gdb_index_threads_test $f; then
+	echo "gdb_index_threads_test and $f differ"
+	exit 1
+    fi
+done
+
+exit 0
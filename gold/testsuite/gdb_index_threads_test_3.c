@@ -0,0 +1,50 @@
+/* gdb_index_threads_test_3.c -- test --gdb-index with --threads.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The DWARF of each object is scanned for --gdb-index in its own task
+   when linking with --threads, and the results are merged.  This file
+   and gdb_index_threads_test_4.c both define the struct
+   gdb_index_threads_point and a static function
+   gdb_index_threads_helper, so the index must list both of their
+   compilation units for those names.  Each file also has names of its
+   own.  */
+
+struct gdb_index_threads_point
+{
+  int x;
+  int y;
+};
+
+int gdb_index_threads_count_3;
+
+static int
+gdb_index_threads_helper (struct gdb_index_threads_point p)
+{
+  return p.x + p.y;
+}
+
+int
+gdb_index_threads_func_3 (int i)
+{
+  struct gdb_index_threads_point p = { i, 3 };
+  gdb_index_threads_count_3 += i;
+  return gdb_index_threads_helper (p);
+}
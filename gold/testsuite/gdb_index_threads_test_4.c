@@ -0,0 +1,58 @@
+/* gdb_index_threads_test_4.c -- test --gdb-index with --threads.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   See gdb_index_threads_test_3.c.  */
+
+struct gdb_index_threads_point
+{
+  int x;
+  int y;
+};
+
+enum gdb_index_threads_color
+{
+  GDB_INDEX_THREADS_RED,
+  GDB_INDEX_THREADS_GREEN
+};
+
+enum gdb_index_threads_color gdb_index_threads_color_4;
+
+extern int gdb_index_threads_func_3 (int);
+
+static int
+gdb_index_threads_helper (struct gdb_index_threads_point p)
+{
+  return p.x * p.y;
+}
+
+int
+gdb_index_threads_func_4 (int i)
+{
+  struct gdb_index_threads_point p = { i, 4 };
+  return (gdb_index_threads_helper (p) + gdb_index_threads_func_3 (i)
+	  + (int) gdb_index_threads_color_4);
+}
+
+int
+main (void)
+{
+  return gdb_index_threads_func_4 (1);
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+
+# icf_threads_test.sh -- test --icf with --threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The section keys for --icf are computed in parallel when linking
+# with --threads.  Check that the same sections are folded, and that
+# the output is the same, as when linking with --no-threads.
+
+check_folded()
+{
+    if ! grep -q "folding section '\.text\.$2' in file '[^']*' *into '\.text\.$3'" $1
+    then
+	echo "$2 was not folded into $3 in $1:"
+	cat $1
+	exit 1
+    fi
+}
+
+for f in icf_threads_test.stderr icf_threads_test_nothreads.stderr; do
+    check_folded $f folded_add_2 folded_add_1
+    check_folded $f folded_str_2 folded_str_1
+    check_folded $f folded_data_2 folded_data_1
+    check_folded $f folded_call_2 folded_call_1
+done
+
+if ! cmp -s icf_threads_test.stderr icf_threads_test_nothreads.stderr; then
+    echo "--threads folded different sections:"
+    diff icf_threads_test.stderr icf_threads_test_nothreads.stderr
+    exit 1
+fi
+
+if ! cmp -s icf_threads_test icf_threads_test_nothreads; then
+    echo "icf_threads_test and icf_threads_test_nothreads differ"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,73 @@
+/* icf_threads_test_1.c -- test --icf with --threads, file 1 of 2.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The section keys used by --icf are computed by one task per
+   object.  The functions here are identical to functions in
+   icf_threads_test_2.c, and some of them refer to merged strings or
+   to data in the other file.  Linking with --threads must fold the
+   same functions, and produce the same output, as linking with
+   --no-threads.  */
+
+extern int icf_data_2;
+int icf_data_1 = 1;
+
+extern int folded_add_2 (int);
+extern const char *folded_str_2 (void);
+extern int folded_data_2 (void);
+extern int folded_call_2 (int);
+
+int
+folded_add_1 (int x)
+{
+  return x * 3 + 7;
+}
+
+const char *
+folded_str_1 (void)
+{
+  return "a string in a merged section";
+}
+
+int
+folded_data_1 (void)
+{
+  return icf_data_2 + 11;
+}
+
+int
+folded_call_1 (int x)
+{
+  return folded_add_1 (x) + folded_add_2 (x + 1);
+}
+
+int
+kept_str_1 (void)
+{
+  return folded_str_1 ()[0];
+}
+
+int
+main (void)
+{
+  return (folded_add_1 (1) + folded_add_2 (2) + folded_data_1 ()
+	  + folded_data_2 () + folded_call_1 (3) + folded_call_2 (4)
+	  + kept_str_1 () + (folded_str_2 () != 0));
+}
@@ -0,0 +1,50 @@
+/* icf_threads_test_2.c -- test --icf with --threads, file 2 of 2.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   See icf_threads_test_1.c.  */
+
+int icf_data_2 = 2;
+
+extern int folded_add_1 (int);
+
+int
+folded_add_2 (int x)
+{
+  return x * 3 + 7;
+}
+
+const char *
+folded_str_2 (void)
+{
+  return "a string in a merged section";
+}
+
+int
+folded_data_2 (void)
+{
+  return icf_data_2 + 11;
+}
+
+int
+folded_call_2 (int x)
+{
+  return folded_add_1 (x) + folded_add_2 (x + 1);
+}
@@ -0,0 +1,81 @@
+#!/bin/sh
+
+# incremental_check_hash_test.sh -- test --incremental-check-hash
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The test links incremental_check_hash_test_tmp.o without and with
+# --incremental-check-hash, then touches it without changing it and
+# does an incremental update.  The input must be found unchanged by its
+# hash, and its new timestamp must be recorded, so that the next update
+# does not need to hash it again.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+# Print the line of the entry for the temporary object in the
+# incremental-dump output $1 which matches $2.
+entry()
+{
+    awk '/^\[[0-9]*\] / { in_entry = ($2 == "incremental_check_hash_test_tmp.o"); }
+	 in_entry && /'"$2"'/ { print; }' "$1"
+}
+
+if grep -q "Content Hash" incremental_check_hash_test_nohash.stdout
+then
+    echo "Found a content hash without --incremental-check-hash"
+    exit 1
+fi
+
+check incremental_check_hash_test_full.stdout "Content Hash"
+check incremental_check_hash_test.log \
+    "incremental_check_hash_test_tmp.o: timestamp changed but contents did not"
+
+old_hash=`entry incremental_check_hash_test_full.stdout "Content Hash"`
+new_hash=`entry incremental_check_hash_test.stdout "Content Hash"`
+if test -z "$old_hash" || test "$old_hash" != "$new_hash"
+then
+    echo "Content hash changed:"
+    echo "   $old_hash"
+    echo "   $new_hash"
+    exit 1
+fi
+
+old_time=`entry incremental_check_hash_test_full.stdout "Timestamp"`
+new_time=`entry incremental_check_hash_test.stdout "Timestamp"`
+if test -z "$new_time" || test "$old_time" = "$new_time"
+then
+    echo "New timestamp was not recorded:"
+    echo "   $old_time"
+    echo "   $new_time"
+    exit 1
+fi
+
+exit 0
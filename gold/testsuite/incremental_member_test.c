@@ -0,0 +1,42 @@
+/* incremental_member_test.c -- test incremental update of archive members
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The archive for the test has a member compiled with MEMBER_A, and
+   a member compiled with MEMBER_B, which is rebuilt with a different
+   value of MEMBER_B to change it.  */
+
+#ifdef MEMBER_A
+
+int
+member_a(void)
+{
+  return 1;
+}
+
+#else
+
+int
+member_b(void)
+{
+  return MEMBER_B;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#!/bin/sh
+
+# incremental_member_test.sh -- test incremental update of archive members
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The test links an archive of two members with --incremental-check-hash,
+# then rebuilds the archive with only the second member changed, and
+# does an incremental update.  The first member must be kept from the
+# previous link, and the second must be read again.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+archive=incremental_member_test.a
+check incremental_member_test.log \
+    "$archive(incremental_member_test_a.o): unchanged member of changed archive"
+check_missing incremental_member_test.log \
+    "$archive(incremental_member_test_b.o): unchanged member"
+
+old_a=`grep "Member 0:" incremental_member_test_full.stdout`
+new_a=`grep "Member 0:" incremental_member_test.stdout`
+if test -z "$old_a" || test "$old_a" != "$new_a"
+then
+    echo "Unchanged member was not kept:"
+    echo "   $old_a"
+    echo "   $new_a"
+    exit 1
+fi
+
+old_b=`grep "Member 1:" incremental_member_test_full.stdout`
+new_b=`grep "Member 1:" incremental_member_test.stdout`
+if test -z "$new_b" || test "$old_b" = "$new_b"
+then
+    echo "Changed member was not read again:"
+    echo "   $old_b"
+    echo "   $new_b"
+    exit 1
+fi
+
+exit 0
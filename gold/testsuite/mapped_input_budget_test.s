@@ -0,0 +1,5 @@
+# mapped_input_budget_test.s: an object which is large enough to go
+# over --mapped-input-budget=1 on its own.
+
+	.data
+	.fill	1048576,1,1
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# mapped_input_budget_test.sh -- test --mapped-input-budget
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# Each input file is mapped as a whole, and by default the views stay
+# mapped until the end of the link.  With --mapped-input-budget=1 they
+# should be unmapped once more than a megabyte is mapped, unless the
+# user asked for --keep-files-mapped.  The output must not change.
+
+max_mapped()
+{
+    sed -n 's/^.*maximum bytes mapped for read at one time: \([0-9]*\)$/\1/p' "$1"
+}
+
+for f in mapped_input_budget_test_1 mapped_input_budget_test_keep; do
+    if ! cmp -s mapped_input_budget_test $f; then
+	echo "mapped_input_budget_test and $f differ"
+	exit 1
+    fi
+done
+
+all=$(max_mapped mapped_input_budget_test.stats)
+budget=$(max_mapped mapped_input_budget_test_1.stats)
+keep=$(max_mapped mapped_input_budget_test_keep.stats)
+if test -z "$all" || test -z "$budget" || test -z "$keep"; then
+    echo "Missing --stats output"
+    exit 1
+fi
+
+if test "$budget" -ge "$all"; then
+    echo "--mapped-input-budget=1 did not reduce the mapped input ($budget >= $all)"
+    exit 1
+fi
+
+if test "$keep" -ne "$all"; then
+    echo "--mapped-input-budget=1 --keep-files-mapped unmapped input ($keep != $all)"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,77 @@
+#!/bin/sh
+
+# odr_threads_test.sh -- test --detect-odr-violations with --threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# With --threads the line tables used by --detect-odr-violations are
+# read by one task per object.  Each odr_fn_N is defined differently
+# in two of the four objects.  Check that each is reported with those
+# two files, and that the same reports are made with --no-threads.
+# The order of the reports, and of the two files in each, depends on
+# hash table order, so compare them one location per line, sorted.
+
+locations()
+{
+    awk "/possible ODR violation/ { sym = \$0;
+				    sub(/.*symbol '/, \"\", sym);
+				    sub(/'.*/, \"\", sym);
+				    next }
+	 /^  / { file = \$1; sub(/:.*/, \"\", file);
+		 print sym \" \" file \" \" \$3 }" $1 | sort
+}
+
+check()
+{
+    if ! grep -q "$2" $1
+    then
+	echo "Did not find expected location in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+locations odr_threads_test.err > odr_threads_test.locs
+locations odr_threads_test_nothreads.err > odr_threads_test_nothreads.locs
+
+for f in odr_threads_test.locs odr_threads_test_nothreads.locs; do
+    if test "`wc -l < $f`" -ne 8; then
+	echo "Expected 8 locations in $f:"
+	cat $f
+	exit 1
+    fi
+    for i in 1 2 3 4; do
+	j=`expr $i % 4 + 1`
+	check $f "^odr_fn_$i(int) .*odr_threads_test_$i.cc odr_threads_test_$i.o\$"
+	check $f "^odr_fn_$i(int) .*odr_threads_test_$j.cc odr_threads_test_$j.o\$"
+    done
+done
+
+if ! cmp -s odr_threads_test.locs odr_threads_test_nothreads.locs; then
+    echo "--threads reported different ODR violations:"
+    diff odr_threads_test.locs odr_threads_test_nothreads.locs
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,52 @@
+// odr_threads_test_1.cc -- ODR checks with --threads, file 1 of 4.
+//
+// Copyright 2026 Free Software Foundation, Inc.
+//
+// This file is part of gold.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// Each odr_fn_N is defined differently in odr_threads_test_N.cc and
+// in the next file, so --detect-odr-violations reports each of them
+// with the same two files whether the line numbers of the four
+// objects are read by one task per object or all in one thread.
+
+inline int
+odr_fn_1(int x)
+{
+  return x * 2 + 1;
+}
+
+inline int
+odr_fn_4(int x)
+{
+  int y = x - 1;
+  return y * y;
+}
+
+extern "C" int
+use_1(int x)
+{
+  return odr_fn_1(x) + odr_fn_4(x);
+}
+
+extern "C" int use_2(int), use_3(int), use_4(int);
+
+int
+main()
+{
+  return use_1(1) + use_2(2) + use_3(3) + use_4(4);
+}
@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# prehash_symbols_test.sh -- test --prehash-symbols
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# With --prehash-symbols, the global symbol names are split and hashed
+# while the objects are read in parallel.  Check that both versions of
+# prehash_sym are defined, and that the output is the same as without
+# --prehash-symbols, and as without --threads.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check prehash_symbols_test.stdout " prehash_sym@VER_1$"
+check prehash_symbols_test.stdout " prehash_sym@@VER_2$"
+check prehash_symbols_test.stdout " prehash_defined_2@@VER_2$"
+
+for f in prehash_symbols_test_noprehash.so prehash_symbols_test_nothreads.so; do
+    if ! cmp -s prehash_symbols_test.so $f; then
+	echo "prehash_symbols_test.so and $f differ"
+	exit 1
+    fi
+done
+
+exit 0
@@ -0,0 +1,52 @@
+/* prehash_symbols_test_1.c -- test --prehash-symbols, file 1 of 2.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   With --prehash-symbols, the names of the global symbols are split
+   into name and version and hashed while the objects are read in
+   parallel.  This file defines two versions of one symbol, and
+   prehash_symbols_test_2.c refers to them, so that the prehashed
+   versions are used.  */
+
+int prehash_sym_v1 (void);
+int prehash_sym_v2 (void);
+
+__asm__ (".symver prehash_sym_v1,prehash_sym@VER_1");
+__asm__ (".symver prehash_sym_v2,prehash_sym@@VER_2");
+
+int
+prehash_sym_v1 (void)
+{
+  return 1;
+}
+
+int
+prehash_sym_v2 (void)
+{
+  return 2;
+}
+
+int prehash_common;
+
+int
+prehash_defined_1 (void)
+{
+  return prehash_common;
+}
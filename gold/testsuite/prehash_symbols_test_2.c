@@ -0,0 +1,36 @@
+/* prehash_symbols_test_2.c -- test --prehash-symbols, file 2 of 2.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This refers to the default version of the symbol defined in
+   prehash_symbols_test_1.c, and to a name which is not defined.  */
+
+extern int prehash_sym (void);
+extern int prehash_defined_1 (void);
+extern int prehash_undefined (void) __attribute__ ((weak));
+
+int prehash_common;
+
+int
+prehash_defined_2 (void)
+{
+  return (prehash_sym () + prehash_defined_1 ()
+	  + (prehash_undefined ? prehash_undefined () : 0));
+}
@@ -0,0 +1,111 @@
+#!/bin/sh
+
+# trace_profile_test.sh -- test --trace-profile
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# Check that the trace written by --trace-profile is well formed JSON
+# in the form the workqueue writes it: one thread name event for each
+# thread, followed by one complete event per line for each task.  Each
+# task runs once, so the per-object tasks must appear once for each
+# object.  Apart from the merge string tasks, which only run with
+# --threads, the same tasks must run with --threads and without.
+
+# check_format FILE THREADS
+check_format()
+{
+    awk -v threads=$2 -v ok=1 '
+	NR == 1 { if ($0 != "{\"traceEvents\":[") ok = 0; next }
+	done { ok = 0; next }
+	/^[]],"displayTimeUnit":"ms"[}]$/ { if (comma) ok = 0; done = 1; next }
+	{ if (NR > 2 && !comma) ok = 0; comma = sub(/,$/, "") }
+	/^[{]"name":"thread_name","ph":"M","pid":1,"tid":[0-9]+,"args":[{]"name":"thread [0-9]+"[}][}]$/ {
+	    next
+	}
+	/^[{]"name":"([^"\\]|\\.)*","cat":"task","ph":"X","pid":1,"tid":[0-9]+,"ts":[0-9]+,"dur":[0-9]+,"args":[{]"queued":[0-9]+,"blocked_us":[0-9]+,"waiting_us":[0-9]+(,"unblocked_by":"([^"\\]|\\.)*")?[}][}]$/ {
+	    tid = $0
+	    sub(/.*"tid":/, "", tid)
+	    sub(/,.*/, "", tid)
+	    if (tid + 0 >= threads) ok = 0
+	    ++events
+	    next
+	}
+	{ ok = 0 }
+	END { if (ok == 0 || !done || events == 0) exit 1 }' $1
+    if test $? -ne 0; then
+	echo "Bad trace format in $1:"
+	cat $1
+	exit 1
+    fi
+}
+
+# tasks FILE: list the names of the tasks in FILE, one per line.
+tasks()
+{
+    grep '"ph":"X"' $1 | sed -e 's/^{"name":"\([^"]*\)".*/\1/' | sort
+}
+
+# check_once TASKS NAME
+check_once()
+{
+    n=`grep -c "^$2\$" $1`
+    if test "$n" -ne 1; then
+	echo "Found $n events for $2 in $1, not 1:"
+	cat $1
+	exit 1
+    fi
+}
+
+check_format trace_profile_test.json 4
+check_format trace_profile_test_nothreads.json 1
+
+tasks trace_profile_test.json > trace_profile_test.tasks
+tasks trace_profile_test_nothreads.json > trace_profile_test_nothreads.tasks
+
+for f in trace_profile_test.tasks trace_profile_test_nothreads.tasks; do
+    for o in 1 2 3; do
+	for t in Read_symbols Add_symbols Read_relocs Scan_relocs \
+		 Relocate_task; do
+	    check_once $f "$t trace_profile_test_$o.o"
+	done
+    done
+    for t in Middle_runner Layout_task_runner Close_task_runner; do
+	check_once $f "Task_function $t"
+    done
+    check_once $f Write_sections_task
+    check_once $f Write_data_task
+    check_once $f Write_symbols_task
+done
+
+if ! grep -q "^Merge_string_task " trace_profile_test.tasks; then
+    echo "No Merge_string_task events in trace_profile_test.tasks"
+    exit 1
+fi
+
+if ! grep -v "^Merge_string_task " trace_profile_test.tasks \
+     | cmp -s - trace_profile_test_nothreads.tasks; then
+    echo "Different tasks ran with --threads:"
+    grep -v "^Merge_string_task " trace_profile_test.tasks \
+	| diff - trace_profile_test_nothreads.tasks
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,36 @@
+/* trace_profile_test_1.c -- test --trace-profile, file 1 of 3.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   With --trace-profile the workqueue writes one event for each task
+   it runs.  The three files give the per-object tasks something to do:
+   main here calls a function in each of the other files, and they
+   refer to each other's data.  */
+
+extern int trace_profile_test_2 (int);
+extern int trace_profile_test_3 (int);
+extern int data_2[];
+int data_1[] = { 1, 2, 3, 4 };
+
+int
+main (void)
+{
+  return trace_profile_test_2 (data_2[0]) + trace_profile_test_3 (2);
+}
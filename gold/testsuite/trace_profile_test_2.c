@@ -0,0 +1,31 @@
+/* trace_profile_test_2.c -- test --trace-profile, file 2 of 3.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   See trace_profile_test_1.c.  */
+
+extern int data_1[];
+int data_2[] = { 5, 6, 7, 8 };
+
+int
+trace_profile_test_2 (int i)
+{
+  return data_1[i & 3] * 2;
+}
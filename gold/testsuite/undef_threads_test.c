@@ -0,0 +1,31 @@
+/* undef_threads_test.c -- test undefined symbol warnings with --threads.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This is linked against undef_threads_test_lib.so, which refers to
+   more undefined symbols than one Write_symbols_task writes out.
+   Linking with --threads must report them in the same order as
+   linking with --no-threads.  */
+
+int
+main (void)
+{
+  return 0;
+}
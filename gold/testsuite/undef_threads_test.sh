@@ -0,0 +1,46 @@
+#!/bin/sh
+
+# undef_threads_test.sh -- test undefined symbol warnings with --threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# undef_threads_test_lib.so refers to more undefined symbols than are
+# written out by one Write_symbols_task.  Check that linking with
+# --threads warns about them in the same order as --no-threads.
+
+count=`grep -c "undefined reference to 'undef_threads_sym_" undef_threads_test.stderr`
+if test "$count" != "60000"; then
+    echo "found $count undefined symbol warnings, expected 60000"
+    exit 1
+fi
+
+if ! cmp -s undef_threads_test.stderr undef_threads_test_nothreads.stderr
+then
+    echo "--threads reported undefined symbols in a different order"
+    exit 1
+fi
+
+if ! cmp -s undef_threads_test undef_threads_test_nothreads; then
+    echo "undef_threads_test and undef_threads_test_nothreads differ"
+    exit 1
+fi
+
+exit 0
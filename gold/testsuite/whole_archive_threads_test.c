@@ -0,0 +1,35 @@
+/* whole_archive_threads_test.c -- test --whole-archive with --threads.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This file is compiled with -DN=1, -DN=2, and so on, to make the
+   members of an archive which is large enough to be read by several
+   Read_archive_members tasks.  */
+
+#define CAT2(a, b) a ## b
+#define CAT(a, b) CAT2(a, b)
+
+int CAT(whole_archive_threads_v, N) = N;
+
+int
+CAT(whole_archive_threads_f, N) (void)
+{
+  return CAT(whole_archive_threads_v, N);
+}
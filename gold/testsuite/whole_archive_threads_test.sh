@@ -0,0 +1,41 @@
+#!/bin/sh
+
+# whole_archive_threads_test.sh -- test --whole-archive with --threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# With --threads, the members of a large --whole-archive archive are
+# read by several tasks.  Check that every member is included, and
+# that the output is the same as without threads.
+
+if ! cmp -s whole_archive_threads_test whole_archive_threads_test_nothreads; then
+    echo "whole_archive_threads_test and whole_archive_threads_test_nothreads differ"
+    exit 1
+fi
+
+count=$(grep -c ' T whole_archive_threads_f[0-9]*$' whole_archive_threads_test.stdout)
+if test "$count" -ne 40; then
+    echo "Expected 40 archive members in whole_archive_threads_test, found $count:"
+    cat whole_archive_threads_test.stdout
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,57 @@
+/* workqueue_threads_test.c -- test the workqueue with many threads.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   With --threads each thread claims a batch of runnable tasks and
+   other threads steal from it when they run out.  This file is
+   compiled once for each of several objects, with TEST_FILE set to
+   the number of the object and NEXT_FILE to the number of the next
+   one.  Each func_N_K calls func_NEXT_K, so the objects refer to
+   each other, and with -ffunction-sections every function is in its
+   own section.  main, in the first object, reaches only some of the
+   chains, so --gc-sections also has work to do in every object.  */
+
+#define NAME(f, k) NAME2 (f, k)
+#define NAME2(f, k) func_##f##_##k
+
+#define FUNC(k)							\
+  extern int NAME (NEXT_FILE, k) (int);				\
+  static int data_##k[64] = { k, TEST_FILE };			\
+  int								\
+  NAME (TEST_FILE, k) (int i)					\
+  {								\
+    if (i <= 0)							\
+      return data_##k[0];					\
+    return data_##k[i & 63] + NAME (NEXT_FILE, k) (i - 1);	\
+  }
+
+#define FUNC8(n) \
+  FUNC(n##0) FUNC(n##1) FUNC(n##2) FUNC(n##3) \
+  FUNC(n##4) FUNC(n##5) FUNC(n##6) FUNC(n##7)
+
+FUNC8(1) FUNC8(2) FUNC8(3) FUNC8(4)
+
+#if TEST_FILE == 1
+int
+main (void)
+{
+  return func_1_10 (8) + func_1_23 (8) + func_1_37 (8);
+}
+#endif
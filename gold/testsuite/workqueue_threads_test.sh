@@ -0,0 +1,75 @@
+#!/bin/sh
+
+# workqueue_threads_test.sh -- test the workqueue with many threads
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# Eight objects that call each other are linked with --gc-sections,
+# with --threads --thread-count=16, with --thread-count=3 and with
+# --no-threads.  With more tasks than threads each thread claims a
+# batch of them, and idle threads steal from the others.  Check that
+# the reachable functions are kept and the others collected, and that
+# every link collects the same sections and writes the same output.
+
+check_collected()
+{
+    if ! grep -q "removing unused section from '\.text\.$2' in file 'workqueue_threads_test_$3.o'" $1
+    then
+	echo "$2 in file $3 was not collected in $1:"
+	cat $1
+	exit 1
+    fi
+}
+
+check_kept()
+{
+    if grep -q "removing unused section from '\.text\.$2' in file 'workqueue_threads_test_$3.o'" $1
+    then
+	echo "$2 in file $3 was collected in $1:"
+	cat $1
+	exit 1
+    fi
+}
+
+for t in workqueue_threads_test workqueue_threads_test_3 \
+	 workqueue_threads_test_nothreads; do
+    for i in 1 2 3 4 5 6 7 8; do
+	for k in 10 23 37; do
+	    check_kept $t.stderr func_${i}_$k $i
+	done
+	for k in 11 22 36; do
+	    check_collected $t.stderr func_${i}_$k $i
+	done
+    done
+
+    if ! cmp -s $t.stderr workqueue_threads_test_nothreads.stderr; then
+	echo "$t collected different sections:"
+	diff $t.stderr workqueue_threads_test_nothreads.stderr
+	exit 1
+    fi
+
+    if ! cmp -s $t workqueue_threads_test_nothreads; then
+	echo "$t and workqueue_threads_test_nothreads differ"
+	exit 1
+    fi
+done
+
+exit 0
@@ -133,6 +133,14 @@ class Task_token
     this->writer_ = NULL;
   }
 
+  // Return whether T is the token's writer.
+  bool
+  is_writer(const Task* t) const
+  {
+    gold_assert(!this->is_blocker_);
+    return this->writer_ == t;
+  }
+
   // A blocker token uses these methods.
 
   // Add a blocker to the token.
@@ -295,6 +303,20 @@ class Task_locker
   clear()
   { this->count_ = 0; }
 
+  // Move the tokens from OTHER, which has already locked them, into
+  // this locker, which must be empty, and clear OTHER.  This is used
+  // when a Task is passed from one thread to another after its locks
+  // have been taken.
+  void
+  take(Task_locker* other)
+  {
+    gold_assert(this->count_ == 0);
+    for (int i = 0; i < other->count_; ++i)
+      this->tokens_[i] = other->tokens_[i];
+    this->count_ = other->count_;
+    other->count_ = 0;
+  }
+
   // Add a token to the locker.
   void
   add(Task* t, Task_token* token)
@@ -22,6 +22,11 @@
 
 #include "gold.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <vector>
+#include <sys/time.h>
+
 #include "debug.h"
 #include "options.h"
 #include "timer.h"
@@ -114,6 +119,279 @@ class Workqueue_threader_single : public Workqueue_threader
   { return false; }
 };
 
+// Class Workqueue_deque.
+
+// When using threads, a thread holding the Workqueue lock while all
+// the other threads are busy claims several runnable Tasks at once:
+// it takes their locks and keeps them in its own Workqueue_deque.  It
+// then runs them one after another, without searching the run queue
+// again for each one.  The locks of each Task are still released as
+// soon as it finishes, so that Tasks waiting for them are not held
+// up.  A thread which runs out of work steals half of the Tasks in
+// another thread's deque.
+
+class Workqueue_deque
+{
+ public:
+  // The most Tasks that a thread claims at once.
+  static const int max_tasks = 8;
+
+  Workqueue_deque()
+    : lock_(), head_(0), count_(0), next_(NULL)
+  { }
+
+  ~Workqueue_deque()
+  { gold_assert(this->count_ == 0); }
+
+  // The next deque on the Workqueue's list.
+  Workqueue_deque*
+  next() const
+  { return this->next_; }
+
+  void
+  set_next(Workqueue_deque* next)
+  { this->next_ = next; }
+
+  // Return whether there is room to claim another Task.
+  bool
+  has_room()
+  {
+    Hold_lock hl(this->lock_);
+    return this->count_ < max_tasks;
+  }
+
+  // Add T, whose locks are in TL, to the end of the deque.  This
+  // clears TL.
+  void
+  push_back(Task* t, Task_locker* tl)
+  {
+    Hold_lock hl(this->lock_);
+    this->push_back_locked(t, tl);
+  }
+
+  // Remove the oldest Task and return it, moving its locks into TL.
+  // Return NULL if the deque is empty.  This is called by the owning
+  // thread.
+  Task*
+  pop_front(Task_locker* tl)
+  {
+    Hold_lock hl(this->lock_);
+    if (this->count_ == 0)
+      return NULL;
+    Task* t = this->tasks_[this->head_];
+    tl->take(&this->lockers_[this->head_]);
+    this->head_ = (this->head_ + 1) % max_tasks;
+    --this->count_;
+    return t;
+  }
+
+  // Remove the newest half of the Tasks, rounding up, for THIEF.
+  // Return the oldest of them, moving its locks into TL, and add the
+  // rest to THIEF.  Return NULL if the deque is empty.  This is called
+  // with the Workqueue lock held, so there is only one thief at a
+  // time.
+  Task*
+  steal(Workqueue_deque* thief, Task_locker* tl)
+  {
+    Hold_lock hl(this->lock_);
+    if (this->count_ == 0)
+      return NULL;
+    int n = (this->count_ + 1) / 2;
+    int first = (this->head_ + this->count_ - n) % max_tasks;
+    Task* ret = this->tasks_[first];
+    tl->take(&this->lockers_[first]);
+    for (int i = 1; i < n; ++i)
+      {
+	int j = (first + i) % max_tasks;
+	thief->push_back(this->tasks_[j], &this->lockers_[j]);
+      }
+    this->count_ -= n;
+    return ret;
+  }
+
+ private:
+  Workqueue_deque(const Workqueue_deque&);
+  Workqueue_deque& operator=(const Workqueue_deque&);
+
+  void
+  push_back_locked(Task* t, Task_locker* tl)
+  {
+    gold_assert(this->count_ < max_tasks);
+    int i = (this->head_ + this->count_) % max_tasks;
+    this->tasks_[i] = t;
+    this->lockers_[i].take(tl);
+    ++this->count_;
+  }
+
+  // Lock controlling access to the claimed Tasks.
+  Lock lock_;
+  // The claimed Tasks, in a circular buffer.
+  Task* tasks_[max_tasks];
+  // The locks held by the claimed Tasks.
+  Task_locker lockers_[max_tasks];
+  // The index of the oldest claimed Task.
+  int head_;
+  // The number of claimed Tasks.
+  int count_;
+  // The next deque on the Workqueue's list.
+  Workqueue_deque* next_;
+};
+
+// Class Workqueue_trace.
+
+// This records when each Task was queued, when it became runnable,
+// and when and on which thread it ran, for --trace-profile.  The
+// result is written in the Chrome trace event format, which can be
+// loaded into chrome://tracing or Perfetto.
+
+class Workqueue_trace
+{
+ public:
+  Workqueue_trace(const char* filename)
+    : filename_(filename), lock_(), events_()
+  { gettimeofday(&this->base_, NULL); }
+
+  // Return the current time in microseconds since the trace started.
+  long long
+  now() const
+  {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return ((static_cast<long long>(tv.tv_sec) - this->base_.tv_sec) * 1000000
+	    + (tv.tv_usec - this->base_.tv_usec));
+  }
+
+  // Record that T ran on THREAD_NUMBER from START to END.
+  void
+  add_event(Task* t, int thread_number, long long start, long long end);
+
+  // Write out the trace.
+  void
+  write() const;
+
+ private:
+  // A Task which ran.
+  struct Event
+  {
+    std::string name;
+    std::string unblocked_by;
+    int thread_number;
+    long long queued;
+    long long ready;
+    long long start;
+    long long end;
+  };
+
+  static void
+  write_json_string(FILE*, const std::string&);
+
+  // The file to write.
+  const char* filename_;
+  // When the trace started.
+  struct timeval base_;
+  // Lock controlling access to events_.
+  Lock lock_;
+  // The Tasks which have run.
+  std::vector<Event> events_;
+};
+
+// Record an event.  This is called without the Workqueue lock held.
+
+void
+Workqueue_trace::add_event(Task* t, int thread_number, long long start,
+			   long long end)
+{
+  Event e;
+  e.name = t->name();
+  e.unblocked_by = t->trace_info()->unblocked_by;
+  e.thread_number = thread_number;
+  e.queued = t->trace_info()->queued;
+  e.ready = t->trace_info()->ready;
+  e.start = start;
+  e.end = end;
+
+  Hold_lock hl(this->lock_);
+  this->events_.push_back(e);
+}
+
+// Write S to F as a JSON string.
+
+void
+Workqueue_trace::write_json_string(FILE* f, const std::string& s)
+{
+  putc('"', f);
+  for (std::string::const_iterator p = s.begin(); p != s.end(); ++p)
+    {
+      unsigned char c = *p;
+      if (c == '"' || c == '\\')
+	fprintf(f, "\\%c", c);
+      else if (c < 0x20)
+	fprintf(f, "\\u%04x", c);
+      else
+	putc(c, f);
+    }
+  putc('"', f);
+}
+
+// Write out the trace.  Each Task is a complete event on the thread
+// which ran it.  The arguments record how long the Task was blocked
+// before it became runnable, how long it then waited for a thread,
+// and which Task unblocked it.
+
+void
+Workqueue_trace::write() const
+{
+  FILE* f = fopen(this->filename_, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open trace profile %s: %s"), this->filename_,
+		 strerror(errno));
+      return;
+    }
+
+  fprintf(f, "{\"traceEvents\":[\n");
+
+  std::vector<bool> seen_threads;
+  bool first = true;
+  for (std::vector<Event>::const_iterator p = this->events_.begin();
+       p != this->events_.end();
+       ++p)
+    {
+      size_t thread = p->thread_number;
+      if (thread >= seen_threads.size())
+	seen_threads.resize(thread + 1, false);
+      if (!seen_threads[thread])
+	{
+	  seen_threads[thread] = true;
+	  fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+		  "\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+		  first ? "" : ",\n", p->thread_number, p->thread_number);
+	  first = false;
+	}
+
+      fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+      first = false;
+      write_json_string(f, p->name);
+      fprintf(f, ",\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+	      "\"ts\":%lld,\"dur\":%lld,\"args\":{\"queued\":%lld,"
+	      "\"blocked_us\":%lld,\"waiting_us\":%lld",
+	      p->thread_number, p->start, p->end - p->start, p->queued,
+	      p->ready - p->queued, p->start - p->ready);
+      if (!p->unblocked_by.empty())
+	{
+	  fprintf(f, ",\"unblocked_by\":");
+	  write_json_string(f, p->unblocked_by);
+	}
+      fprintf(f, "}}");
+    }
+
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+  if (fclose(f) != 0)
+    gold_error(_("cannot close trace profile %s: %s"), this->filename_,
+	       strerror(errno));
+}
+
 // Workqueue methods.
 
 Workqueue::Workqueue(const General_options& options)
@@ -122,9 +400,16 @@ Workqueue::Workqueue(const General_options& options)
     tasks_(),
     running_(0),
     waiting_(0),
+    idle_(0),
+    use_deques_(false),
+    deques_(NULL),
     condvar_(this->lock_),
-    threader_(NULL)
+    threader_(NULL),
+    trace_(NULL)
 {
+  if (options.user_set_trace_profile())
+    this->trace_ = new Workqueue_trace(options.trace_profile());
+
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
   threads = false;
@@ -135,6 +420,7 @@ Workqueue::Workqueue(const General_options& options)
     {
 #ifdef ENABLE_THREADS
       this->threader_ = new Workqueue_threader_threadpool(this);
+      this->use_deques_ = true;
 #else
       gold_unreachable();
 #endif
@@ -145,6 +431,15 @@ Workqueue::~Workqueue()
 {
 }
 
+// Write out the trace profile.
+
+void
+Workqueue::write_trace_profile()
+{
+  if (this->trace_ != NULL)
+    this->trace_->write();
+}
+
 // Add a task to the end of a specific queue, or put it on the list
 // waiting for a Token.
 
@@ -153,6 +448,9 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 {
   Hold_lock hl(this->lock_);
 
+  if (this->trace_ != NULL)
+    t->trace_info()->queued = this->trace_->now();
+
   Task_token* token = t->is_runnable();
   if (token != NULL)
     {
@@ -164,6 +462,8 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
     }
   else
     {
+      if (this->trace_ != NULL)
+	t->trace_info()->ready = t->trace_info()->queued;
       if (front)
 	queue->push_front(t);
       else
@@ -243,16 +543,31 @@ Workqueue::find_runnable()
 }
 
 // Find a runnable a task, and wait until we find one.  Return NULL if
-// we should exit.  The workqueue lock must be held when this is
-// called.
+// we should exit.  If there are no tasks on the run queue, try to
+// steal tasks from another thread; a stolen task already holds its
+// locks, which are put in TL, and we set *IS_LOCKED.  The workqueue
+// lock must be held when this is called.
 
 Task*
-Workqueue::find_runnable_or_wait(int thread_number)
+Workqueue::find_runnable_or_wait(int thread_number, Workqueue_deque* deque,
+				 Task_locker* tl, bool* is_locked)
 {
+  *is_locked = false;
+
   Task* t = this->find_runnable();
 
   while (t == NULL)
     {
+      if (deque != NULL)
+	{
+	  t = this->steal_tasks(deque, tl);
+	  if (t != NULL)
+	    {
+	      *is_locked = true;
+	      break;
+	    }
+	}
+
       if (this->running_ == 0
 	  && this->first_tasks_.empty()
 	  && this->tasks_.empty())
@@ -269,7 +584,9 @@ Workqueue::find_runnable_or_wait(int thread_number)
 
       gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
 
+      ++this->idle_;
       this->condvar_.wait();
+      --this->idle_;
 
       gold_debug(DEBUG_TASK, "%3d awake", thread_number);
 
@@ -281,12 +598,13 @@ Workqueue::find_runnable_or_wait(int thread_number)
 
 // Find and run tasks.  If we can't find a runnable task, wait for one
 // to become available.  If we run a task, and it frees up another
-// runnable task, then run that one too.  This returns true if we
-// should look for another task, false if we are cancelling this
-// thread.
+// runnable task, then run that one too.  If DEQUE is not NULL, we may
+// claim several tasks at once, and run them one after another.  This
+// returns true if we should look for another task, false if we are
+// cancelling this thread.
 
 bool
-Workqueue::find_and_run_task(int thread_number)
+Workqueue::find_and_run_task(int thread_number, Workqueue_deque* deque)
 {
   Task* t;
   Task_locker tl;
@@ -295,16 +613,23 @@ Workqueue::find_and_run_task(int thread_number)
     Hold_lock hl(this->lock_);
 
     // Find a runnable task.
-    t = this->find_runnable_or_wait(thread_number);
+    bool is_locked;
+    t = this->find_runnable_or_wait(thread_number, deque, &tl, &is_locked);
 
     if (t == NULL)
       return false;
 
-    // Get the locks for the task.  This must be called while we are
-    // still holding the Workqueue lock.
-    t->locks(&tl);
+    if (!is_locked)
+      {
+	// Get the locks for the task.  This must be called while we
+	// are still holding the Workqueue lock.
+	t->locks(&tl);
+
+	++this->running_;
+      }
 
-    ++this->running_;
+    if (deque != NULL)
+      this->claim_tasks(deque);
   }
 
   while (t != NULL)
@@ -316,8 +641,16 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      long long start_time = 0;
+      if (this->trace_ != NULL)
+	start_time = this->trace_->now();
+
       t->run(this);
 
+      if (this->trace_ != NULL)
+	this->trace_->add_event(t, thread_number, start_time,
+				this->trace_->now());
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -331,7 +664,13 @@ Workqueue::find_and_run_task(int thread_number)
                      elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
         }
 
-      Task* next;
+      // If we have claimed another Task, run it next.  We already
+      // have its locks.
+      Task* next = NULL;
+      Task_locker next_tl;
+      if (deque != NULL)
+	next = deque->pop_front(&next_tl);
+
       {
 	Hold_lock hl(this->lock_);
 
@@ -339,31 +678,96 @@ Workqueue::find_and_run_task(int thread_number)
 
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
-	next = this->release_locks(t, &tl);
-
-	if (next == NULL)
-	  next = this->find_runnable();
+	Task* ready = this->release_locks(t, &tl);
 
-	// If we have another Task to run, get the Locks.  This must
-	// be called while we are still holding the Workqueue lock.
 	if (next != NULL)
 	  {
-	    tl.clear();
-	    next->locks(&tl);
-
-	    ++this->running_;
+	    if (ready != NULL)
+	      this->requeue(ready);
+	  }
+	else
+	  {
+	    next = ready;
+	    if (next == NULL)
+	      next = this->find_runnable();
+
+	    // If we have another Task to run, get the Locks.  This must
+	    // be called while we are still holding the Workqueue lock.
+	    if (next != NULL)
+	      {
+		next->locks(&next_tl);
+
+		++this->running_;
+	      }
 	  }
+
+	if (next != NULL && deque != NULL)
+	  this->claim_tasks(deque);
       }
 
       // We are done with this task.
       delete t;
 
+      tl.clear();
+      tl.take(&next_tl);
       t = next;
     }
 
   return true;
 }
 
+// Put T, which is runnable, back on the run queue.  It will be checked
+// again before it is run.  This must be called with the Workqueue lock
+// held.
+
+void
+Workqueue::requeue(Task* t)
+{
+  if (t->should_run_soon())
+    this->first_tasks_.push_back(t);
+  else
+    this->tasks_.push_back(t);
+  this->condvar_.signal();
+}
+
+// If every thread is busy, claim more runnable tasks for this thread,
+// so that it can run them without taking the Workqueue lock again.
+// If some threads are idle, leave the tasks on the run queue for them.
+// This must be called with the Workqueue lock held.
+
+void
+Workqueue::claim_tasks(Workqueue_deque* deque)
+{
+  while (this->idle_ == 0 && deque->has_room())
+    {
+      Task* t = this->find_runnable();
+      if (t == NULL)
+	break;
+      Task_locker tl;
+      t->locks(&tl);
+      ++this->running_;
+      deque->push_back(t, &tl);
+    }
+}
+
+// Steal tasks claimed by another thread, putting them in DEQUE.
+// Return the first one, with its locks in TL, or NULL if there are
+// none.  This must be called with the Workqueue lock held.
+
+Task*
+Workqueue::steal_tasks(Workqueue_deque* deque, Task_locker* tl)
+{
+  for (Workqueue_deque* d = this->deques_; d != NULL; d = d->next())
+    {
+      if (d == deque)
+	continue;
+      Task* t = d->steal(deque, tl);
+      if (t != NULL)
+	return t;
+    }
+  return NULL;
+}
+
 // Handle the return value of release_locks, and get tasks ready to
 // run.
 
@@ -405,6 +809,9 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
       return false;
     }
 
+  if (this->trace_ != NULL)
+    t->trace_info()->ready = this->trace_->now();
+
   bool should_queue = false;
   bool should_return = false;
 
@@ -456,11 +863,13 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	    {
 	      // The token has been unblocked.  Every waiting Task may
 	      // now be runnable.
-	      Task* t;
-	      while ((t = token->remove_first_waiting()) != NULL)
+	      Task* waiting_task;
+	      while ((waiting_task = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  if (this->trace_ != NULL)
+		    waiting_task->trace_info()->unblocked_by = t->name();
+		  this->return_or_queue(waiting_task, true, &ret);
 		}
 	    }
 	}
@@ -473,11 +882,13 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  // move all the Tasks to the runnable queue, to avoid a
 	  // potential deadlock if the locking status changes before
 	  // we run the next thread.
-	  Task* t;
-	  while ((t = token->remove_first_waiting()) != NULL)
+	  Task* waiting_task;
+	  while ((waiting_task = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      if (this->trace_ != NULL)
+		waiting_task->trace_info()->unblocked_by = t->name();
+	      if (this->return_or_queue(waiting_task, false, &ret))
 		break;
 	    }
 	}
@@ -492,8 +903,34 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 void
 Workqueue::process(int thread_number)
 {
-  while (this->find_and_run_task(thread_number))
+  Workqueue_deque* deque = NULL;
+  if (this->use_deques_)
+    {
+      deque = new Workqueue_deque();
+      Hold_lock hl(this->lock_);
+      deque->set_next(this->deques_);
+      this->deques_ = deque;
+    }
+
+  while (this->find_and_run_task(thread_number, deque))
     ;
+
+  if (deque != NULL)
+    {
+      {
+	Hold_lock hl(this->lock_);
+	if (this->deques_ == deque)
+	  this->deques_ = deque->next();
+	else
+	  {
+	    Workqueue_deque* d = this->deques_;
+	    while (d->next() != deque)
+	      d = d->next();
+	    d->set_next(deque->next());
+	  }
+      }
+      delete deque;
+    }
 }
 
 // Set the number of threads to use for the workqueue, if we are using
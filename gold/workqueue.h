@@ -45,7 +45,7 @@ class Task
 {
  public:
   Task()
-    : list_next_(NULL), name_(), should_run_soon_(false)
+    : list_next_(NULL), name_(), should_run_soon_(false), trace_info_()
   { }
   virtual ~Task()
   { }
@@ -106,6 +106,27 @@ class Task
     return this->name_;
   }
 
+  // Information recorded about the Task for --trace-profile.  The
+  // times are in microseconds from the start of the trace.
+  struct Trace_info
+  {
+    Trace_info()
+      : queued(0), ready(0), unblocked_by()
+    { }
+
+    // When the Task was queued.
+    long long queued;
+    // When the Task last became runnable.
+    long long ready;
+    // The name of the Task which made this Task runnable, if any.
+    std::string unblocked_by;
+  };
+
+  // Return the trace information.
+  Trace_info*
+  trace_info()
+  { return &this->trace_info_; }
+
  protected:
   // Get the name of the task.  This must be implemented by the child
   // class.
@@ -127,6 +148,8 @@ class Task
   // Whether this Task should be executed soon.  This is used for
   // Tasks which can be run after some data is read.
   bool should_run_soon_;
+  // Information for --trace-profile.
+  Trace_info trace_info_;
 };
 
 // An interface for Task_function.  This is a convenience class to run
@@ -194,6 +217,8 @@ class Task_function : public Task
 // The workqueue itself.
 
 class Workqueue_threader;
+class Workqueue_trace;
+class Workqueue_deque;
 
 class Workqueue
 {
@@ -233,6 +258,11 @@ class Workqueue
   void
   add_blocker(Task_token*);
 
+  // Write out the trace of the tasks which have run, if
+  // --trace-profile was used.
+  void
+  write_trace_profile();
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
@@ -244,7 +274,8 @@ class Workqueue
 
   // Find a runnable task, or wait for one.
   Task*
-  find_runnable_or_wait(int thread_number);
+  find_runnable_or_wait(int thread_number, Workqueue_deque*, Task_locker*,
+			bool* is_locked);
 
   // Find a runnable task.
   Task*
@@ -256,12 +287,25 @@ class Workqueue
 
   // Find an run a task.
   bool
-  find_and_run_task(int);
+  find_and_run_task(int, Workqueue_deque*);
 
   // Release the locks for a Task.  Return the next Task to run.
   Task*
   release_locks(Task*, Task_locker*);
 
+  // Put a runnable Task which we are not going to run now back on the
+  // run queue.
+  void
+  requeue(Task*);
+
+  // Claim more runnable Tasks for a thread.
+  void
+  claim_tasks(Workqueue_deque*);
+
+  // Steal Tasks claimed by another thread.
+  Task*
+  steal_tasks(Workqueue_deque*, Task_locker*);
+
   // Store T into *PRET, or queue it as appropriate.
   bool
   return_or_queue(Task* t, bool is_blocker, Task** pret);
@@ -281,6 +325,13 @@ class Workqueue
   int running_;
   // Number of tasks waiting for a lock to release.
   int waiting_;
+  // Number of threads waiting on condvar_ for a task.
+  int idle_;
+  // Whether threads claim several Tasks at a time.  This is set at
+  // construction time and not changed thereafter.
+  bool use_deques_;
+  // List of the Tasks claimed by each thread, if use_deques_.
+  Workqueue_deque* deques_;
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
@@ -288,6 +339,9 @@ class Workqueue
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
+  // The trace of tasks for --trace-profile, or NULL.  This is set at
+  // construction time and not changed thereafter.
+  Workqueue_trace* trace_;
 };
 
 } // End namespace gold.